@@ -0,0 +1,353 @@
+#ifndef GDWG_CENTRALITY_HPP
+#define GDWG_CENTRALITY_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <limits>
+#include <numeric>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "gdwg/detail/parallel.hpp"
+#include "gdwg/frozen_graph.hpp"
+#include "gdwg/trace.hpp"
+
+// Betweenness and closeness centrality over a frozen_graph, following edge directions. Both run
+// one single source shortest path search per source, breadth first when unweighted and Dijkstra
+// when weighted, and add what it finds into per node totals. Sources are handed out to threads in
+// blocks, each thread keeps one workspace it reuses for every source it gets, resetting only the
+// nodes the last search reached, and each thread's totals are summed at the end.
+//
+// Betweenness is Brandes' algorithm. Dependencies are pushed back from each node's successors on
+// the shortest path dag, found again from the distances, so no predecessor lists are built.
+// Closeness of v uses the distances from the nodes that reach v, scaled as Wasserman and Faust
+// do so that nodes few others reach don't score highly off a handful of short paths.
+//
+// With samples set, only that many sources picked at random are searched and the totals are
+// scaled up to estimate the exact ones, as Brandes and Pich do for betweenness and Eppstein and
+// Wang for closeness. Results line up with node ids, which for the graph overloads are the
+// positions in g.nodes().
+
+namespace gdwg {
+	struct centrality_options {
+		// take edge weights as lengths rather than counting every edge as 1
+		bool weighted = false;
+		// 0 searches from every node, which is exact, otherwise from this many random sources
+		std::size_t samples = 0;
+		std::uint64_t seed = 0x5eed;
+		// divide betweenness by (n - 1)(n - 2), the number of ordered pairs it could lie between
+		bool normalized = true;
+		// 0 means one per hardware thread
+		std::size_t threads = 0;
+	};
+
+	namespace detail {
+		// outgoing rows with self loops dropped and parallel edges merged into the shortest
+		struct path_graph {
+			using node_id = std::uint32_t;
+
+			std::vector<std::size_t> offsets;
+			std::vector<node_id> targets;
+			// empty when unweighted
+			std::vector<double> lengths;
+
+			[[nodiscard]] auto size() const noexcept -> std::size_t {
+				return offsets.size() - 1;
+			}
+		};
+
+		template<typename N, typename E>
+		auto make_path_graph(frozen_graph<N, E> const& g, bool weighted, char const* caller)
+		   -> path_graph {
+			auto const n = g.num_nodes();
+			auto paths = path_graph{};
+			paths.offsets.reserve(n + 1);
+			paths.offsets.push_back(0);
+			for (auto v = path_graph::node_id{0}; v < n; ++v) {
+				// rows are sorted by target then weight, so the first of each run is the shortest
+				auto const targets = g.out_neighbors(v);
+				auto const weights = g.out_weights(v);
+				for (auto i = std::size_t{0}; i < targets.size(); ++i) {
+					if (weighted && !(static_cast<double>(weights[i]) > 0)) {
+						throw std::runtime_error(std::string("Cannot call gdwg::") + caller
+						                         + " with an edge weight that isn't positive");
+					}
+					if (targets[i] == v || (i != 0 && targets[i] == targets[i - 1])) {
+						continue;
+					}
+					paths.targets.push_back(targets[i]);
+					if (weighted) {
+						paths.lengths.push_back(static_cast<double>(weights[i]));
+					}
+				}
+				paths.offsets.push_back(paths.targets.size());
+			}
+			return paths;
+		}
+
+		// one thread's state for single source searches, sized once and reset as it goes
+		class path_search {
+		public:
+			using node_id = std::uint32_t;
+
+			explicit path_search(std::size_t n)
+			: distance_(n, unreached)
+			, paths_(n, 0)
+			, dependency_(n, 0) {
+				order_.reserve(n);
+			}
+
+			// shortest distances and path counts from source, order() is the reached nodes by
+			// distance
+			auto run(path_graph const& g, node_id source) -> void {
+				for (auto v : order_) {
+					distance_[v] = unreached;
+					paths_[v] = 0;
+					dependency_[v] = 0;
+				}
+				order_.clear();
+				distance_[source] = 0;
+				paths_[source] = 1;
+				if (g.lengths.empty()) {
+					breadth_first(g, source);
+				}
+				else {
+					dijkstra(g, source);
+				}
+			}
+
+			// Brandes' dependency of source on every node it reached, in reverse distance order
+			auto accumulate(path_graph const& g, std::vector<double>& into) -> void {
+				auto const weighted = !g.lengths.empty();
+				for (auto i = order_.size(); i-- > 1;) {
+					auto const v = order_[i];
+					auto dependency = 0.0;
+					for (auto a = g.offsets[v]; a < g.offsets[v + 1]; ++a) {
+						auto const w = g.targets[a];
+						auto const length = weighted ? g.lengths[a] : 1.0;
+						if (distance_[w] == distance_[v] + length) {
+							dependency += paths_[v] / paths_[w] * (1 + dependency_[w]);
+						}
+					}
+					dependency_[v] = dependency;
+					into[v] += dependency;
+				}
+			}
+
+			[[nodiscard]] auto order() const noexcept -> std::vector<node_id> const& {
+				return order_;
+			}
+
+			[[nodiscard]] auto distance(node_id v) const noexcept -> double {
+				return distance_[v];
+			}
+
+		private:
+			static constexpr auto unreached = std::numeric_limits<double>::infinity();
+
+			std::vector<double> distance_;
+			// shortest paths from the source, a double since they grow exponentially
+			std::vector<double> paths_;
+			std::vector<double> dependency_;
+			std::vector<node_id> order_;
+			std::vector<std::pair<double, node_id>> heap_;
+
+			auto breadth_first(path_graph const& g, node_id source) -> void {
+				order_.push_back(source);
+				for (auto i = std::size_t{0}; i < order_.size(); ++i) {
+					auto const v = order_[i];
+					auto const next = distance_[v] + 1;
+					for (auto a = g.offsets[v]; a < g.offsets[v + 1]; ++a) {
+						auto const w = g.targets[a];
+						if (distance_[w] == unreached) {
+							distance_[w] = next;
+							order_.push_back(w);
+						}
+						if (distance_[w] == next) {
+							paths_[w] += paths_[v];
+						}
+					}
+				}
+			}
+
+			// lazy deletion, a node can sit in the heap more than once but is settled once
+			auto dijkstra(path_graph const& g, node_id source) -> void {
+				constexpr auto later = std::greater<>();
+				heap_.clear();
+				heap_.emplace_back(0, source);
+				while (!heap_.empty()) {
+					std::pop_heap(heap_.begin(), heap_.end(), later);
+					auto const [d, v] = heap_.back();
+					heap_.pop_back();
+					if (d > distance_[v]) {
+						continue;
+					}
+					order_.push_back(v);
+					for (auto a = g.offsets[v]; a < g.offsets[v + 1]; ++a) {
+						auto const w = g.targets[a];
+						auto const through = d + g.lengths[a];
+						if (through < distance_[w]) {
+							distance_[w] = through;
+							paths_[w] = paths_[v];
+							heap_.emplace_back(through, w);
+							std::push_heap(heap_.begin(), heap_.end(), later);
+						}
+						else if (through == distance_[w]) {
+							paths_[w] += paths_[v];
+						}
+					}
+				}
+			}
+		};
+
+		// every node, or samples of them drawn without replacement
+		inline auto pick_sources(std::size_t n, centrality_options const& options)
+		   -> std::vector<std::uint32_t> {
+			auto sources = std::vector<std::uint32_t>(n);
+			std::iota(sources.begin(), sources.end(), std::uint32_t{0});
+			if (options.samples == 0 || options.samples >= n) {
+				return sources;
+			}
+			auto picked = std::vector<std::uint32_t>();
+			picked.reserve(options.samples);
+			auto rng = std::mt19937_64(options.seed);
+			auto const into = std::back_inserter(picked);
+			std::sample(sources.begin(), sources.end(), into, options.samples, rng);
+			return picked;
+		}
+
+		// runs visit(search, source, totals) for every source, each thread adding into its own
+		// row of totals, and returns the rows summed
+		template<typename Visit>
+		auto for_each_source(path_graph const& g,
+		                     std::vector<std::uint32_t> const& sources,
+		                     std::size_t rows,
+		                     std::size_t threads,
+		                     Visit visit) -> std::vector<std::vector<double>> {
+			auto const n = g.size();
+			auto const workers =
+			   std::min(resolve_threads(threads), std::max<std::size_t>(sources.size(), 1));
+			auto totals = std::vector<std::vector<std::vector<double>>>(
+			   workers,
+			   std::vector<std::vector<double>>(rows, std::vector<double>(n)));
+			// small blocks, searches from different sources can differ a lot in cost
+			constexpr auto block = std::size_t{16};
+			auto next = std::atomic<std::size_t>(0);
+			parallel_for(workers, workers, [&](std::size_t, std::size_t, std::size_t t) {
+				auto search = path_search(n);
+				for (auto begin = next.fetch_add(block); begin < sources.size();
+				     begin = next.fetch_add(block)) {
+					for (auto i = begin; i < std::min(begin + block, sources.size()); ++i) {
+						search.run(g, sources[i]);
+						visit(search, sources[i], totals[t]);
+					}
+				}
+			});
+
+			auto& sum = totals[0];
+			for (auto t = std::size_t{1}; t < workers; ++t) {
+				for (auto row = std::size_t{0}; row < rows; ++row) {
+					std::transform(sum[row].begin(),
+					               sum[row].end(),
+					               totals[t][row].begin(),
+					               sum[row].begin(),
+					               std::plus<>());
+				}
+				totals[t] = {};
+			}
+			return std::move(sum);
+		}
+	} // namespace detail
+
+	// the share of shortest paths between other pairs of nodes that pass through each node
+	template<typename N, typename E>
+	auto betweenness_centrality(frozen_graph<N, E> const& g, centrality_options const& options = {})
+	   -> std::vector<double> {
+		[[maybe_unused]] auto const span = trace::span("gdwg::betweenness_centrality");
+		auto const paths = detail::make_path_graph(g, options.weighted, "betweenness_centrality");
+		auto const n = paths.size();
+		auto const sources = detail::pick_sources(n, options);
+		auto totals = detail::for_each_source(
+		   paths,
+		   sources,
+		   1,
+		   options.threads,
+		   [&](detail::path_search& search, std::uint32_t, std::vector<std::vector<double>>& into) {
+			   search.accumulate(paths, into[0]);
+		   });
+
+		auto scale = sources.empty() ? 0.0
+		                             : static_cast<double>(n) / static_cast<double>(sources.size());
+		if (options.normalized && n > 2) {
+			scale /= static_cast<double>((n - 1) * (n - 2));
+		}
+		auto& centrality = totals[0];
+		for (auto& value : centrality) {
+			value *= scale;
+		}
+		return std::move(centrality);
+	}
+
+	template<typename N, typename E>
+	auto betweenness_centrality(graph<N, E> const& g, centrality_options const& options = {})
+	   -> std::vector<double> {
+		return betweenness_centrality(frozen_graph<N, E>(g), options);
+	}
+
+	// how near each node is to the nodes that can reach it, the reciprocal of their average
+	// distance to it, times the share of other nodes that reach it at all
+	template<typename N, typename E>
+	auto closeness_centrality(frozen_graph<N, E> const& g, centrality_options const& options = {})
+	   -> std::vector<double> {
+		[[maybe_unused]] auto const span = trace::span("gdwg::closeness_centrality");
+		auto const paths = detail::make_path_graph(g, options.weighted, "closeness_centrality");
+		auto const n = paths.size();
+		auto const sources = detail::pick_sources(n, options);
+		// row 0 is the total distance to each node, row 1 how many sources reached it
+		auto totals = detail::for_each_source(
+		   paths,
+		   sources,
+		   2,
+		   options.threads,
+		   [](detail::path_search& search, std::uint32_t, std::vector<std::vector<double>>& into) {
+			   auto const& order = search.order();
+			   for (auto i = std::size_t{1}; i < order.size(); ++i) {
+				   into[0][order[i]] += search.distance(order[i]);
+				   into[1][order[i]] += 1;
+			   }
+		   });
+
+		// a node that was itself a source had one fewer source that could have reached it
+		auto searched = std::vector<std::uint8_t>(n);
+		for (auto s : sources) {
+			searched[s] = 1;
+		}
+		auto centrality = std::vector<double>(n);
+		for (auto v = std::size_t{0}; v < n; ++v) {
+			auto const distance = totals[0][v];
+			auto const others = static_cast<double>(sources.size() - searched[v]);
+			if (!(distance > 0) || others == 0) {
+				continue;
+			}
+			// reached / others estimates the share of the other n - 1 nodes that reach v
+			auto const reached = totals[1][v];
+			centrality[v] = reached / distance * reached / others;
+		}
+		return centrality;
+	}
+
+	template<typename N, typename E>
+	auto closeness_centrality(graph<N, E> const& g, centrality_options const& options = {})
+	   -> std::vector<double> {
+		return closeness_centrality(frozen_graph<N, E>(g), options);
+	}
+} // namespace gdwg
+
+#endif // GDWG_CENTRALITY_HPP
@@ -0,0 +1,379 @@
+#ifndef GDWG_COMPONENTS_HPP
+#define GDWG_COMPONENTS_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <limits>
+#include <mutex>
+#include <random>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "gdwg/detail/parallel.hpp"
+#include "gdwg/frozen_graph.hpp"
+#include "gdwg/trace.hpp"
+
+// Connected and strongly connected components. Every function labels the nodes of a
+// frozen_graph with dense component ids 0..count-1, numbered in order of each component's
+// smallest node id so the different algorithms agree on the labels. The graph overloads freeze
+// the graph first, so their labels line up with g.nodes().
+
+namespace gdwg {
+	struct component_labels {
+		// component[id] for every node id
+		std::vector<std::uint32_t> component;
+		std::uint32_t count = 0;
+	};
+
+	namespace detail {
+		using component_id = std::uint32_t;
+		using atomic_labels = std::vector<std::atomic<component_id>>;
+		inline constexpr auto no_component = std::numeric_limits<component_id>::max();
+
+		// relabels arbitrary per node labels densely, in order of first appearance
+		inline auto densify(std::vector<component_id> const& raw) -> component_labels {
+			auto result = component_labels{std::vector<component_id>(raw.size()), 0};
+			auto dense = std::vector<component_id>(raw.size(), no_component);
+			for (auto v = std::size_t{0}; v < raw.size(); ++v) {
+				auto& label = dense[raw[v]];
+				if (label == no_component) {
+					label = result.count++;
+				}
+				result.component[v] = label;
+			}
+			return result;
+		}
+
+		// lock free union of the trees holding u and v, the larger root is hooked under the smaller
+		inline auto link(atomic_labels& parent, component_id u, component_id v) noexcept -> void {
+			auto p1 = parent[u].load(std::memory_order_relaxed);
+			auto p2 = parent[v].load(std::memory_order_relaxed);
+			while (p1 != p2) {
+				auto const high = std::max(p1, p2);
+				auto const low = std::min(p1, p2);
+				auto expected = high;
+				if (parent[high].load(std::memory_order_relaxed) == low) {
+					return;
+				}
+				if (parent[high].compare_exchange_strong(expected, low, std::memory_order_relaxed)) {
+					return;
+				}
+				auto const hooked = parent[high].load(std::memory_order_relaxed);
+				p1 = parent[hooked].load(std::memory_order_relaxed);
+				p2 = parent[low].load(std::memory_order_relaxed);
+			}
+		}
+
+		inline auto compress(atomic_labels& parent, std::size_t threads) -> void {
+			parallel_for(parent.size(), threads, [&](std::size_t begin, std::size_t end, std::size_t) {
+				for (auto v = begin; v < end; ++v) {
+					auto p = parent[v].load(std::memory_order_relaxed);
+					while (p != parent[p].load(std::memory_order_relaxed)) {
+						p = parent[p].load(std::memory_order_relaxed);
+					}
+					parent[v].store(p, std::memory_order_relaxed);
+				}
+			});
+		}
+
+		// most common root among a fixed sample of nodes, almost always the giant component
+		inline auto sample_frequent_root(atomic_labels const& parent) -> component_id {
+			constexpr auto samples = 1024;
+			auto rng = std::mt19937(0x6d77);
+			auto pick = std::uniform_int_distribution<std::size_t>(0, parent.size() - 1);
+			auto seen = std::unordered_map<component_id, int>();
+			for (auto i = 0; i < samples; ++i) {
+				++seen[parent[pick(rng)].load(std::memory_order_relaxed)];
+			}
+			return std::max_element(seen.begin(), seen.end(), [](auto const& left, auto const& right) {
+				       return left.second < right.second;
+			       })->first;
+		}
+	} // namespace detail
+
+	// components of the graph with edge directions ignored. Afforest: union-find over a couple of
+	// neighbours per node, then every remaining edge except those inside the component that
+	// already looks largest, which is where most of the edges of real graphs sit
+	template<typename N, typename E>
+	auto weakly_connected_components(frozen_graph<N, E> const& g, std::size_t threads = 0)
+	   -> component_labels {
+		using detail::component_id;
+		[[maybe_unused]] auto const span = trace::span("gdwg::weakly_connected_components");
+		auto const n = g.num_nodes();
+		if (n == 0) {
+			return {};
+		}
+
+		auto parent = detail::atomic_labels(n);
+		detail::parallel_for(n, threads, [&](std::size_t begin, std::size_t end, std::size_t) {
+			for (auto v = begin; v < end; ++v) {
+				parent[v].store(static_cast<component_id>(v), std::memory_order_relaxed);
+			}
+		});
+
+		constexpr auto neighbour_rounds = std::size_t{2};
+		for (auto round = std::size_t{0}; round < neighbour_rounds; ++round) {
+			detail::parallel_for(n, threads, [&](std::size_t begin, std::size_t end, std::size_t) {
+				for (auto v = begin; v < end; ++v) {
+					auto const targets = g.out_neighbors(static_cast<component_id>(v));
+					if (round < targets.size()) {
+						detail::link(parent, static_cast<component_id>(v), targets[round]);
+					}
+				}
+			});
+			detail::compress(parent, threads);
+		}
+
+		// edges between two members of the giant component can't merge anything new, and an edge
+		// from the giant component to elsewhere is seen from the other end's incoming row
+		auto const giant = detail::sample_frequent_root(parent);
+		detail::parallel_for(n, threads, [&](std::size_t begin, std::size_t end, std::size_t) {
+			for (auto v = begin; v < end; ++v) {
+				auto const id = static_cast<component_id>(v);
+				if (parent[v].load(std::memory_order_relaxed) == giant) {
+					continue;
+				}
+				auto const targets = g.out_neighbors(id);
+				for (auto i = neighbour_rounds; i < targets.size(); ++i) {
+					detail::link(parent, id, targets[i]);
+				}
+				for (auto source : g.in_neighbors(id)) {
+					detail::link(parent, id, source);
+				}
+			}
+		});
+		detail::compress(parent, threads);
+
+		auto roots = std::vector<component_id>(n);
+		for (auto v = std::size_t{0}; v < n; ++v) {
+			roots[v] = parent[v].load(std::memory_order_relaxed);
+		}
+		return detail::densify(roots);
+	}
+
+	template<typename N, typename E>
+	auto weakly_connected_components(graph<N, E> const& g, std::size_t threads = 0)
+	   -> component_labels {
+		return weakly_connected_components(frozen_graph<N, E>(g), threads);
+	}
+
+	// Tarjan's algorithm with an explicit stack, so path length is bounded by memory rather than
+	// by the call stack
+	template<typename N, typename E>
+	auto strongly_connected_components(frozen_graph<N, E> const& g) -> component_labels {
+		using detail::component_id;
+		[[maybe_unused]] auto const span = trace::span("gdwg::strongly_connected_components");
+		constexpr auto unvisited = detail::no_component;
+		auto const n = g.num_nodes();
+
+		auto index = std::vector<component_id>(n, unvisited);
+		auto lowlink = std::vector<component_id>(n);
+		auto on_stack = std::vector<bool>(n);
+		auto raw = std::vector<component_id>(n);
+		auto stack = std::vector<component_id>();
+		// node and the position of the next outgoing edge to look at
+		auto frames = std::vector<std::pair<component_id, std::size_t>>();
+		auto next_index = component_id{0};
+
+		auto visit = [&](component_id v) {
+			index[v] = lowlink[v] = next_index++;
+			stack.push_back(v);
+			on_stack[v] = true;
+			frames.emplace_back(v, 0);
+		};
+
+		for (auto root = component_id{0}; root < n; ++root) {
+			if (index[root] != unvisited) {
+				continue;
+			}
+			visit(root);
+			while (!frames.empty()) {
+				auto const v = frames.back().first;
+				auto const targets = g.out_neighbors(v);
+				if (auto& cursor = frames.back().second; cursor < targets.size()) {
+					auto const w = targets[cursor++];
+					if (index[w] == unvisited) {
+						visit(w);
+					}
+					else if (on_stack[w]) {
+						lowlink[v] = std::min(lowlink[v], index[w]);
+					}
+					continue;
+				}
+
+				if (lowlink[v] == index[v]) {
+					auto w = v;
+					do {
+						w = stack.back();
+						stack.pop_back();
+						on_stack[w] = false;
+						raw[w] = v;
+					} while (w != v);
+				}
+				frames.pop_back();
+				if (!frames.empty()) {
+					auto const parent = frames.back().first;
+					lowlink[parent] = std::min(lowlink[parent], lowlink[v]);
+				}
+			}
+		}
+		return detail::densify(raw);
+	}
+
+	template<typename N, typename E>
+	auto strongly_connected_components(graph<N, E> const& g) -> component_labels {
+		return strongly_connected_components(frozen_graph<N, E>(g));
+	}
+
+	// forward-backward decomposition. Nodes with no incoming or no outgoing edge are trimmed off
+	// as singletons in parallel, then each task picks a pivot, and its forward and backward
+	// reachable sets split the task into the pivot's component plus three independent tasks that
+	// the thread pool works through concurrently
+	template<typename N, typename E>
+	auto strongly_connected_components_parallel(frozen_graph<N, E> const& g, std::size_t threads = 0)
+	   -> component_labels {
+		using detail::component_id;
+		[[maybe_unused]] auto const span =
+		   trace::span("gdwg::strongly_connected_components_parallel");
+		constexpr auto done = detail::no_component;
+		auto const n = g.num_nodes();
+		if (n == 0) {
+			return {};
+		}
+
+		auto color = detail::atomic_labels(n);
+		auto raw = std::vector<component_id>(n);
+		auto has_other = [](auto neighbors, component_id v) {
+			return std::any_of(neighbors.begin(), neighbors.end(), [v](auto w) { return w != v; });
+		};
+		detail::parallel_for(n, threads, [&](std::size_t begin, std::size_t end, std::size_t) {
+			for (auto v = static_cast<component_id>(begin); v < end; ++v) {
+				if (!has_other(g.out_neighbors(v), v) || !has_other(g.in_neighbors(v), v)) {
+					raw[v] = v;
+					color[v].store(done, std::memory_order_relaxed);
+				}
+				else {
+					color[v].store(0, std::memory_order_relaxed);
+				}
+			}
+		});
+
+		struct task {
+			component_id color;
+			std::vector<component_id> nodes;
+		};
+		auto queue = std::deque<task>();
+		auto mutex = std::mutex();
+		auto wake = std::condition_variable();
+		auto active = std::size_t{0};
+		auto next_color = std::atomic<component_id>{1};
+
+		auto first = task{0, {}};
+		for (auto v = component_id{0}; v < n; ++v) {
+			if (color[v].load(std::memory_order_relaxed) == 0) {
+				first.nodes.push_back(v);
+			}
+		}
+		if (!first.nodes.empty()) {
+			queue.push_back(std::move(first));
+		}
+
+		auto solve = [&](task work) -> std::vector<task> {
+			auto const pivot = work.nodes.front();
+			if (work.nodes.size() == 1) {
+				raw[pivot] = pivot;
+				color[pivot].store(done, std::memory_order_relaxed);
+				return {};
+			}
+
+			auto const forward = next_color.fetch_add(3, std::memory_order_relaxed);
+			auto const backward = forward + 1;
+			auto const scc = forward + 2;
+			auto frontier = std::vector<component_id>{pivot};
+			color[pivot].store(forward, std::memory_order_relaxed);
+			while (!frontier.empty()) {
+				auto const v = frontier.back();
+				frontier.pop_back();
+				for (auto w : g.out_neighbors(v)) {
+					if (color[w].load(std::memory_order_relaxed) == work.color) {
+						color[w].store(forward, std::memory_order_relaxed);
+						frontier.push_back(w);
+					}
+				}
+			}
+
+			frontier.push_back(pivot);
+			color[pivot].store(scc, std::memory_order_relaxed);
+			while (!frontier.empty()) {
+				auto const v = frontier.back();
+				frontier.pop_back();
+				for (auto w : g.in_neighbors(v)) {
+					auto const c = color[w].load(std::memory_order_relaxed);
+					if (c == forward || c == work.color) {
+						color[w].store(c == forward ? scc : backward, std::memory_order_relaxed);
+						frontier.push_back(w);
+					}
+				}
+			}
+
+			auto split = std::vector<task>{{forward, {}}, {backward, {}}, {work.color, {}}};
+			for (auto v : work.nodes) {
+				auto const c = color[v].load(std::memory_order_relaxed);
+				if (c == scc) {
+					raw[v] = pivot;
+					color[v].store(done, std::memory_order_relaxed);
+				}
+				else {
+					split[c == forward ? 0 : c == backward ? 1 : 2].nodes.push_back(v);
+				}
+			}
+			std::erase_if(split, [](auto const& t) { return t.nodes.empty(); });
+			return split;
+		};
+
+		auto worker = [&]() {
+			auto lock = std::unique_lock(mutex);
+			while (true) {
+				wake.wait(lock, [&] { return !queue.empty() || active == 0; });
+				if (queue.empty()) {
+					return;
+				}
+				auto work = std::move(queue.front());
+				queue.pop_front();
+				++active;
+				lock.unlock();
+				auto more = solve(std::move(work));
+				lock.lock();
+				--active;
+				for (auto& t : more) {
+					queue.push_back(std::move(t));
+				}
+				wake.notify_all();
+			}
+		};
+
+		auto pool = std::vector<std::thread>();
+		for (auto i = std::size_t{1}; i < detail::resolve_threads(threads); ++i) {
+			pool.emplace_back(worker);
+		}
+		worker();
+		for (auto& t : pool) {
+			t.join();
+		}
+		return detail::densify(raw);
+	}
+
+	template<typename N, typename E>
+	auto strongly_connected_components_parallel(graph<N, E> const& g, std::size_t threads = 0)
+	   -> component_labels {
+		return strongly_connected_components_parallel(frozen_graph<N, E>(g), threads);
+	}
+} // namespace gdwg
+
+#endif // GDWG_COMPONENTS_HPP
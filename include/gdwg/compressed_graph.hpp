@@ -0,0 +1,375 @@
+#ifndef GDWG_COMPRESSED_GRAPH_HPP
+#define GDWG_COMPRESSED_GRAPH_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <optional>
+#include <span>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+
+#include "gdwg/detail/varint.hpp"
+#include "gdwg/frozen_graph.hpp"
+#include "gdwg/graph.hpp"
+#include "gdwg/trace.hpp"
+
+// A read only copy of a graph with every outgoing list compressed in the style of WebGraph, for
+// graphs too big to hold as maps of maps. Each source's list is one run of bytes:
+//   distinct neighbour count
+//   first neighbour's offset from the source, zigzag encoded, then the gap to each next one
+//   how many weights go to each neighbour
+//   the weights themselves, for integral E, first in full and then as gaps
+// all as LEB128 varints. Non-integral weights are kept as they are in a separate array. Lists are
+// decoded on demand, so reading one costs a little CPU for a large cut in memory. Nodes are
+// numbered as in the frozen_graph it is built from, and node_order::bfs or
+// node_order::reverse_cuthill_mckee make the gaps, and so the graph, noticeably smaller.
+
+namespace gdwg {
+	template<typename N, typename E>
+	class compressed_graph {
+		static constexpr bool packed_weights = std::is_integral_v<E> && !std::is_same_v<E, bool>;
+
+	public:
+		using node_id = std::uint32_t;
+		using value_type = typename graph<N, E>::value_type;
+
+		// one decoded outgoing list, reusable across calls to avoid reallocating
+		struct row {
+			std::vector<node_id> targets;
+			// weights per target, the weights of targets[i] follow those of targets[i - 1]
+			std::vector<std::uint32_t> counts;
+			std::vector<E> weights;
+		};
+
+		class iterator;
+
+		compressed_graph() = default;
+
+		explicit compressed_graph(graph<N, E> const& g, node_order order = node_order::sorted)
+		: compressed_graph(frozen_graph<N, E>(g, order)) {}
+
+		explicit compressed_graph(frozen_graph<N, E> const& g)
+		: nodes_(g.nodes())
+		, sorted_(g.order() == node_order::sorted)
+		, edge_count_(g.num_edges()) {
+			[[maybe_unused]] auto const span = trace::span("gdwg::compressed_graph::build");
+			if (!sorted_) {
+				by_value_.resize(nodes_.size());
+				for (auto id = node_id{0}; id < nodes_.size(); ++id) {
+					by_value_[id] = id;
+				}
+				std::sort(by_value_.begin(), by_value_.end(), [&](node_id left, node_id right) {
+					return nodes_[left] < nodes_[right];
+				});
+			}
+
+			offsets_.clear();
+			offsets_.reserve(nodes_.size() + 1);
+			bytes_.clear();
+			for (auto src = node_id{0}; src < nodes_.size(); ++src) {
+				offsets_.push_back(bytes_.size());
+				encode(src, g.out_neighbors(src), g.out_weights(src));
+			}
+			offsets_.push_back(bytes_.size());
+			bytes_.resize(bytes_.size() + detail::varint_padding);
+			bytes_.shrink_to_fit();
+			weights_.shrink_to_fit();
+		}
+
+		[[nodiscard]] auto num_nodes() const noexcept -> std::size_t {
+			return nodes_.size();
+		}
+
+		// one per weight
+		[[nodiscard]] auto num_edges() const noexcept -> std::size_t {
+			return edge_count_;
+		}
+
+		[[nodiscard]] auto empty() const noexcept -> bool {
+			return nodes_.empty();
+		}
+
+		[[nodiscard]] auto node(node_id id) const -> N const& {
+			return nodes_[id];
+		}
+
+		[[nodiscard]] auto find(N const& value) const -> std::optional<node_id> {
+			if (sorted_) {
+				auto found = std::lower_bound(nodes_.begin(), nodes_.end(), value);
+				if (found == nodes_.end() || value < *found) {
+					return std::nullopt;
+				}
+				return static_cast<node_id>(found - nodes_.begin());
+			}
+			auto found = std::lower_bound(by_value_.begin(),
+			                              by_value_.end(),
+			                              value,
+			                              [&](node_id id, N const& v) { return nodes_[id] < v; });
+			if (found == by_value_.end() || value < nodes_[*found]) {
+				return std::nullopt;
+			}
+			return *found;
+		}
+
+		[[nodiscard]] auto is_node(N const& value) const -> bool {
+			return find(value).has_value();
+		}
+
+		// every node in id order
+		[[nodiscard]] auto nodes() const noexcept -> std::vector<N> const& {
+			return nodes_;
+		}
+
+		// decodes src's outgoing list into out
+		auto decode(node_id src, row& out) const -> void {
+			auto const* in = bytes_.data() + offsets_[src];
+			auto const distinct = static_cast<std::size_t>(detail::get_varint(in));
+			out.targets.resize(distinct);
+			out.counts.resize(distinct);
+			if (distinct != 0) {
+				// the first offset can need more than 32 bits before it is added to src
+				auto const offset = detail::unzigzag(detail::get_varint(in));
+				out.targets[0] = static_cast<node_id>(static_cast<std::int64_t>(src) + offset);
+				in = detail::get_varints(in, distinct - 1, out.targets.data() + 1);
+				// prefix sums turn the gaps back into ids
+				for (auto i = std::size_t{1}; i < distinct; ++i) {
+					out.targets[i] += out.targets[i - 1] + 1;
+				}
+			}
+			in = detail::get_varints(in, distinct, out.counts.data());
+
+			out.weights.clear();
+			if constexpr (packed_weights) {
+				for (auto count : out.counts) {
+					auto previous = std::uint64_t{0};
+					for (auto k = std::uint32_t{0}; k < count; ++k) {
+						auto const value = detail::get_varint(in);
+						previous = k == 0 ? unpack_first(value) : previous + value + 1;
+						out.weights.push_back(static_cast<E>(previous));
+					}
+				}
+			}
+			else {
+				auto const* first = weights_.data();
+				out.weights.assign(first + weight_offsets_[src], first + weight_offsets_[src + 1]);
+			}
+		}
+
+		// same contract as graph::is_connected
+		[[nodiscard]] auto is_connected(N const& src, N const& dst) const -> bool {
+			auto const from = find(src);
+			auto const to = find(dst);
+			if (!from || !to) {
+				throw std::runtime_error("Cannot call gdwg::compressed_graph<N, E>::is_connected if "
+				                         "src or dst node don't exist in the graph");
+			}
+			auto decoded = row();
+			decode(*from, decoded);
+			return std::binary_search(decoded.targets.begin(), decoded.targets.end(), *to);
+		}
+
+		// same contract as graph::connections
+		[[nodiscard]] auto connections(N const& src) const -> std::vector<N> {
+			auto const from = find(src);
+			if (!from) {
+				throw std::runtime_error("Cannot call gdwg::compressed_graph<N, E>::connections if "
+				                         "src doesn't exist in the graph");
+			}
+			auto decoded = row();
+			decode(*from, decoded);
+			auto res_vector = std::vector<N>();
+			res_vector.reserve(decoded.targets.size());
+			for (auto target : decoded.targets) {
+				res_vector.push_back(nodes_[target]);
+			}
+			if (!sorted_) {
+				std::sort(res_vector.begin(), res_vector.end());
+			}
+			return res_vector;
+		}
+
+		// same contract as graph::weights
+		[[nodiscard]] auto weights(N const& src, N const& dst) const -> std::vector<E> {
+			auto const from = find(src);
+			auto const to = find(dst);
+			if (!from || !to) {
+				throw std::runtime_error("Cannot call gdwg::compressed_graph<N, E>::weights if src or "
+				                         "dst node don't exist in the graph");
+			}
+			auto decoded = row();
+			decode(*from, decoded);
+			auto first = std::size_t{0};
+			for (auto i = std::size_t{0}; i < decoded.targets.size(); ++i) {
+				if (decoded.targets[i] == *to) {
+					auto const begin = decoded.weights.begin() + static_cast<std::ptrdiff_t>(first);
+					return std::vector<E>(begin, begin + decoded.counts[i]);
+				}
+				first += decoded.counts[i];
+			}
+			return {};
+		}
+
+		// every edge by source id, then target id, then weight. The same order as graph's iterator
+		// when the ids are sorted
+		[[nodiscard]] auto begin() const -> iterator {
+			return iterator(this, 0);
+		}
+
+		[[nodiscard]] auto end() const -> iterator {
+			return iterator(this, static_cast<node_id>(nodes_.size()));
+		}
+
+		// bytes held, not counting the node values' own heap storage
+		[[nodiscard]] auto memory_usage() const noexcept -> std::size_t {
+			return nodes_.capacity() * sizeof(N) + by_value_.capacity() * sizeof(node_id)
+			       + offsets_.capacity() * sizeof(std::size_t) + bytes_.capacity()
+			       + weights_.capacity() * sizeof(E)
+			       + weight_offsets_.capacity() * sizeof(std::size_t);
+		}
+
+	private:
+		std::vector<N> nodes_;
+		bool sorted_ = true;
+		// ids in ascending N order when they aren't already
+		std::vector<node_id> by_value_;
+		std::size_t edge_count_ = 0;
+		// where each source's list starts in bytes_
+		std::vector<std::size_t> offsets_{0};
+		std::vector<std::uint8_t> bytes_ = std::vector<std::uint8_t>(detail::varint_padding);
+		// weights that aren't packed into bytes_
+		std::vector<E> weights_;
+		std::vector<std::size_t> weight_offsets_{0};
+
+		// signed weights are zigzagged so small negatives stay short
+		static auto pack_first(E weight) noexcept -> std::uint64_t {
+			if constexpr (std::is_signed_v<E>) {
+				return detail::zigzag(static_cast<std::int64_t>(weight));
+			}
+			else {
+				return static_cast<std::uint64_t>(weight);
+			}
+		}
+
+		static auto unpack_first(std::uint64_t value) noexcept -> std::uint64_t {
+			if constexpr (std::is_signed_v<E>) {
+				return static_cast<std::uint64_t>(detail::unzigzag(value));
+			}
+			else {
+				return value;
+			}
+		}
+
+		auto encode(node_id src, std::span<node_id const> targets, std::span<E const> weights)
+		   -> void {
+			auto distinct = std::vector<node_id>();
+			auto counts = std::vector<std::uint32_t>();
+			for (auto i = std::size_t{0}; i < targets.size(); ++i) {
+				if (i == 0 || targets[i] != targets[i - 1]) {
+					distinct.push_back(targets[i]);
+					counts.push_back(0);
+				}
+				++counts.back();
+			}
+
+			detail::put_varint(bytes_, distinct.size());
+			for (auto i = std::size_t{0}; i < distinct.size(); ++i) {
+				auto const gap = i == 0 ? detail::zigzag(std::int64_t{distinct[0]} - std::int64_t{src})
+				                        : distinct[i] - distinct[i - 1] - 1;
+				detail::put_varint(bytes_, gap);
+			}
+			for (auto count : counts) {
+				detail::put_varint(bytes_, count);
+			}
+
+			if constexpr (packed_weights) {
+				// weights to one target are distinct and ascending, so every gap after the first is
+				// at least one
+				for (auto i = std::size_t{0}; i < weights.size(); ++i) {
+					auto const current = static_cast<std::uint64_t>(weights[i]);
+					auto const first = i == 0 || targets[i] != targets[i - 1];
+					auto const previous = first ? 0 : static_cast<std::uint64_t>(weights[i - 1]);
+					detail::put_varint(bytes_, first ? pack_first(weights[i]) : current - previous - 1);
+				}
+			}
+			else {
+				weights_.insert(weights_.end(), weights.begin(), weights.end());
+				weight_offsets_.push_back(weights_.size());
+			}
+		}
+	};
+
+	template<typename N, typename E>
+	class compressed_graph<N, E>::iterator {
+	public:
+		using value_type = compressed_graph<N, E>::value_type;
+		using reference = value_type;
+		using pointer = void;
+		using difference_type = std::ptrdiff_t;
+		using iterator_category = std::forward_iterator_tag;
+
+		iterator() = default;
+
+		auto operator*() const -> reference {
+			return value_type{owner_->nodes_[src_],
+			                  owner_->nodes_[row_.targets[target_]],
+			                  row_.weights[weight_]};
+		}
+
+		auto operator++() -> iterator& {
+			++weight_;
+			if (++within_ == row_.counts[target_]) {
+				within_ = 0;
+				if (++target_ == row_.targets.size()) {
+					++src_;
+					settle();
+				}
+			}
+			return *this;
+		}
+
+		auto operator++(int) -> iterator {
+			auto temp_val = *this;
+			++*this;
+			return temp_val;
+		}
+
+		friend auto operator==(iterator const& left, iterator const& right) noexcept -> bool {
+			return left.owner_ == right.owner_ && left.src_ == right.src_
+			       && left.weight_ == right.weight_;
+		}
+
+	private:
+		friend class compressed_graph<N, E>;
+
+		compressed_graph const* owner_ = nullptr;
+		node_id src_ = 0;
+		row row_;
+		std::size_t target_ = 0;
+		std::uint32_t within_ = 0;
+		std::size_t weight_ = 0;
+
+		iterator(compressed_graph const* owner, node_id src)
+		: owner_(owner)
+		, src_(src) {
+			settle();
+		}
+
+		// moves to the first source from src_ on with an edge, or to the end
+		auto settle() -> void {
+			target_ = 0;
+			within_ = 0;
+			weight_ = 0;
+			for (; src_ < owner_->nodes_.size(); ++src_) {
+				owner_->decode(src_, row_);
+				if (!row_.targets.empty()) {
+					return;
+				}
+			}
+		}
+	};
+} // namespace gdwg
+
+#endif // GDWG_COMPRESSED_GRAPH_HPP
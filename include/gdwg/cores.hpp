@@ -0,0 +1,354 @@
+#ifndef GDWG_CORES_HPP
+#define GDWG_CORES_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <limits>
+#include <numeric>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "gdwg/detail/parallel.hpp"
+#include "gdwg/detail/simd.hpp"
+#include "gdwg/frozen_graph.hpp"
+#include "gdwg/neighborhood.hpp"
+#include "gdwg/trace.hpp"
+
+// k-core decomposition of the undirected simple graph underneath g, the same one triangle_count
+// looks at. A node's core number is the largest k for which it survives repeatedly removing
+// every node with fewer than k neighbours left. Removing nodes lowest degree first also gives a
+// degeneracy ordering, in which no node has more neighbours after it than the graph's
+// degeneracy, the largest core number.
+//
+// The buckets algorithm is Batagelj and Zaversnik's, O(V + E) on one thread: nodes sit in one
+// array sorted by current degree, and a neighbour losing a degree swaps to the front of its
+// bucket and moves the boundary along. Parallel peeling removes every node at or below the
+// current level at once, with neighbours' degrees dropped by atomic decrements, and those that
+// fall to the level are peeled in the next sub round. Both give the same core numbers. Their
+// orders can differ but either is a degeneracy ordering.
+//
+// Orienting edges along a degeneracy ordering leaves every node at most that many neighbours
+// after it, which bounds the work of triangle_count and maximal_cliques given the cores.
+
+namespace gdwg {
+	enum class core_algorithm {
+		buckets,
+		parallel_peeling,
+	};
+
+	struct core_options {
+		core_algorithm algorithm = core_algorithm::buckets;
+		// 0 means one per hardware thread, only parallel peeling uses more than one
+		std::size_t threads = 0;
+	};
+
+	struct core_decomposition {
+		// core[id] for every node id
+		std::vector<std::uint32_t> core;
+		// every node id in the order it was peeled
+		std::vector<std::uint32_t> order;
+		std::uint32_t degeneracy = 0;
+	};
+
+	namespace detail {
+		inline auto bucket_cores(undirected_rows const& rows) -> core_decomposition {
+			using node_id = undirected_rows::node_id;
+			auto const n = rows.size();
+			auto degree = std::vector<std::uint32_t>(n);
+			auto most = std::uint32_t{0};
+			for (auto v = node_id{0}; v < n; ++v) {
+				degree[v] = static_cast<std::uint32_t>(rows.degree(v));
+				most = std::max(most, degree[v]);
+			}
+
+			// start[d] is where the nodes of degree d begin in order
+			auto start = std::vector<std::size_t>(most + 2);
+			for (auto d : degree) {
+				++start[d + 1];
+			}
+			std::partial_sum(start.begin(), start.end(), start.begin());
+			auto result = core_decomposition{std::vector<std::uint32_t>(n), {}, 0};
+			auto& order = result.order;
+			order.resize(n);
+			auto position = std::vector<std::size_t>(n);
+			{
+				auto fill = start;
+				for (auto v = node_id{0}; v < n; ++v) {
+					position[v] = fill[degree[v]]++;
+					order[position[v]] = v;
+				}
+			}
+
+			for (auto i = std::size_t{0}; i < n; ++i) {
+				auto const v = order[i];
+				result.core[v] = degree[v];
+				result.degeneracy = std::max(result.degeneracy, degree[v]);
+				for (auto w : rows.row(v)) {
+					if (degree[w] <= degree[v]) {
+						continue;
+					}
+					// swap w to the front of its bucket, then shrink the bucket past it
+					auto const d = degree[w];
+					auto const front = start[d];
+					auto const u = order[front];
+					if (u != w) {
+						std::swap(order[front], order[position[w]]);
+						position[u] = position[w];
+						position[w] = front;
+					}
+					++start[d];
+					--degree[w];
+				}
+			}
+			return result;
+		}
+
+		inline auto peel_cores(undirected_rows const& rows, std::size_t threads)
+		   -> core_decomposition {
+			using node_id = undirected_rows::node_id;
+			constexpr auto unpeeled = std::numeric_limits<std::uint32_t>::max();
+			auto const n = rows.size();
+			auto const workers = resolve_threads(threads);
+			auto result = core_decomposition{std::vector<std::uint32_t>(n, unpeeled), {}, 0};
+			result.order.reserve(n);
+			auto degree = std::vector<std::atomic<std::uint32_t>>(n);
+			auto remaining = std::vector<node_id>(n);
+			parallel_for(n, workers, [&](std::size_t begin, std::size_t end, std::size_t) {
+				for (auto v = begin; v < end; ++v) {
+					degree[v].store(static_cast<std::uint32_t>(rows.degree(static_cast<node_id>(v))),
+					                std::memory_order_relaxed);
+					remaining[v] = static_cast<node_id>(v);
+				}
+			});
+
+			auto found = std::vector<std::vector<node_id>>(workers);
+			auto lowest = std::vector<std::uint32_t>(workers);
+			// gathers every thread's finds into one list, ascending so the order is repeatable
+			auto const gather = [&](std::vector<node_id>& into) {
+				into.clear();
+				for (auto& mine : found) {
+					into.insert(into.end(), mine.begin(), mine.end());
+					mine.clear();
+				}
+				std::sort(into.begin(), into.end());
+			};
+
+			auto level = std::uint32_t{0};
+			auto frontier = std::vector<node_id>();
+			auto kept = std::vector<node_id>();
+			while (!remaining.empty()) {
+				// skip straight to the lowest degree left, then split off everything at or below it
+				std::fill(lowest.begin(), lowest.end(), unpeeled);
+				auto const scan = [&](std::size_t begin, std::size_t end, std::size_t t) {
+					for (auto i = begin; i < end; ++i) {
+						auto const d = degree[remaining[i]].load(std::memory_order_relaxed);
+						lowest[t] = std::min(lowest[t], d);
+					}
+				};
+				parallel_for(remaining.size(), workers, scan);
+				level = std::max(level, *std::min_element(lowest.begin(), lowest.end()));
+				kept.clear();
+				for (auto v : remaining) {
+					(degree[v].load(std::memory_order_relaxed) <= level ? frontier : kept).push_back(v);
+				}
+				remaining.swap(kept);
+
+				while (!frontier.empty()) {
+					for (auto v : frontier) {
+						result.core[v] = level;
+						result.order.push_back(v);
+					}
+					auto const peel = [&](std::size_t begin, std::size_t end, std::size_t t) {
+						for (auto i = begin; i < end; ++i) {
+							for (auto w : rows.row(frontier[i])) {
+								if (result.core[w] != unpeeled) {
+									continue;
+								}
+								// exactly one decrement takes w from level + 1 down to level
+								if (degree[w].fetch_sub(1, std::memory_order_relaxed) == level + 1) {
+									found[t].push_back(w);
+								}
+							}
+						}
+					};
+					parallel_for(frontier.size(), workers, peel);
+					gather(frontier);
+				}
+				result.degeneracy = level;
+				std::erase_if(remaining, [&](node_id v) { return result.core[v] != unpeeled; });
+			}
+			return result;
+		}
+
+		// where each node sits in the order
+		inline auto ranks(core_decomposition const& cores, std::size_t n, char const* caller)
+		   -> std::vector<std::uint32_t> {
+			if (cores.order.size() != n) {
+				throw std::runtime_error(std::string("Cannot call gdwg::") + caller
+				                         + " with the cores of a different graph");
+			}
+			auto rank = std::vector<std::uint32_t>(n);
+			for (auto i = std::size_t{0}; i < n; ++i) {
+				rank[cores.order[i]] = static_cast<std::uint32_t>(i);
+			}
+			return rank;
+		}
+
+		// Bron and Kerbosch with Tomita's pivot, over sorted candidate and excluded sets
+		template<typename Sink>
+		class clique_search {
+		public:
+			using node_id = undirected_rows::node_id;
+
+			clique_search(undirected_rows const& rows, Sink& sink, std::size_t thread)
+			: rows_(rows)
+			, sink_(sink)
+			, thread_(thread) {}
+
+			// every maximal clique holding v and otherwise only nodes in candidates, none of which
+			// is a superset of excluded's neighbours
+			auto run(node_id v, std::vector<node_id> candidates, std::vector<node_id> excluded)
+			   -> std::uint64_t {
+				found_ = 0;
+				clique_.assign(1, v);
+				expand(std::move(candidates), std::move(excluded));
+				return found_;
+			}
+
+		private:
+			undirected_rows const& rows_;
+			Sink& sink_;
+			std::size_t thread_;
+			std::vector<node_id> clique_;
+			std::vector<node_id> sorted_;
+			std::uint64_t found_ = 0;
+
+			auto within(std::vector<node_id> const& set, node_id v) const -> std::vector<node_id> {
+				auto const row = rows_.row(v);
+				auto common = std::vector<node_id>(std::min(set.size(), row.size()));
+				common.resize(intersect(set, row, common.data()));
+				return common;
+			}
+
+			auto expand(std::vector<node_id> candidates, std::vector<node_id> excluded) -> void {
+				if (candidates.empty()) {
+					if (excluded.empty()) {
+						sorted_ = clique_;
+						std::sort(sorted_.begin(), sorted_.end());
+						sink_(std::span<node_id const>(sorted_), thread_);
+						++found_;
+					}
+					return;
+				}
+
+				// the pivot that leaves the fewest branches, one per candidate it isn't joined to
+				auto pivot = candidates.front();
+				auto most = std::size_t{0};
+				for (auto const* set : {&candidates, &excluded}) {
+					for (auto u : *set) {
+						auto const shared = intersect(candidates, rows_.row(u));
+						if (shared > most) {
+							most = shared;
+							pivot = u;
+						}
+					}
+				}
+				auto branches = std::vector<node_id>();
+				std::set_difference(candidates.begin(),
+				                    candidates.end(),
+				                    rows_.row(pivot).begin(),
+				                    rows_.row(pivot).end(),
+				                    std::back_inserter(branches));
+
+				for (auto v : branches) {
+					clique_.push_back(v);
+					expand(within(candidates, v), within(excluded, v));
+					clique_.pop_back();
+					candidates.erase(std::lower_bound(candidates.begin(), candidates.end(), v));
+					excluded.insert(std::lower_bound(excluded.begin(), excluded.end(), v), v);
+				}
+			}
+		};
+	} // namespace detail
+
+	template<typename N, typename E>
+	auto k_core_decomposition(frozen_graph<N, E> const& g, core_options const& options = {})
+	   -> core_decomposition {
+		[[maybe_unused]] auto const span = trace::span("gdwg::k_core_decomposition");
+		auto const rows = detail::make_undirected_rows(g);
+		return options.algorithm == core_algorithm::parallel_peeling
+		          ? detail::peel_cores(rows, options.threads)
+		          : detail::bucket_cores(rows);
+	}
+
+	// ids line up with g.nodes()
+	template<typename N, typename E>
+	auto k_core_decomposition(graph<N, E> const& g, core_options const& options = {})
+	   -> core_decomposition {
+		return k_core_decomposition(frozen_graph<N, E>(g), options);
+	}
+
+	// triangle_count with edges oriented along the degeneracy ordering, so no node keeps more
+	// than cores.degeneracy neighbours
+	template<typename N, typename E>
+	auto triangle_count(frozen_graph<N, E> const& g,
+	                    core_decomposition const& cores,
+	                    std::size_t threads = 0) -> std::uint64_t {
+		[[maybe_unused]] auto const span = trace::span("gdwg::triangle_count");
+		auto const rank = detail::ranks(cores, g.num_nodes(), "triangle_count");
+		auto const lower = [&](std::uint32_t left, std::uint32_t right) {
+			return rank[left] < rank[right];
+		};
+		return detail::count_triangles(detail::make_undirected_rows(g), lower, threads);
+	}
+
+	// Every maximal clique of the undirected simple graph underneath g, isolated nodes included,
+	// passed to sink(std::span<node_id const>, std::size_t thread) as ascending ids. Following
+	// Eppstein, Loffler and Strash, each clique is searched for from its earliest node in the
+	// degeneracy ordering, among that node's later neighbours, so no search starts with more
+	// than cores.degeneracy candidates. Sinks run on several threads at once unless threads is
+	// 1. Returns how many cliques there were
+	template<typename N, typename E, typename Sink>
+	auto maximal_cliques(frozen_graph<N, E> const& g,
+	                     core_decomposition const& cores,
+	                     Sink&& sink,
+	                     std::size_t threads = 0) -> std::uint64_t {
+		using node_id = std::uint32_t;
+		[[maybe_unused]] auto const span = trace::span("gdwg::maximal_cliques");
+		auto const n = g.num_nodes();
+		auto const rank = detail::ranks(cores, n, "maximal_cliques");
+		auto const rows = detail::make_undirected_rows(g);
+
+		constexpr auto block = std::size_t{16};
+		auto next = std::atomic<std::size_t>(0);
+		auto total = std::atomic<std::uint64_t>(0);
+		auto const workers = detail::resolve_threads(threads);
+		detail::parallel_for(workers, workers, [&](std::size_t, std::size_t, std::size_t t) {
+			auto search = detail::clique_search<std::remove_reference_t<Sink>>(rows, sink, t);
+			auto mine = std::uint64_t{0};
+			auto later = std::vector<node_id>();
+			auto earlier = std::vector<node_id>();
+			for (auto begin = next.fetch_add(block); begin < n; begin = next.fetch_add(block)) {
+				for (auto v = static_cast<node_id>(begin); v < std::min(begin + block, n); ++v) {
+					later.clear();
+					earlier.clear();
+					for (auto w : rows.row(v)) {
+						(rank[w] > rank[v] ? later : earlier).push_back(w);
+					}
+					mine += search.run(v, later, earlier);
+				}
+			}
+			total.fetch_add(mine, std::memory_order_relaxed);
+		});
+		return total.load();
+	}
+} // namespace gdwg
+
+#endif // GDWG_CORES_HPP
@@ -0,0 +1,32 @@
+#ifndef GDWG_DETAIL_ATTACHED_OBSERVER_HPP
+#define GDWG_DETAIL_ATTACHED_OBSERVER_HPP
+
+#include "gdwg/graph.hpp"
+
+namespace gdwg::detail {
+	// base for structures kept in step with one graph. Holds on to the graph until either side is
+	// destroyed, derived classes subscribe once they are ready for changes. Unsubscribing on
+	// destruction is left to graph<N, E>::observer
+	template<typename N, typename E>
+	class attached_observer : protected graph<N, E>::observer {
+	public:
+		attached_observer(attached_observer const&) = delete;
+		auto operator=(attached_observer const&) -> attached_observer& = delete;
+
+	protected:
+		explicit attached_observer(graph<N, E>& g)
+		: graph_(&g) {}
+
+		auto subscribe() -> void {
+			graph_->subscribe(*this);
+		}
+
+		auto detached() -> void override {
+			graph_ = nullptr;
+		}
+
+		graph<N, E>* graph_;
+	};
+} // namespace gdwg::detail
+
+#endif // GDWG_DETAIL_ATTACHED_OBSERVER_HPP
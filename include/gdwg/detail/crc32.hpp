@@ -0,0 +1,50 @@
+#ifndef GDWG_DETAIL_CRC32_HPP
+#define GDWG_DETAIL_CRC32_HPP
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#if defined(__SSE4_2__)
+#include <nmmintrin.h>
+#endif
+
+// CRC-32C, the Castagnoli polynomial, for checking what was written to disk. With SSE4.2 the
+// crc32 instruction takes eight bytes at a time, otherwise a byte at a time from a table.
+
+namespace gdwg::detail {
+	inline constexpr auto crc32c_table = [] {
+		auto table = std::array<std::uint32_t, 256>();
+		for (auto i = std::uint32_t{0}; i < 256; ++i) {
+			auto crc = i;
+			for (auto bit = 0; bit < 8; ++bit) {
+				crc = (crc >> 1U) ^ ((crc & 1U) != 0 ? 0x82f63b78U : 0U);
+			}
+			table[i] = crc;
+		}
+		return table;
+	}();
+
+	// extends crc, the checksum of everything before data, so a buffer can be checked in pieces
+	inline auto crc32c(void const* data, std::size_t size, std::uint32_t crc = 0) noexcept
+	   -> std::uint32_t {
+		auto const* bytes = static_cast<std::uint8_t const*>(data);
+		crc = ~crc;
+#if defined(__SSE4_2__)
+		auto wide = std::uint64_t{crc};
+		for (; size >= 8; size -= 8, bytes += 8) {
+			auto word = std::uint64_t{0};
+			std::memcpy(&word, bytes, sizeof(word));
+			wide = _mm_crc32_u64(wide, word);
+		}
+		crc = static_cast<std::uint32_t>(wide);
+#endif
+		for (; size != 0; --size) {
+			crc = (crc >> 8U) ^ crc32c_table[(crc ^ *bytes++) & 0xffU];
+		}
+		return ~crc;
+	}
+} // namespace gdwg::detail
+
+#endif // GDWG_DETAIL_CRC32_HPP
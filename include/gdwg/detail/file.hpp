@@ -0,0 +1,158 @@
+#ifndef GDWG_DETAIL_FILE_HPP
+#define GDWG_DETAIL_FILE_HPP
+
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// The few POSIX file operations durable storage needs, where std::fstream can't say when bytes
+// have reached the disk.
+
+namespace gdwg::detail {
+	inline auto file_error(char const* what, std::filesystem::path const& path)
+	   -> std::runtime_error {
+		return std::runtime_error(std::string("Cannot ") + what + " " + path.string() + ": "
+		                          + std::strerror(errno));
+	}
+
+	// owns an open file descriptor and closes it on destruction
+	class file {
+	public:
+		file() = default;
+
+		file(std::filesystem::path path, int flags)
+		: path_(std::move(path))
+		, fd_(::open(path_.c_str(), flags | O_CLOEXEC, 0644)) {
+			if (fd_ < 0) {
+				throw file_error("open", path_);
+			}
+		}
+
+		file(file&& other) noexcept
+		: path_(std::move(other.path_))
+		, fd_(std::exchange(other.fd_, -1)) {}
+
+		auto operator=(file&& other) noexcept -> file& {
+			if (this != &other) {
+				close();
+				path_ = std::move(other.path_);
+				fd_ = std::exchange(other.fd_, -1);
+			}
+			return *this;
+		}
+
+		file(file const&) = delete;
+		auto operator=(file const&) -> file& = delete;
+
+		~file() {
+			close();
+		}
+
+		[[nodiscard]] auto is_open() const noexcept -> bool {
+			return fd_ >= 0;
+		}
+
+		auto write(void const* data, std::size_t size) -> void {
+			auto const* bytes = static_cast<std::uint8_t const*>(data);
+			while (size != 0) {
+				auto const written = ::write(fd_, bytes, size);
+				if (written < 0 && errno == EINTR) {
+					continue;
+				}
+				if (written < 0) {
+					throw file_error("write to", path_);
+				}
+				bytes += written;
+				size -= static_cast<std::size_t>(written);
+			}
+		}
+
+		// returns once everything written so far would survive a crash
+		auto sync() -> void {
+			if (::fdatasync(fd_) != 0) {
+				throw file_error("sync", path_);
+			}
+		}
+
+		auto truncate(std::size_t size) -> void {
+			if (::ftruncate(fd_, static_cast<off_t>(size)) != 0) {
+				throw file_error("truncate", path_);
+			}
+		}
+
+		auto close() noexcept -> void {
+			if (fd_ >= 0) {
+				::close(fd_);
+				fd_ = -1;
+			}
+		}
+
+	private:
+		std::filesystem::path path_;
+		int fd_ = -1;
+	};
+
+	// the whole file, or nothing if it doesn't exist
+	inline auto read_file(std::filesystem::path const& path)
+	   -> std::optional<std::vector<std::uint8_t>> {
+		auto const fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+		if (fd < 0 && errno == ENOENT) {
+			return std::nullopt;
+		}
+		if (fd < 0) {
+			throw file_error("open", path);
+		}
+		auto bytes = std::vector<std::uint8_t>();
+		auto chunk = std::vector<std::uint8_t>(1 << 16);
+		for (;;) {
+			auto const got = ::read(fd, chunk.data(), chunk.size());
+			if (got < 0 && errno == EINTR) {
+				continue;
+			}
+			if (got < 0) {
+				auto const error = file_error("read", path);
+				::close(fd);
+				throw error;
+			}
+			if (got == 0) {
+				break;
+			}
+			bytes.insert(bytes.end(), chunk.begin(), chunk.begin() + got);
+		}
+		::close(fd);
+		return bytes;
+	}
+
+	// makes renames and new files in directory survive a crash
+	inline auto sync_directory(std::filesystem::path const& directory) -> void {
+		file(directory, O_RDONLY | O_DIRECTORY).sync();
+	}
+
+	// swaps bytes in as the contents of path all at once, readers see either the old file or the
+	// new one even after a crash
+	inline auto replace_file(std::filesystem::path const& path,
+	                         std::vector<std::uint8_t> const& bytes) -> void {
+		auto temporary = path;
+		temporary += ".tmp";
+		{
+			auto out = file(temporary, O_WRONLY | O_CREAT | O_TRUNC);
+			out.write(bytes.data(), bytes.size());
+			out.sync();
+		}
+		std::filesystem::rename(temporary, path);
+		sync_directory(path.parent_path());
+	}
+} // namespace gdwg::detail
+
+#endif // GDWG_DETAIL_FILE_HPP
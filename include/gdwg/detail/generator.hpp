@@ -0,0 +1,147 @@
+#ifndef GDWG_DETAIL_GENERATOR_HPP
+#define GDWG_DETAIL_GENERATOR_HPP
+
+#include <coroutine>
+#include <cstddef>
+#include <exception>
+#include <iterator>
+#include <memory>
+#include <ranges>
+#include <utility>
+
+// A lazily evaluated input range backed by a coroutine, until std::generator arrives with C++23.
+// The coroutine runs only as far as the next co_yield each time the iterator advances, so a
+// consumer that stops early never pays for the rest. Each yielded value lives until the next
+// advance. Exceptions thrown by the coroutine come out of the advance that resumed it.
+
+namespace gdwg::detail {
+	template<typename T>
+	class generator : public std::ranges::view_base {
+	public:
+		class promise_type;
+
+	private:
+		using handle = std::coroutine_handle<promise_type>;
+
+	public:
+		class promise_type {
+		public:
+			auto get_return_object() noexcept -> generator {
+				return generator(handle::from_promise(*this));
+			}
+
+			auto initial_suspend() const noexcept -> std::suspend_always {
+				return {};
+			}
+
+			auto final_suspend() const noexcept -> std::suspend_always {
+				return {};
+			}
+
+			// the yielded temporary outlives the suspension, so only its address is kept
+			auto yield_value(T const& value) noexcept -> std::suspend_always {
+				current_ = std::addressof(value);
+				return {};
+			}
+
+			auto return_void() const noexcept -> void {}
+
+			auto unhandled_exception() noexcept -> void {
+				error_ = std::current_exception();
+			}
+
+			// co_await makes no sense inside a generator
+			auto await_transform() = delete;
+
+		private:
+			friend class generator;
+			T const* current_ = nullptr;
+			std::exception_ptr error_;
+		};
+
+		class iterator {
+		public:
+			using value_type = T;
+			using reference = T const&;
+			using difference_type = std::ptrdiff_t;
+			using iterator_concept = std::input_iterator_tag;
+
+			iterator() = default;
+
+			auto operator*() const noexcept -> reference {
+				return *coroutine_.promise().current_;
+			}
+
+			auto operator++() -> iterator& {
+				advance(coroutine_);
+				return *this;
+			}
+
+			auto operator++(int) -> void {
+				++*this;
+			}
+
+			friend auto operator==(iterator const& it, std::default_sentinel_t) noexcept -> bool {
+				return !it.coroutine_ || it.coroutine_.done();
+			}
+
+		private:
+			friend class generator;
+			handle coroutine_ = nullptr;
+
+			explicit iterator(handle coroutine) noexcept
+			: coroutine_(coroutine) {}
+		};
+
+		generator() = default;
+
+		generator(generator&& other) noexcept
+		: coroutine_(std::exchange(other.coroutine_, nullptr)) {}
+
+		auto operator=(generator&& other) noexcept -> generator& {
+			if (this != &other) {
+				destroy();
+				coroutine_ = std::exchange(other.coroutine_, nullptr);
+			}
+			return *this;
+		}
+
+		~generator() {
+			destroy();
+		}
+
+		// runs the coroutine to its first co_yield, call once
+		auto begin() -> iterator {
+			if (coroutine_) {
+				advance(coroutine_);
+			}
+			return iterator(coroutine_);
+		}
+
+		auto end() const noexcept -> std::default_sentinel_t {
+			return std::default_sentinel;
+		}
+
+	private:
+		handle coroutine_ = nullptr;
+
+		explicit generator(handle coroutine) noexcept
+		: coroutine_(coroutine) {}
+
+		static auto advance(handle coroutine) -> void {
+			coroutine.resume();
+			if (auto error = std::exchange(coroutine.promise().error_, nullptr)) {
+				std::rethrow_exception(error);
+			}
+		}
+
+		auto destroy() noexcept -> void {
+			if (coroutine_) {
+				coroutine_.destroy();
+				coroutine_ = nullptr;
+			}
+		}
+	};
+} // namespace gdwg::detail
+
+#endif // GDWG_DETAIL_GENERATOR_HPP
@@ -0,0 +1,208 @@
+#ifndef GDWG_DETAIL_NODE_ORDER_HPP
+#define GDWG_DETAIL_NODE_ORDER_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <numeric>
+#include <span>
+#include <unordered_map>
+#include <vector>
+
+// Relabelling passes for frozen_graph. Each one looks at the graph with edge directions ignored
+// and returns every old id once, in the order the nodes should be renumbered.
+
+namespace gdwg::detail {
+	using order_id = std::uint32_t;
+
+	// outgoing and incoming rows of a compressed sparse row snapshot
+	struct csr_rows {
+		std::span<std::size_t const> out_offsets;
+		std::span<order_id const> out_targets;
+		std::span<std::size_t const> in_offsets;
+		std::span<order_id const> in_sources;
+
+		[[nodiscard]] auto size() const noexcept -> std::size_t {
+			return out_offsets.size() - 1;
+		}
+
+		[[nodiscard]] auto degree(order_id v) const noexcept -> std::size_t {
+			return out_offsets[v + 1] - out_offsets[v] + in_offsets[v + 1] - in_offsets[v];
+		}
+
+		// every neighbour in either direction, once per edge
+		template<typename Fn>
+		auto for_each_neighbour(order_id v, Fn&& fn) const -> void {
+			for (auto e = out_offsets[v]; e < out_offsets[v + 1]; ++e) {
+				fn(out_targets[e]);
+			}
+			for (auto e = in_offsets[v]; e < in_offsets[v + 1]; ++e) {
+				fn(in_sources[e]);
+			}
+		}
+	};
+
+	// highest degree first, so hubs share the first few cache lines
+	inline auto degree_order(csr_rows const& rows) -> std::vector<order_id> {
+		auto order = std::vector<order_id>(rows.size());
+		std::iota(order.begin(), order.end(), order_id{0});
+		std::stable_sort(order.begin(), order.end(), [&](order_id left, order_id right) {
+			return rows.degree(left) > rows.degree(right);
+		});
+		return order;
+	}
+
+	// breadth first from each unnumbered node in turn
+	inline auto bfs_order(csr_rows const& rows) -> std::vector<order_id> {
+		auto order = std::vector<order_id>();
+		order.reserve(rows.size());
+		auto visited = std::vector<bool>(rows.size());
+		for (auto root = order_id{0}; root < rows.size(); ++root) {
+			if (visited[root]) {
+				continue;
+			}
+			visited[root] = true;
+			order.push_back(root);
+			for (auto i = order.size() - 1; i < order.size(); ++i) {
+				rows.for_each_neighbour(order[i], [&](order_id w) {
+					if (!visited[w]) {
+						visited[w] = true;
+						order.push_back(w);
+					}
+				});
+			}
+		}
+		return order;
+	}
+
+	// Cuthill-McKee from a lowest degree node of each component, neighbours by ascending degree,
+	// reversed at the end. Keeps every edge close to the diagonal of the adjacency matrix
+	inline auto reverse_cuthill_mckee_order(csr_rows const& rows) -> std::vector<order_id> {
+		auto by_degree = std::vector<order_id>(rows.size());
+		std::iota(by_degree.begin(), by_degree.end(), order_id{0});
+		std::stable_sort(by_degree.begin(), by_degree.end(), [&](order_id left, order_id right) {
+			return rows.degree(left) < rows.degree(right);
+		});
+
+		auto order = std::vector<order_id>();
+		order.reserve(rows.size());
+		auto visited = std::vector<bool>(rows.size());
+		auto fresh = std::vector<order_id>();
+		for (auto root : by_degree) {
+			if (visited[root]) {
+				continue;
+			}
+			visited[root] = true;
+			order.push_back(root);
+			for (auto i = order.size() - 1; i < order.size(); ++i) {
+				fresh.clear();
+				rows.for_each_neighbour(order[i], [&](order_id w) {
+					if (!visited[w]) {
+						visited[w] = true;
+						fresh.push_back(w);
+					}
+				});
+				std::stable_sort(fresh.begin(), fresh.end(), [&](order_id left, order_id right) {
+					return rows.degree(left) < rows.degree(right);
+				});
+				order.insert(order.end(), fresh.begin(), fresh.end());
+			}
+		}
+		std::reverse(order.begin(), order.end());
+		return order;
+	}
+
+	// Rabbit order: visiting nodes from lowest degree up, each community is merged into the
+	// neighbouring community that raises modularity the most, if any does. Merges form a
+	// dendrogram, and a depth first walk of it numbers every community contiguously, with its
+	// tightest sub-communities next to each other
+	inline auto community_order(csr_rows const& rows) -> std::vector<order_id> {
+		auto const n = rows.size();
+		auto degree = std::vector<double>(n);
+		auto adjacent = std::vector<std::unordered_map<order_id, double>>(n);
+		auto total = 0.0;
+		for (auto v = order_id{0}; v < n; ++v) {
+			rows.for_each_neighbour(v, [&](order_id w) {
+				if (w != v) {
+					adjacent[v][w] += 1.0;
+					degree[v] += 1.0;
+				}
+			});
+			total += degree[v];
+		}
+
+		// union-find over communities, a node's parent is the community it was merged into
+		auto parent = std::vector<order_id>(n);
+		std::iota(parent.begin(), parent.end(), order_id{0});
+		auto find = [&](order_id v) {
+			while (parent[v] != v) {
+				parent[v] = parent[parent[v]];
+				v = parent[v];
+			}
+			return v;
+		};
+		auto children = std::vector<std::vector<order_id>>(n);
+
+		auto by_degree = std::vector<order_id>(n);
+		std::iota(by_degree.begin(), by_degree.end(), order_id{0});
+		std::stable_sort(by_degree.begin(), by_degree.end(), [&](order_id left, order_id right) {
+			return degree[left] < degree[right];
+		});
+
+		auto merged = std::unordered_map<order_id, double>();
+		for (auto u : by_degree) {
+			// edges to communities since merged away are re-keyed by their current community
+			merged.clear();
+			for (auto const& [w, weight] : adjacent[u]) {
+				if (auto const c = find(w); c != u) {
+					merged[c] += weight;
+				}
+			}
+
+			// modularity gain of joining u and c is proportional to this
+			auto best = u;
+			auto best_gain = 0.0;
+			for (auto const& [c, weight] : merged) {
+				auto const gain = weight - degree[u] * degree[c] / total;
+				if (gain > best_gain || (gain == best_gain && best != u && c < best)) {
+					best = c;
+					best_gain = gain;
+				}
+			}
+			if (best == u) {
+				adjacent[u].swap(merged);
+				continue;
+			}
+
+			parent[u] = best;
+			children[best].push_back(u);
+			degree[best] += degree[u];
+			for (auto const& [c, weight] : merged) {
+				if (c != best) {
+					adjacent[best][c] += weight;
+				}
+			}
+			adjacent[best].erase(u);
+			adjacent[u] = {};
+		}
+
+		auto order = std::vector<order_id>();
+		order.reserve(n);
+		auto stack = std::vector<order_id>();
+		for (auto root = order_id{0}; root < n; ++root) {
+			if (parent[root] != root) {
+				continue;
+			}
+			stack.push_back(root);
+			while (!stack.empty()) {
+				auto const v = stack.back();
+				stack.pop_back();
+				order.push_back(v);
+				stack.insert(stack.end(), children[v].rbegin(), children[v].rend());
+			}
+		}
+		return order;
+	}
+} // namespace gdwg::detail
+
+#endif // GDWG_DETAIL_NODE_ORDER_HPP
@@ -0,0 +1,84 @@
+#ifndef GDWG_DETAIL_PARALLEL_HPP
+#define GDWG_DETAIL_PARALLEL_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace gdwg::detail {
+	// 0 means one thread per hardware thread
+	inline auto resolve_threads(std::size_t threads) noexcept -> std::size_t {
+		if (threads != 0) {
+			return threads;
+		}
+		return std::max<std::size_t>(1, std::thread::hardware_concurrency());
+	}
+
+	// splits [0, n) into one contiguous chunk per thread and calls fn(begin, end, thread_index) on
+	// each. The calling thread runs the first chunk. The first exception thrown by any chunk is
+	// rethrown once every thread has finished
+	template<typename Fn>
+	auto parallel_for(std::size_t n, std::size_t threads, Fn&& fn) -> void {
+		threads = std::min(resolve_threads(threads), std::max<std::size_t>(n, 1));
+		if (threads == 1) {
+			fn(std::size_t{0}, n, std::size_t{0});
+			return;
+		}
+
+		auto error = std::exception_ptr();
+		auto error_mutex = std::mutex();
+		auto run = [&](std::size_t index) {
+			try {
+				fn(n * index / threads, n * (index + 1) / threads, index);
+			} catch (...) {
+				auto lock = std::scoped_lock(error_mutex);
+				if (!error) {
+					error = std::current_exception();
+				}
+			}
+		};
+
+		auto workers = std::vector<std::thread>();
+		workers.reserve(threads - 1);
+		for (auto index = std::size_t{1}; index < threads; ++index) {
+			workers.emplace_back(run, index);
+		}
+		run(0);
+		for (auto& worker : workers) {
+			worker.join();
+		}
+		if (error) {
+			std::rethrow_exception(error);
+		}
+	}
+
+	// sorts one chunk per thread, then merges neighbouring chunks in pairs, each level of merges
+	// also in parallel. Inputs too small to be worth splitting are sorted on the calling thread
+	template<typename It, typename Less>
+	auto parallel_sort(It first, It last, Less less, std::size_t threads) -> void {
+		constexpr auto smallest_chunk = std::size_t{1} << 14U;
+		auto const n = static_cast<std::size_t>(last - first);
+		auto const chunks =
+		   std::min(resolve_threads(threads), std::max<std::size_t>(n / smallest_chunk, 1));
+		auto const at = [&](std::size_t chunk) {
+			return first + static_cast<std::ptrdiff_t>(n * std::min(chunk, chunks) / chunks);
+		};
+		parallel_for(chunks, chunks, [&](std::size_t begin, std::size_t end, std::size_t) {
+			std::sort(at(begin), at(end), less);
+		});
+		for (auto width = std::size_t{1}; width < chunks; width *= 2) {
+			auto const pairs = (chunks + 2 * width - 1) / (2 * width);
+			parallel_for(pairs, pairs, [&](std::size_t begin, std::size_t end, std::size_t) {
+				for (auto pair = begin; pair < end; ++pair) {
+					auto const left = pair * 2 * width;
+					std::inplace_merge(at(left), at(left + width), at(left + 2 * width), less);
+				}
+			});
+		}
+	}
+} // namespace gdwg::detail
+
+#endif // GDWG_DETAIL_PARALLEL_HPP
@@ -0,0 +1,107 @@
+#ifndef GDWG_DETAIL_SIMD_HPP
+#define GDWG_DETAIL_SIMD_HPP
+
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+// Vector kernels for the bulk algorithms. Each picks the widest instruction set the translation
+// unit is compiled for, AVX2 with -mavx2 or -march=native, else SSE2, which every x86-64 target
+// has, else plain loops.
+
+namespace gdwg::detail {
+	// sum of coef[i] * values[index[i]] for i in [0, count)
+	inline auto gather_dot(double const* values,
+	                       std::uint32_t const* index,
+	                       double const* coef,
+	                       std::size_t count) noexcept -> double {
+		auto i = std::size_t{0};
+#if defined(__AVX2__)
+		auto sum = _mm256_setzero_pd();
+		for (; i + 4 <= count; i += 4) {
+			// widened to 64 bits, the 32 bit gather would read ids past 2^31 as negative
+			auto const at = _mm256_cvtepu32_epi64(
+			   _mm_loadu_si128(reinterpret_cast<__m128i const*>(index + i)));
+			auto const gathered = _mm256_i64gather_pd(values, at, sizeof(double));
+			sum = _mm256_add_pd(sum, _mm256_mul_pd(gathered, _mm256_loadu_pd(coef + i)));
+		}
+		auto const halves = _mm_add_pd(_mm256_castpd256_pd128(sum), _mm256_extractf128_pd(sum, 1));
+		auto total = _mm_cvtsd_f64(_mm_add_sd(halves, _mm_unpackhi_pd(halves, halves)));
+#elif defined(__SSE2__)
+		// no gather before AVX2, but two lanes still halve the multiplies and adds
+		auto sum = _mm_setzero_pd();
+		for (; i + 2 <= count; i += 2) {
+			auto const gathered = _mm_set_pd(values[index[i + 1]], values[index[i]]);
+			sum = _mm_add_pd(sum, _mm_mul_pd(gathered, _mm_loadu_pd(coef + i)));
+		}
+		auto total = _mm_cvtsd_f64(_mm_add_sd(sum, _mm_unpackhi_pd(sum, sum)));
+#else
+		auto total = 0.0;
+#endif
+		for (; i < count; ++i) {
+			total += coef[i] * values[index[i]];
+		}
+		return total;
+	}
+
+	// Elements common to two ascending lists of distinct ids, written to out when it isn't null,
+	// and their count. With SSE2 four ids of each list are compared all against all in four
+	// compares, rotating one side, and whichever block ends lower moves on
+	inline auto intersect(std::span<std::uint32_t const> a,
+	                      std::span<std::uint32_t const> b,
+	                      std::uint32_t* out = nullptr) noexcept -> std::size_t {
+		auto i = std::size_t{0};
+		auto j = std::size_t{0};
+		auto found = std::size_t{0};
+#if defined(__SSE2__)
+		while (i + 4 <= a.size() && j + 4 <= b.size()) {
+			auto const va = _mm_loadu_si128(reinterpret_cast<__m128i const*>(a.data() + i));
+			auto const vb = _mm_loadu_si128(reinterpret_cast<__m128i const*>(b.data() + j));
+			auto const any = _mm_or_si128(
+			   _mm_or_si128(_mm_cmpeq_epi32(va, vb),
+			                _mm_cmpeq_epi32(va, _mm_shuffle_epi32(vb, _MM_SHUFFLE(0, 3, 2, 1)))),
+			   _mm_or_si128(_mm_cmpeq_epi32(va, _mm_shuffle_epi32(vb, _MM_SHUFFLE(1, 0, 3, 2))),
+			                _mm_cmpeq_epi32(va, _mm_shuffle_epi32(vb, _MM_SHUFFLE(2, 1, 0, 3)))));
+			auto mask = static_cast<unsigned>(_mm_movemask_ps(_mm_castsi128_ps(any)));
+			if (out != nullptr) {
+				for (; mask != 0; mask &= mask - 1) {
+					out[found++] = a[i + static_cast<std::size_t>(std::countr_zero(mask))];
+				}
+			}
+			else {
+				found += static_cast<std::size_t>(std::popcount(mask));
+			}
+			auto const a_last = a[i + 3];
+			auto const b_last = b[j + 3];
+			i += a_last <= b_last ? 4 : 0;
+			j += b_last <= a_last ? 4 : 0;
+		}
+#endif
+		while (i < a.size() && j < b.size()) {
+			if (a[i] < b[j]) {
+				++i;
+			}
+			else if (b[j] < a[i]) {
+				++j;
+			}
+			else {
+				if (out != nullptr) {
+					out[found] = a[i];
+				}
+				++found;
+				++i;
+				++j;
+			}
+		}
+		return found;
+	}
+} // namespace gdwg::detail
+
+#endif // GDWG_DETAIL_SIMD_HPP
@@ -0,0 +1,275 @@
+#ifndef GDWG_DETAIL_SOCKET_HPP
+#define GDWG_DETAIL_SOCKET_HPP
+
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+// Length prefixed frames over Unix domain stream sockets, for talking to worker processes.
+
+namespace gdwg::detail {
+	// owns one end of a socket and closes it on destruction
+	class socket_fd {
+	public:
+		socket_fd() = default;
+
+		explicit socket_fd(int fd) noexcept
+		: fd_(fd) {}
+
+		socket_fd(socket_fd&& other) noexcept
+		: fd_(std::exchange(other.fd_, -1)) {}
+
+		auto operator=(socket_fd&& other) noexcept -> socket_fd& {
+			if (this != &other) {
+				close();
+				fd_ = std::exchange(other.fd_, -1);
+			}
+			return *this;
+		}
+
+		socket_fd(socket_fd const&) = delete;
+		auto operator=(socket_fd const&) -> socket_fd& = delete;
+
+		~socket_fd() {
+			close();
+		}
+
+		[[nodiscard]] auto get() const noexcept -> int {
+			return fd_;
+		}
+
+		auto close() noexcept -> void {
+			if (fd_ >= 0) {
+				::close(fd_);
+				fd_ = -1;
+			}
+		}
+
+	private:
+		int fd_ = -1;
+	};
+
+	// both ends of a connected pair
+	inline auto make_socket_pair() -> std::pair<socket_fd, socket_fd> {
+		int fds[2];
+		if (::socketpair(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, fds) != 0) {
+			throw std::runtime_error(std::string("Cannot create a socket pair: ")
+			                         + std::strerror(errno));
+		}
+		return {socket_fd(fds[0]), socket_fd(fds[1])};
+	}
+
+	inline auto socket_error(char const* what) -> std::runtime_error {
+		return std::runtime_error(std::string("Cannot ") + what + " a worker socket: "
+		                          + (errno == 0 ? "connection closed" : std::strerror(errno)));
+	}
+
+	// MSG_NOSIGNAL, so a worker that has gone away is an error rather than SIGPIPE
+	inline auto write_all(int fd, void const* data, std::size_t size) -> void {
+		auto const* bytes = static_cast<std::uint8_t const*>(data);
+		while (size != 0) {
+			auto const written = ::send(fd, bytes, size, MSG_NOSIGNAL);
+			if (written < 0 && errno == EINTR) {
+				continue;
+			}
+			if (written <= 0) {
+				throw socket_error("write to");
+			}
+			bytes += written;
+			size -= static_cast<std::size_t>(written);
+		}
+	}
+
+	inline auto read_all(int fd, void* data, std::size_t size) -> void {
+		auto* bytes = static_cast<std::uint8_t*>(data);
+		while (size != 0) {
+			errno = 0;
+			auto const got = ::recv(fd, bytes, size, 0);
+			if (got < 0 && errno == EINTR) {
+				continue;
+			}
+			if (got <= 0) {
+				throw socket_error("read from");
+			}
+			bytes += got;
+			size -= static_cast<std::size_t>(got);
+		}
+	}
+
+	// a frame's payload, built with put() and taken apart with get() in the same order
+	class frame {
+	public:
+		frame() = default;
+
+		explicit frame(std::vector<std::uint8_t> bytes) noexcept
+		: bytes_(std::move(bytes)) {}
+
+		template<typename T>
+		auto put(T const& value) -> frame& {
+			static_assert(std::is_trivially_copyable_v<T>);
+			auto const at = bytes_.size();
+			bytes_.resize(at + sizeof(T));
+			std::memcpy(bytes_.data() + at, &value, sizeof(T));
+			return *this;
+		}
+
+		template<typename T>
+		auto put_all(std::vector<T> const& values) -> frame& {
+			static_assert(std::is_trivially_copyable_v<T>);
+			put(static_cast<std::uint64_t>(values.size()));
+			auto const at = bytes_.size();
+			bytes_.resize(at + values.size() * sizeof(T));
+			if (!values.empty()) {
+				std::memcpy(bytes_.data() + at, values.data(), values.size() * sizeof(T));
+			}
+			return *this;
+		}
+
+		template<typename T>
+		auto get() -> T {
+			static_assert(std::is_trivially_copyable_v<T>);
+			check(sizeof(T));
+			auto value = T();
+			std::memcpy(&value, bytes_.data() + read_, sizeof(T));
+			read_ += sizeof(T);
+			return value;
+		}
+
+		template<typename T>
+		auto get_all() -> std::vector<T> {
+			auto const count = static_cast<std::size_t>(get<std::uint64_t>());
+			check(count * sizeof(T));
+			auto values = std::vector<T>(count);
+			if (count != 0) {
+				std::memcpy(values.data(), bytes_.data() + read_, count * sizeof(T));
+			}
+			read_ += count * sizeof(T);
+			return values;
+		}
+
+		[[nodiscard]] auto bytes() const noexcept -> std::vector<std::uint8_t> const& {
+			return bytes_;
+		}
+
+	private:
+		std::vector<std::uint8_t> bytes_;
+		std::size_t read_ = 0;
+
+		auto check(std::size_t size) const -> void {
+			if (bytes_.size() - read_ < size) {
+				throw std::runtime_error("Cannot read past the end of a worker message");
+			}
+		}
+	};
+
+	inline auto send_frame(int fd, frame const& message) -> void {
+		auto const size = static_cast<std::uint64_t>(message.bytes().size());
+		write_all(fd, &size, sizeof(size));
+		write_all(fd, message.bytes().data(), message.bytes().size());
+	}
+
+	inline auto receive_frame(int fd) -> frame {
+		auto size = std::uint64_t{0};
+		read_all(fd, &size, sizeof(size));
+		auto bytes = std::vector<std::uint8_t>(static_cast<std::size_t>(size));
+		read_all(fd, bytes.data(), bytes.size());
+		return frame(std::move(bytes));
+	}
+
+	// Sends outgoing[i] to peers[i] and receives one frame from each peer at the same time.
+	// Writing everything first could deadlock once two peers both fill their socket buffers, so
+	// this polls and moves whichever direction is ready
+	inline auto exchange_frames(std::vector<int> const& peers, std::vector<frame> const& outgoing)
+	   -> std::vector<frame> {
+		struct progress {
+			std::vector<std::uint8_t> out;
+			std::size_t written = 0;
+			std::vector<std::uint8_t> in;
+			std::size_t read = 0;
+			// the incoming length prefix, then its payload
+			std::uint64_t expected = 0;
+			bool have_size = false;
+		};
+		auto state = std::vector<progress>(peers.size());
+		for (auto i = std::size_t{0}; i < peers.size(); ++i) {
+			auto const& payload = outgoing[i].bytes();
+			auto const size = static_cast<std::uint64_t>(payload.size());
+			auto& out = state[i].out;
+			out.resize(sizeof(size));
+			std::memcpy(out.data(), &size, sizeof(size));
+			out.insert(out.end(), payload.begin(), payload.end());
+			state[i].in.resize(sizeof(std::uint64_t));
+		}
+
+		auto polled = std::vector<pollfd>(peers.size());
+		for (;;) {
+			auto waiting = false;
+			for (auto i = std::size_t{0}; i < peers.size(); ++i) {
+				auto const& s = state[i];
+				auto const reading = !s.have_size || s.read < s.in.size();
+				auto const writing = s.written < s.out.size();
+				polled[i] = pollfd{peers[i],
+				                   static_cast<short>((reading ? POLLIN : 0) | (writing ? POLLOUT : 0)),
+				                   0};
+				waiting = waiting || reading || writing;
+			}
+			if (!waiting) {
+				break;
+			}
+			if (::poll(polled.data(), polled.size(), -1) < 0) {
+				if (errno == EINTR) {
+					continue;
+				}
+				throw socket_error("poll");
+			}
+
+			for (auto i = std::size_t{0}; i < peers.size(); ++i) {
+				auto& s = state[i];
+				auto const events = polled[i].events;
+				if ((polled[i].revents & POLLOUT) != 0 && (events & POLLOUT) != 0) {
+					auto const* from = s.out.data() + s.written;
+					auto const written =
+					   ::send(peers[i], from, s.out.size() - s.written, MSG_NOSIGNAL | MSG_DONTWAIT);
+					if (written < 0 && errno != EINTR && errno != EAGAIN) {
+						throw socket_error("write to");
+					}
+					s.written += written > 0 ? static_cast<std::size_t>(written) : 0;
+				}
+				if ((polled[i].revents & (POLLIN | POLLHUP | POLLERR)) != 0 && (events & POLLIN) != 0) {
+					errno = 0;
+					auto* into = s.in.data() + s.read;
+					auto const got = ::recv(peers[i], into, s.in.size() - s.read, MSG_DONTWAIT);
+					if (got == 0 || (got < 0 && errno != EINTR && errno != EAGAIN)) {
+						throw socket_error("read from");
+					}
+					s.read += got > 0 ? static_cast<std::size_t>(got) : 0;
+					if (!s.have_size && s.read == s.in.size()) {
+						std::memcpy(&s.expected, s.in.data(), sizeof(s.expected));
+						s.have_size = true;
+						s.in.assign(static_cast<std::size_t>(s.expected), 0);
+						s.read = 0;
+					}
+				}
+			}
+		}
+
+		auto incoming = std::vector<frame>();
+		incoming.reserve(peers.size());
+		for (auto& s : state) {
+			incoming.emplace_back(std::move(s.in));
+		}
+		return incoming;
+	}
+} // namespace gdwg::detail
+
+#endif // GDWG_DETAIL_SOCKET_HPP
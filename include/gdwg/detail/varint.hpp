@@ -0,0 +1,79 @@
+#ifndef GDWG_DETAIL_VARINT_HPP
+#define GDWG_DETAIL_VARINT_HPP
+
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include <vector>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+// LEB128 variable length integers: seven bits per byte, low bits first, the top bit set on every
+// byte but the last. Small numbers, such as the gaps between sorted neighbour ids, take one byte.
+
+namespace gdwg::detail {
+	// bytes the readers below may look at past the last value, buffers keep this much padding
+	inline constexpr std::size_t varint_padding = 16;
+
+	inline auto put_varint(std::vector<std::uint8_t>& out, std::uint64_t value) -> void {
+		while (value >= 0x80U) {
+			out.push_back(static_cast<std::uint8_t>(value | 0x80U));
+			value >>= 7U;
+		}
+		out.push_back(static_cast<std::uint8_t>(value));
+	}
+
+	inline auto get_varint(std::uint8_t const*& in) noexcept -> std::uint64_t {
+		auto value = std::uint64_t{0};
+		auto shift = 0U;
+		while ((*in & 0x80U) != 0) {
+			value |= std::uint64_t{*in++ & 0x7fU} << shift;
+			shift += 7;
+		}
+		return value | (std::uint64_t{*in++} << shift);
+	}
+
+	// maps small negative and positive numbers to small unsigned ones
+	inline auto zigzag(std::int64_t value) noexcept -> std::uint64_t {
+		return (static_cast<std::uint64_t>(value) << 1U) ^ static_cast<std::uint64_t>(value >> 63);
+	}
+
+	inline auto unzigzag(std::uint64_t value) noexcept -> std::int64_t {
+		return static_cast<std::int64_t>(value >> 1U) ^ -static_cast<std::int64_t>(value & 1U);
+	}
+
+	// decodes count values into out and returns where the next value starts. With SSE2, one
+	// movemask over the next sixteen bytes finds how many of them are whole one byte values, and
+	// those are copied without testing each byte, the common case for gap encoded neighbour lists
+	template<typename T>
+	auto get_varints(std::uint8_t const* in, std::size_t count, T* out) noexcept
+	   -> std::uint8_t const* {
+		static_assert(std::is_unsigned_v<T>);
+		auto i = std::size_t{0};
+#if defined(__SSE2__)
+		while (count - i >= 16) {
+			auto const chunk = _mm_loadu_si128(reinterpret_cast<__m128i const*>(in));
+			auto const continued = static_cast<unsigned>(_mm_movemask_epi8(chunk));
+			// one byte values before the first that continues into the next byte
+			auto const run = continued == 0 ? 16 : std::countr_zero(continued);
+			for (auto j = 0; j < run; ++j) {
+				out[i + j] = in[j];
+			}
+			in += run;
+			i += run;
+			if (continued != 0) {
+				out[i++] = static_cast<T>(get_varint(in));
+			}
+		}
+#endif
+		for (; i < count; ++i) {
+			out[i] = static_cast<T>(get_varint(in));
+		}
+		return in;
+	}
+} // namespace gdwg::detail
+
+#endif // GDWG_DETAIL_VARINT_HPP
@@ -0,0 +1,327 @@
+#ifndef GDWG_FROZEN_GRAPH_HPP
+#define GDWG_FROZEN_GRAPH_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <numeric>
+#include <optional>
+#include <span>
+#include <stdexcept>
+#include <vector>
+
+#include "gdwg/detail/node_order.hpp"
+#include "gdwg/graph.hpp"
+#include "gdwg/trace.hpp"
+
+// A contiguous, read only snapshot of a gdwg::graph in compressed sparse row form. Nodes are
+// numbered 0..num_nodes()-1, in ascending order unless a node_order says otherwise, and every
+// edge (one per weight) is stored twice, once in its source's outgoing row and once in its
+// destination's incoming row. Rows are sorted by neighbour id, then weight. The bulk algorithms
+// run on this rather than on the map of maps.
+
+namespace gdwg {
+	// how frozen_graph numbers its nodes. Anything but sorted trades a slower find() for
+	// neighbours that sit closer together in memory
+	enum class node_order {
+		// ascending N, the same order as graph::nodes()
+		sorted,
+		// highest degree first
+		degree,
+		// reverse Cuthill-McKee, keeps every edge's endpoints close
+		reverse_cuthill_mckee,
+		// breadth first
+		bfs,
+		// Rabbit order, each community numbered contiguously
+		community,
+	};
+
+	template<typename N, typename E>
+	class frozen_graph {
+	public:
+		using node_id = std::uint32_t;
+
+		frozen_graph() = default;
+
+		explicit frozen_graph(graph<N, E> const& g, node_order order = node_order::sorted)
+		: order_(order) {
+			[[maybe_unused]] auto const span = trace::span("gdwg::frozen_graph::build");
+			auto const& nodes = detail::graph_access::nodes(g);
+			auto const& edges = detail::graph_access::edges(g);
+			if (nodes.size() >= std::numeric_limits<node_id>::max()) {
+				throw std::length_error("Cannot build gdwg::frozen_graph<N, E> with more than 2^32 - 1 "
+				                        "nodes");
+			}
+
+			nodes_.reserve(nodes.size());
+			for (auto const& node : nodes) {
+				nodes_.push_back(*node.first);
+			}
+
+			out_offsets_.reserve(nodes_.size() + 1);
+			out_targets_.reserve(g.num_edges());
+			out_weights_.reserve(g.num_edges());
+			out_offsets_.push_back(0);
+
+			// nodes_ and edges_ share an order, so sources are met in id order
+			auto outer_key = edges.begin();
+			for (auto const& node : nodes_) {
+				if (outer_key != edges.end() && !(node < *outer_key->first)) {
+					for (auto const& [dst, weights] : outer_key->second) {
+						auto const target = *find(*dst);
+						for (auto const& weight : weights) {
+							out_targets_.push_back(target);
+							out_weights_.push_back(*weight);
+						}
+					}
+					++outer_key;
+				}
+				out_offsets_.push_back(out_targets_.size());
+			}
+			build_incoming();
+			if (order != node_order::sorted) {
+				renumber(order);
+			}
+		}
+
+		[[nodiscard]] auto num_nodes() const noexcept -> std::size_t {
+			return nodes_.size();
+		}
+
+		// one per weight
+		[[nodiscard]] auto num_edges() const noexcept -> std::size_t {
+			return out_targets_.size();
+		}
+
+		[[nodiscard]] auto empty() const noexcept -> bool {
+			return nodes_.empty();
+		}
+
+		[[nodiscard]] auto node(node_id id) const -> N const& {
+			return nodes_[id];
+		}
+
+		[[nodiscard]] auto find(N const& value) const -> std::optional<node_id> {
+			if (by_value_.empty()) {
+				auto found = std::lower_bound(nodes_.begin(), nodes_.end(), value);
+				if (found == nodes_.end() || value < *found) {
+					return std::nullopt;
+				}
+				return static_cast<node_id>(found - nodes_.begin());
+			}
+
+			auto found = std::lower_bound(by_value_.begin(),
+			                              by_value_.end(),
+			                              value,
+			                              [&](node_id id, N const& v) { return nodes_[id] < v; });
+			if (found == by_value_.end() || value < nodes_[*found]) {
+				return std::nullopt;
+			}
+			return *found;
+		}
+
+		[[nodiscard]] auto is_node(N const& value) const -> bool {
+			return find(value).has_value();
+		}
+
+		[[nodiscard]] auto id(N const& value) const -> node_id {
+			if (auto found = find(value)) {
+				return *found;
+			}
+			throw std::runtime_error("Cannot call gdwg::frozen_graph<N, E>::id if the node doesn't "
+			                         "exist in the graph");
+		}
+
+		// every node in id order
+		[[nodiscard]] auto nodes() const noexcept -> std::vector<N> const& {
+			return nodes_;
+		}
+
+		[[nodiscard]] auto order() const noexcept -> node_order {
+			return order_;
+		}
+
+		[[nodiscard]] auto out_neighbors(node_id src) const noexcept -> std::span<node_id const> {
+			return row(out_offsets_, out_targets_, src);
+		}
+
+		[[nodiscard]] auto out_weights(node_id src) const noexcept -> std::span<E const> {
+			return row(out_offsets_, out_weights_, src);
+		}
+
+		[[nodiscard]] auto in_neighbors(node_id dst) const noexcept -> std::span<node_id const> {
+			return row(in_offsets_, in_sources_, dst);
+		}
+
+		[[nodiscard]] auto in_weights(node_id dst) const noexcept -> std::span<E const> {
+			return row(in_offsets_, in_weights_, dst);
+		}
+
+		[[nodiscard]] auto out_degree(node_id src) const noexcept -> std::size_t {
+			return out_offsets_[src + 1] - out_offsets_[src];
+		}
+
+		[[nodiscard]] auto in_degree(node_id dst) const noexcept -> std::size_t {
+			return in_offsets_[dst + 1] - in_offsets_[dst];
+		}
+
+		// the offsets and targets of every outgoing row, for algorithms that walk the whole graph
+		[[nodiscard]] auto out_offsets() const noexcept -> std::span<std::size_t const> {
+			return out_offsets_;
+		}
+
+		[[nodiscard]] auto out_targets() const noexcept -> std::span<node_id const> {
+			return out_targets_;
+		}
+
+		[[nodiscard]] auto in_offsets() const noexcept -> std::span<std::size_t const> {
+			return in_offsets_;
+		}
+
+		[[nodiscard]] auto in_sources() const noexcept -> std::span<node_id const> {
+			return in_sources_;
+		}
+
+		// same contract as graph::connections
+		[[nodiscard]] auto connections(N const& src) const -> std::vector<N> {
+			auto const from = find(src);
+			if (!from) {
+				throw std::runtime_error("Cannot call gdwg::frozen_graph<N, E>::connections if src "
+				                         "doesn't exist in the graph");
+			}
+			auto res_vector = std::vector<N>();
+			auto const targets = out_neighbors(*from);
+			for (auto i = std::size_t{0}; i < targets.size(); ++i) {
+				if (i == 0 || targets[i] != targets[i - 1]) {
+					res_vector.push_back(nodes_[targets[i]]);
+				}
+			}
+			// rows follow ids, which only follow N when sorted
+			if (!by_value_.empty()) {
+				std::sort(res_vector.begin(), res_vector.end());
+			}
+			return res_vector;
+		}
+
+		// same contract as graph::weights
+		[[nodiscard]] auto weights(N const& src, N const& dst) const -> std::vector<E> {
+			auto const from = find(src);
+			auto const to = find(dst);
+			if (!from || !to) {
+				throw std::runtime_error("Cannot call gdwg::frozen_graph<N, E>::weights if src or dst "
+				                         "node don't exist in the graph");
+			}
+			auto const targets = out_neighbors(*from);
+			auto const weights = out_weights(*from);
+			auto const [first, last] = std::equal_range(targets.begin(), targets.end(), *to);
+			return std::vector<E>(weights.begin() + (first - targets.begin()),
+			                      weights.begin() + (last - targets.begin()));
+		}
+
+	private:
+		template<typename T>
+		static auto row(std::vector<std::size_t> const& offsets,
+		                std::vector<T> const& values,
+		                node_id at) noexcept -> std::span<T const> {
+			return std::span<T const>(values.data() + offsets[at], offsets[at + 1] - offsets[at]);
+		}
+
+		// relabels every node and rebuilds both sets of rows under the new ids
+		auto renumber(node_order order) -> void {
+			[[maybe_unused]] auto const span = trace::span("gdwg::frozen_graph::renumber");
+			auto const rows = detail::csr_rows{out_offsets_, out_targets_, in_offsets_, in_sources_};
+			auto const old_ids = [&] {
+				switch (order) {
+				case node_order::degree: return detail::degree_order(rows);
+				case node_order::reverse_cuthill_mckee:
+					return detail::reverse_cuthill_mckee_order(rows);
+				case node_order::bfs: return detail::bfs_order(rows);
+				case node_order::community: return detail::community_order(rows);
+				case node_order::sorted: break;
+				}
+				auto identity = std::vector<node_id>(nodes_.size());
+				std::iota(identity.begin(), identity.end(), node_id{0});
+				return identity;
+			}();
+
+			// old ids are in ascending N order, so this is also every new id sorted by value
+			by_value_.assign(nodes_.size(), 0);
+			for (auto id = node_id{0}; id < old_ids.size(); ++id) {
+				by_value_[old_ids[id]] = id;
+			}
+
+			auto nodes = std::vector<N>();
+			nodes.reserve(nodes_.size());
+			auto offsets = std::vector<std::size_t>{0};
+			offsets.reserve(nodes_.size() + 1);
+			auto targets = std::vector<node_id>();
+			targets.reserve(out_targets_.size());
+			auto weights = std::vector<E>();
+			weights.reserve(out_weights_.size());
+			auto edges = std::vector<std::size_t>();
+			for (auto old : old_ids) {
+				nodes.push_back(std::move(nodes_[old]));
+				edges.resize(out_offsets_[old + 1] - out_offsets_[old]);
+				std::iota(edges.begin(), edges.end(), out_offsets_[old]);
+				std::sort(edges.begin(), edges.end(), [&](std::size_t left, std::size_t right) {
+					auto const l = by_value_[out_targets_[left]];
+					auto const r = by_value_[out_targets_[right]];
+					return l < r || (l == r && out_weights_[left] < out_weights_[right]);
+				});
+				for (auto e : edges) {
+					targets.push_back(by_value_[out_targets_[e]]);
+					weights.push_back(out_weights_[e]);
+				}
+				offsets.push_back(targets.size());
+			}
+
+			nodes_ = std::move(nodes);
+			out_offsets_ = std::move(offsets);
+			out_targets_ = std::move(targets);
+			out_weights_ = std::move(weights);
+			in_weights_.clear();
+			build_incoming();
+		}
+
+		// counting sort of the outgoing rows by target. Sources are visited in id order, so each
+		// incoming row comes out sorted by source
+		auto build_incoming() -> void {
+			in_offsets_.assign(nodes_.size() + 1, 0);
+			for (auto target : out_targets_) {
+				++in_offsets_[target + 1];
+			}
+			for (auto i = std::size_t{1}; i < in_offsets_.size(); ++i) {
+				in_offsets_[i] += in_offsets_[i - 1];
+			}
+
+			auto cursor = std::vector<std::size_t>(in_offsets_.begin(), in_offsets_.end() - 1);
+			in_sources_.resize(out_targets_.size());
+			in_weights_.reserve(out_targets_.size());
+			auto order = std::vector<std::size_t>(out_targets_.size());
+			for (auto src = node_id{0}; src < nodes_.size(); ++src) {
+				for (auto e = out_offsets_[src]; e < out_offsets_[src + 1]; ++e) {
+					auto const slot = cursor[out_targets_[e]]++;
+					in_sources_[slot] = src;
+					order[slot] = e;
+				}
+			}
+			for (auto e : order) {
+				in_weights_.push_back(out_weights_[e]);
+			}
+		}
+
+		node_order order_ = node_order::sorted;
+		std::vector<N> nodes_;
+		// ids in ascending N order, empty when that is every id in order
+		std::vector<node_id> by_value_;
+		std::vector<std::size_t> out_offsets_;
+		std::vector<node_id> out_targets_;
+		std::vector<E> out_weights_;
+		std::vector<std::size_t> in_offsets_;
+		std::vector<node_id> in_sources_;
+		std::vector<E> in_weights_;
+	};
+} // namespace gdwg
+
+#endif // GDWG_FROZEN_GRAPH_HPP
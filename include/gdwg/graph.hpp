@@ -5,13 +5,21 @@
 
 #include <algorithm>
 #include <cassert>
+#include <cstdint>
+#include <functional>
 #include <iostream>
 #include <iterator>
 #include <map>
 #include <memory>
 #include <set>
+#include <stdexcept>
+#include <string>
 #include <tuple>
 #include <utility>
+#include <vector>
+
+#include "gdwg/instrumentation.hpp"
+#include "gdwg/trace.hpp"
 
 // reference:
 /* I played around here to get an optimal ds: https://techiedelight.com/compiler/
@@ -22,6 +30,10 @@ alt. ds: std::map<std::pair<std::shared_ptr<N>, std::shared_ptr<N>>, std::set<st
 links_; alt. ds: multimap?? */
 
 namespace gdwg {
+	namespace detail {
+		struct graph_access;
+	} // namespace detail
+
 	template<typename N, typename E>
 	class graph {
 	public:
@@ -31,20 +43,55 @@ namespace gdwg {
 			E weight;
 		};
 
+		// one step of a batch passed to apply()
+		struct edge_operation {
+			enum class kind { insert, erase };
+			kind op;
+			N src;
+			N dst;
+			E weight;
+		};
+
+		using batch = std::vector<edge_operation>;
+
 		class iterator;
 
+		// compiled out unless GDWG_INSTRUMENTATION is set, see gdwg/instrumentation.hpp
+		using probe = instrumentation::policy;
+
+		// per node edge counts, kept alongside each node so degree() never walks edges_
+		struct degree_counts {
+			std::size_t out = 0;
+			std::size_t in = 0;
+		};
+
+		// approximate bytes held by a graph, see memory_usage()
+		struct memory_report {
+			std::size_t nodes = 0;
+			std::size_t adjacency_maps = 0;
+			std::size_t weight_sets = 0;
+			std::size_t control_blocks = 0;
+
+			[[nodiscard]] auto total() const noexcept -> std::size_t {
+				return nodes + adjacency_maps + weight_sets + control_blocks;
+			}
+		};
+
 		struct comparator {
 			using is_transparent = void;
 			auto operator()(const std::shared_ptr<N>& left_node,
 			                const std::shared_ptr<N>& right_node) const -> bool {
+				probe::count_comparison();
 				return *left_node < *right_node;
 			}
 
 			// transparent comparisons
 			auto operator()(const std::shared_ptr<N>& left_node, const N& right_val) const -> bool {
+				probe::count_comparison();
 				return *left_node < right_val;
 			}
 			auto operator()(const N& left_val, const std::shared_ptr<N>& right_node) const -> bool {
+				probe::count_comparison();
 				return left_val < *right_node;
 			}
 		};
@@ -53,24 +100,71 @@ namespace gdwg {
 			using is_transparent = void;
 			auto operator()(const std::shared_ptr<E>& left_node,
 			                const std::shared_ptr<E>& right_node) const -> bool {
+				probe::count_comparison();
 				return *left_node < *right_node;
 			}
 
 			// transparent comparisons
 			auto operator()(const std::shared_ptr<E>& left_node, const E& right_val) const -> bool {
+				probe::count_comparison();
 				return *left_node < right_val;
 			}
 			auto operator()(const E& left_val, const std::shared_ptr<E>& right_node) const -> bool {
+				probe::count_comparison();
 				return left_val < *right_node;
 			}
 		};
 
+		// receives every change made to a graph it is subscribed to, after the change is made.
+		// Erasing a node reports each of its edges before the node itself. Hooks run inside noexcept
+		// modifiers, so they must not throw. An observer destroyed before its graphs unsubscribes
+		// from them
+		class observer {
+		public:
+			virtual ~observer() {
+				for (auto* g : graphs_) {
+					std::erase(g->observers_, this);
+				}
+			}
+
+			virtual auto node_inserted(N const& /*value*/) -> void {}
+			virtual auto node_erased(N const& /*value*/) -> void {}
+			virtual auto node_replaced(N const& /*old_data*/, N const& /*new_data*/) -> void {}
+			virtual auto edge_inserted(N const& /*src*/, N const& /*dst*/, E const& /*weight*/)
+			   -> void {}
+			virtual auto edge_erased(N const& /*src*/, N const& /*dst*/, E const& /*weight*/)
+			   -> void {}
+			// the whole graph was cleared, assigned to or moved from
+			virtual auto reloaded() -> void {}
+			// the graph is being destroyed and won't report anything more
+			virtual auto detached() -> void {}
+
+		protected:
+			observer() = default;
+			// subscriptions stay with the original
+			observer(observer const&) noexcept {}
+			auto operator=(observer const&) noexcept -> observer& {
+				return *this;
+			}
+
+		private:
+			friend class graph;
+			// graphs this is subscribed to
+			std::vector<graph*> graphs_;
+		};
+
 		// ----------   constructors -----------
 		graph() = default;
 
-		~graph() = default;
+		~graph() {
+			for (auto* o : observers_) {
+				std::erase(o->graphs_, this);
+				o->detached();
+			}
+		}
 
 		graph(std::initializer_list<N> il) {
+			[[maybe_unused]] auto const span = trace::span("gdwg::graph::bulk_load");
 			nodes_ = decltype(nodes_)();
 			edges_ = decltype(edges_)();
 
@@ -80,6 +174,7 @@ namespace gdwg {
 		}
 		template<typename InputIt>
 		graph(InputIt first, InputIt last) {
+			[[maybe_unused]] auto const span = trace::span("gdwg::graph::bulk_load");
 			for (auto iter = first; iter != last; ++iter) {
 				insert_node(*iter);
 			}
@@ -89,19 +184,29 @@ namespace gdwg {
 		graph(graph&& other) noexcept {
 			nodes_ = std::move(other.nodes_);
 			edges_ = std::move(other.edges_);
+			node_count_ = std::exchange(other.node_count_, 0);
+			edge_count_ = std::exchange(other.edge_count_, 0);
+			hash_ = std::exchange(other.hash_, 0);
+			version_ = other.version_;
+			other.notify_reloaded();
 		}
 
 		// move-assigned and destroyed
 		auto operator=(graph&& other) noexcept -> graph& {
 			std::swap(nodes_, other.nodes_);
 			std::swap(edges_, other.edges_);
+			std::swap(node_count_, other.node_count_);
+			std::swap(edge_count_, other.edge_count_);
+			std::swap(hash_, other.hash_);
 			//
 			other.clear();
+			notify_reloaded();
 			return *this;
 		}
 
 		// copy constructor
 		graph(graph const& other) {
+			[[maybe_unused]] auto const span = trace::span("gdwg::graph::copy");
 			// clear the data up
 			nodes_ = decltype(nodes_)();
 			edges_ = decltype(edges_)();
@@ -112,16 +217,24 @@ namespace gdwg {
 
 			for (auto const& src_nodes : other.edges_) {
 				for (auto const& dst_node : src_nodes.second) {
-					auto new_src = std::make_shared<N>(*src_nodes.first);
-					auto new_dest = std::make_shared<N>(*dst_node.first);
+					auto new_src = make_node(*src_nodes.first);
+					auto new_dest = make_node(*dst_node.first);
 
 					// loop through set of weights
 					for (auto const& weight : dst_node.second) {
-						auto new_weight = std::make_shared<E>(*weight);
+						auto new_weight = make_weight(*weight);
 						edges_[new_src][new_dest].insert(new_weight);
 					}
 				}
 			}
+
+			// nodes were counted by insert_node, edges were copied as-is
+			auto other_node = other.nodes_.begin();
+			for (auto& node : nodes_) {
+				node.second = (other_node++)->second;
+			}
+			edge_count_ = other.edge_count_;
+			hash_ = other.hash_;
 		}
 
 		// copy assignment
@@ -132,6 +245,10 @@ namespace gdwg {
 			auto temp_graph = other;
 			std::swap(nodes_, temp_graph.nodes_);
 			std::swap(edges_, temp_graph.edges_);
+			std::swap(node_count_, temp_graph.node_count_);
+			std::swap(edge_count_, temp_graph.edge_count_);
+			std::swap(hash_, temp_graph.hash_);
+			notify_reloaded();
 
 			return *this;
 		}
@@ -140,10 +257,12 @@ namespace gdwg {
 
 		// add node if one doesnt exist in graph
 		auto insert_node(N const& value) noexcept -> bool {
+			[[maybe_unused]] auto const scope = probe::scope(instrumentation::operation::insert_node);
 			if (!is_node(value)) {
-				auto node = std::make_shared<N>(value);
+				auto node = make_node(value);
 				// add to nodes set
-				nodes_.insert(std::move(node));
+				nodes_.emplace(std::move(node), degree_counts{});
+				on_node_inserted(value);
 				return true;
 			}
 			return false;
@@ -151,16 +270,18 @@ namespace gdwg {
 
 		// creates edge if it doesnt exist already
 		auto insert_edge(N const& src, N const& dst, E const& weight) -> bool {
+			[[maybe_unused]] auto const scope = probe::scope(instrumentation::operation::insert_edge);
 			if (!is_node(src) || !is_node(dst)) {
 				throw std::runtime_error("Cannot call gdwg::graph<N, E>::insert_edge when either src "
 				                         "or dst node does not exist");
 			}
 
 			if (!edge_exists(src, dst, weight)) {
-				auto new_src = std::make_shared<N>(src);
-				auto new_dest = std::make_shared<N>(dst);
-				auto new_weight = std::make_shared<E>(weight);
+				auto new_src = make_node(src);
+				auto new_dest = make_node(dst);
+				auto new_weight = make_weight(weight);
 				edges_[new_src][new_dest].insert(new_weight);
+				on_edge_inserted(src, dst, weight);
 				return true;
 			}
 
@@ -169,6 +290,8 @@ namespace gdwg {
 
 		// replaces node with a node that doesn't exist yet in same spot
 		auto replace_node(N const& old_data, N const& new_data) -> bool {
+			[[maybe_unused]] auto const scope = probe::scope(instrumentation::operation::replace_node);
+			[[maybe_unused]] auto const span = trace::span("gdwg::graph::replace_node");
 			if (is_node(new_data)) {
 				return false;
 			}
@@ -177,33 +300,55 @@ namespace gdwg {
 				                         "doesn't exist");
 			}
 
-			auto old_d = std::make_shared<N>(old_data);
-			auto new_d = std::make_shared<N>(new_data);
+			auto old_d = make_node(old_data);
+			auto new_d = make_node(new_data);
 			auto set_handle = nodes_.extract(old_d);
-			set_handle.value() = new_d;
+			set_handle.key() = new_d;
 			nodes_.insert(move(set_handle));
 
-			for (auto outer_key : edges_) {
+			// every edge touching old_data hashes differently once renamed
+			auto renamed = [&](N const& node) -> N const& {
+				return node == old_data ? new_data : node;
+			};
+			hash_ -= node_hash(old_data);
+			hash_ += node_hash(new_data);
+
+			for (auto& outer_key : edges_) {
 				// replace inner key
-				for (auto& inner_key : outer_key.second) {
-					if (*inner_key.first == old_data) {
-						auto inner_handle = outer_key.second.extract(old_d);
-						inner_handle.key() = new_d;
-						outer_key.second.insert(move(inner_handle));
-					}
+				auto inner_key = outer_key.second.find(old_data);
+				if (inner_key == outer_key.second.end()) {
+					continue;
 				}
-
-				// replace outer key
-				if (*outer_key.first == old_data) {
-					auto outer_handle = edges_.extract(old_d);
-					outer_handle.key() = new_d;
-					edges_.insert(std::move(outer_handle));
+				for (auto const& weight : inner_key->second) {
+					hash_ -= edge_hash(*outer_key.first, old_data, *weight);
+					hash_ += edge_hash(renamed(*outer_key.first), new_data, *weight);
 				}
+				auto inner_handle = outer_key.second.extract(inner_key);
+				inner_handle.key() = new_d;
+				outer_key.second.insert(std::move(inner_handle));
+			}
 
-				return true;
+			// replace outer key, self edges were rehashed above
+			auto outer_key = edges_.find(old_data);
+			if (outer_key != edges_.end()) {
+				for (auto const& [dst, weights] : outer_key->second) {
+					if (dst == new_d) {
+						continue;
+					}
+					for (auto const& weight : weights) {
+						hash_ -= edge_hash(old_data, *dst, *weight);
+						hash_ += edge_hash(new_data, *dst, *weight);
+					}
+				}
+				auto outer_handle = edges_.extract(outer_key);
+				outer_handle.key() = new_d;
+				edges_.insert(std::move(outer_handle));
 			}
 
-			// replace outer map key
+			++version_;
+			for (auto* o : observers_) {
+				o->node_replaced(old_data, new_data);
+			}
 			return true;
 		}
 
@@ -216,25 +361,44 @@ namespace gdwg {
 
 		// erase all nodes of value, remove all associated edges to/from it
 		auto erase_node(N const& value) noexcept -> bool {
+			[[maybe_unused]] auto const scope = probe::scope(instrumentation::operation::erase_node);
+			[[maybe_unused]] auto const span = trace::span("gdwg::graph::erase_node");
 			if (!is_node(value)) {
 				return false;
 			}
 
-			auto src = std::make_shared<N>(value);
+			auto src = make_node(value);
 			nodes_.erase(src);
-			edges_.erase(src);
 
-			for (auto iter = nodes_.begin(); iter != nodes_.end(); iter++) {
-				auto outer_node = edges_.find(*iter);
-				if (outer_node != edges_.end()) {
-					outer_node->second.erase(src);
+			// outgoing edges
+			auto outer_key = edges_.find(src);
+			if (outer_key != edges_.end()) {
+				for (auto const& [dst, weights] : outer_key->second) {
+					for (auto const& weight : weights) {
+						on_edge_erased(value, *dst, *weight);
+					}
 				}
+				edges_.erase(outer_key);
 			}
+
+			// incoming edges, dropping sources left without any
+			for (auto iter = edges_.begin(); iter != edges_.end();) {
+				auto inner_key = iter->second.find(src);
+				if (inner_key != iter->second.end()) {
+					for (auto const& weight : inner_key->second) {
+						on_edge_erased(*iter->first, value, *weight);
+					}
+					iter->second.erase(inner_key);
+				}
+				iter = iter->second.empty() ? edges_.erase(iter) : std::next(iter);
+			}
+			on_node_erased(value);
 			return true;
 		}
 
 		// erase edge of given weight
 		auto erase_edge(N const& src, N const& dst, E const& weight) -> bool {
+			[[maybe_unused]] auto const scope = probe::scope(instrumentation::operation::erase_edge);
 			if (!is_node(src) || !is_node(dst)) {
 				throw std::runtime_error("Cannot call gdwg::graph<N, E>::erase_edge on src or dst if "
 				                         "they don't exist in the graph");
@@ -244,14 +408,15 @@ namespace gdwg {
 				return false;
 			}
 
-			auto wt = std::make_shared<E>(weight);
-			auto src_n = std::make_shared<N>(src);
-			auto dst_n = std::make_shared<N>(dst);
+			auto wt = make_weight(weight);
+			auto src_n = make_node(src);
+			auto dst_n = make_node(dst);
 
 			auto iter = find(src, dst, weight);
 			if (iter != end()) {
 				if (edges_[src_n][dst_n].size() > 1) {
 					edges_[src_n][dst_n].erase(wt);
+					on_edge_erased(src, dst, weight);
 					return true;
 				}
 
@@ -259,6 +424,7 @@ namespace gdwg {
 				if (edges_[src_n][dst_n].size() == 1) {
 					edges_[src_n][dst_n].erase(wt);
 					edges_[src_n].erase(dst_n);
+					on_edge_erased(src, dst, weight);
 				}
 
 				// no dst nodes left, delete node from map
@@ -278,10 +444,138 @@ namespace gdwg {
 		auto clear() noexcept -> void {
 			nodes_.clear();
 			edges_.clear();
+			node_count_ = 0;
+			edge_count_ = 0;
+			hash_ = 0;
+			notify_reloaded();
 		}
 
 		auto erase_edge(iterator i, iterator s) -> iterator;
 
+		// applies a batch of edge inserts and erases in one pass over the affected adjacency maps.
+		// Operations are grouped by src and dst, keeping their relative order, so each source is
+		// looked up once. Either the whole batch is applied or, if an endpoint is missing or an
+		// allocation fails, the graph is left as it was. Unlike erase_edge, nodes are never
+		// removed. Returns how many operations changed the graph
+		auto apply(batch const& operations) -> std::size_t {
+			[[maybe_unused]] auto const scope = probe::scope(instrumentation::operation::apply);
+			[[maybe_unused]] auto const span = trace::span("gdwg::graph::apply");
+
+			auto steps = std::vector<batch_step>();
+			steps.reserve(operations.size());
+			for (auto const& operation : operations) {
+				steps.push_back({&operation, nodes_.end(), nodes_.end()});
+			}
+			std::stable_sort(steps.begin(), steps.end(), [](auto const& left, auto const& right) {
+				if (left.op->src < right.op->src) {
+					return true;
+				}
+				if (right.op->src < left.op->src) {
+					return false;
+				}
+				return left.op->dst < right.op->dst;
+			});
+
+			// validate everything before touching the graph
+			for (auto step = steps.begin(); step != steps.end(); ++step) {
+				auto const new_src = step == steps.begin() || std::prev(step)->op->src < step->op->src;
+				step->src = new_src ? nodes_.find(step->op->src) : std::prev(step)->src;
+				step->dst = nodes_.find(step->op->dst);
+				if (step->src == nodes_.end() || step->dst == nodes_.end()) {
+					throw std::runtime_error("Cannot call gdwg::graph<N, E>::apply when either src or "
+					                         "dst node does not exist");
+				}
+			}
+
+			auto undo = std::vector<batch_undo>();
+			undo.reserve(steps.size());
+			try {
+				auto outer = edges_.end();
+				for (auto step = steps.begin(); step != steps.end(); ++step) {
+					auto const& [op, src, dst] = *step;
+					if (step == steps.begin() || std::prev(step)->src != src) {
+						outer = edges_.find(src->first);
+					}
+
+					if (op->op == edge_operation::kind::insert) {
+						if (outer == edges_.end()) {
+							outer = edges_.emplace(src->first, dst_map()).first;
+						}
+						auto inner = outer->second.find(dst->first);
+						if (inner == outer->second.end()) {
+							inner = outer->second.emplace(dst->first, weight_set()).first;
+						}
+						if (inner->second.find(op->weight) == inner->second.end()) {
+							inner->second.insert(make_weight(op->weight));
+							undo.push_back({op, true, {}, {}, {}});
+							on_edge_inserted(*src, *dst, op->weight);
+						}
+						continue;
+					}
+
+					if (outer == edges_.end()) {
+						continue;
+					}
+					auto inner = outer->second.find(dst->first);
+					if (inner == outer->second.end()) {
+						continue;
+					}
+					auto weight = inner->second.find(op->weight);
+					if (weight == inner->second.end()) {
+						continue;
+					}
+
+					// keep whatever gets unlinked so a rollback can relink it without allocating
+					auto& entry = undo.emplace_back(batch_undo{op, false, {}, {}, {}});
+					entry.weight = inner->second.extract(weight);
+					if (inner->second.empty()) {
+						entry.dst_entry = outer->second.extract(inner);
+						if (outer->second.empty()) {
+							entry.src_entry = edges_.extract(outer);
+							outer = edges_.end();
+						}
+					}
+					on_edge_erased(*src, *dst, op->weight);
+				}
+			} catch (...) {
+				rollback(undo);
+				// an allocation may have failed after creating an empty map for the operation
+				for (auto const& step : steps) {
+					auto outer = edges_.find(step.src->first);
+					if (outer == edges_.end()) {
+						continue;
+					}
+					std::erase_if(outer->second, [](auto const& dst) { return dst.second.empty(); });
+					if (outer->second.empty()) {
+						edges_.erase(outer);
+					}
+				}
+				throw;
+			}
+			return undo.size();
+		}
+
+		// ----------   change feed -----------
+
+		// o is told about every later change until unsubscribed or destroyed. The graph doesn't
+		// own o, and copies and moves of the graph don't inherit it
+		auto subscribe(observer& o) -> void {
+			if (std::find(observers_.begin(), observers_.end(), &o) == observers_.end()) {
+				o.graphs_.push_back(this);
+				try {
+					observers_.push_back(&o);
+				} catch (...) {
+					o.graphs_.pop_back();
+					throw;
+				}
+			}
+		}
+
+		auto unsubscribe(observer& o) noexcept -> void {
+			std::erase(observers_, &o);
+			std::erase(o.graphs_, this);
+		}
+
 		// ----------   accessors -----------
 
 		// check if node of value exists
@@ -320,13 +614,99 @@ namespace gdwg {
 		// nodes as a vector in ascending order
 		[[nodiscard]] auto nodes() const -> std::vector<N> {
 			auto res_vec = std::vector<N>();
+			res_vec.reserve(node_count_);
 			for (auto& node : nodes_) {
-				res_vec.push_back(*node);
+				res_vec.push_back(*node.first);
 			}
 
 			return res_vec;
 		}
 
+		// number of nodes, O(1)
+		[[nodiscard]] auto num_nodes() const noexcept -> std::size_t {
+			return node_count_;
+		}
+
+		// number of edges counting every weight, O(1)
+		[[nodiscard]] auto num_edges() const noexcept -> std::size_t {
+			return edge_count_;
+		}
+
+		// edges leaving src, one per weight
+		[[nodiscard]] auto out_degree(N const& src) const -> std::size_t {
+			return degrees_of(src, "out_degree").out;
+		}
+
+		// edges arriving at dst, one per weight
+		[[nodiscard]] auto in_degree(N const& dst) const -> std::size_t {
+			return degrees_of(dst, "in_degree").in;
+		}
+
+		// in + out, a self edge counts twice
+		[[nodiscard]] auto degree(N const& value) const -> std::size_t {
+			auto const& counts = degrees_of(value, "degree");
+			return counts.out + counts.in;
+		}
+
+		// estimated heap footprint broken down by what owns it. Sizes assume red-black tree nodes
+		// of four pointers and make_shared control blocks holding two counts and a vtable
+		// pointer, which matches libstdc++ and libc++ on 64 bit targets
+		[[nodiscard]] auto memory_usage() const noexcept -> memory_report {
+			constexpr auto tree_node = 4 * sizeof(void*);
+			constexpr auto control_block = sizeof(void*) + 2 * sizeof(long);
+			using node_entry = typename decltype(nodes_)::value_type;
+			using src_entry = typename decltype(edges_)::value_type;
+			using dst_entry = typename decltype(edges_)::mapped_type::value_type;
+
+			auto report = memory_report{};
+			auto node_objects = node_count_;
+			auto node_heap = std::size_t{0};
+			auto dst_entries = std::size_t{0};
+			if constexpr (has_heap_payload<N>) {
+				for (auto const& node : nodes_) {
+					node_heap += heap_bytes(*node.first);
+				}
+			}
+			// apply() and replace_node() key edges_ with the pointers in nodes_, while insert_edge()
+			// and copies allocate their own. Only those are counted again
+			auto const count_key = [&](std::shared_ptr<N> const& key) {
+				auto const found = nodes_.find(*key);
+				if (found != nodes_.end() && found->first == key) {
+					return;
+				}
+				++node_objects;
+				if constexpr (has_heap_payload<N>) {
+					node_heap += heap_bytes(*key);
+				}
+			};
+			for (auto const& [src, dsts] : edges_) {
+				dst_entries += dsts.size();
+				count_key(src);
+				for (auto const& dst : dsts) {
+					count_key(dst.first);
+				}
+			}
+			auto weight_heap = std::size_t{0};
+			if constexpr (has_heap_payload<E>) {
+				for (auto const& [src, dsts] : edges_) {
+					for (auto const& [dst, weights] : dsts) {
+						for (auto const& weight : weights) {
+							weight_heap += heap_bytes(*weight);
+						}
+					}
+				}
+			}
+
+			report.nodes = node_objects * sizeof(N) + node_heap;
+			report.adjacency_maps = node_count_ * (tree_node + sizeof(node_entry))
+			                        + edges_.size() * (tree_node + sizeof(src_entry))
+			                        + dst_entries * (tree_node + sizeof(dst_entry));
+			report.weight_sets =
+			   edge_count_ * (tree_node + sizeof(std::shared_ptr<E>) + sizeof(E)) + weight_heap;
+			report.control_blocks = (node_objects + edge_count_) * control_block;
+			return report;
+		}
+
 		// asc. order of weights from src to dst
 		[[nodiscard]] auto weights(N const& src, N const& dst) const -> std::vector<E> {
 			if (!is_node(src) || !is_node(dst)) {
@@ -352,6 +732,7 @@ namespace gdwg {
 		// return iterator to connection
 		[[nodiscard]] auto find(N const& src, N const& dst, E const& weight) const noexcept
 		   -> iterator {
+			[[maybe_unused]] auto const scope = probe::scope(instrumentation::operation::find);
 			for (auto graph_iter = begin(); graph_iter != end(); graph_iter++) {
 				if ((*graph_iter).from == src && (*graph_iter).to == dst
 				    && (*graph_iter).weight == weight) {
@@ -387,13 +768,14 @@ namespace gdwg {
 		// return end if no elements or empty edges
 		[[nodiscard]] auto begin() const noexcept -> iterator {
 			// first src node's first dst node
+			if (edges_.empty()) {
+				return end();
+			}
 
 			auto srcmap = edges_.begin();
 			auto dstmap = srcmap->second.begin();
 			auto setlist = dstmap->second.begin();
-
-			auto inner_iter = edges_.empty() ? decltype(setlist){} : setlist;
-			return iterator(edges_, srcmap, dstmap, inner_iter);
+			return iterator(edges_, srcmap, dstmap, setlist);
 		}
 
 		[[nodiscard]] auto end() const noexcept -> iterator {
@@ -402,32 +784,60 @@ namespace gdwg {
 
 		// ----------   comparisons -----------
 
-		// compare 2 graphs
+		// compare 2 graphs, rejecting on count or hash mismatch before walking either graph
 		[[nodiscard]] auto operator==(graph const& other) const noexcept -> bool {
-			auto flag = 0;
-			// nodes are equal, compare maps
-			if (nodes() != other.nodes()) {
+			if (node_count_ != other.node_count_ || edge_count_ != other.edge_count_
+			    || hash_ != other.hash_)
+			{
 				return false;
 			}
 
-			auto iter1 = begin();
-			auto iter2 = other.begin();
-			while (iter1 != end() || iter2 != other.end()) {
-				if (((*iter1).from == (*iter2).from) && ((*iter1).to == (*iter2).to)
-				    && ((*iter1).weight == (*iter2).weight))
-				{
-					flag = 1;
-				}
-				else {
-					flag = 0;
-					break;
-				}
-
-				iter1++;
-				iter2++;
+			auto same_value = [](auto const& left, auto const& right) { return *left == *right; };
+			auto same_key = [](auto const& left, auto const& right) {
+				return *left.first == *right.first;
+			};
+			if (!std::equal(nodes_.begin(),
+			                nodes_.end(),
+			                other.nodes_.begin(),
+			                other.nodes_.end(),
+			                same_key))
+			{
+				return false;
 			}
 
-			return flag;
+			auto same_dst = [&](auto const& left, auto const& right) {
+				return *left.first == *right.first
+				       && std::equal(left.second.begin(),
+				                     left.second.end(),
+				                     right.second.begin(),
+				                     right.second.end(),
+				                     same_value);
+			};
+			auto same_src = [&](auto const& left, auto const& right) {
+				return *left.first == *right.first
+				       && std::equal(left.second.begin(),
+				                     left.second.end(),
+				                     right.second.begin(),
+				                     right.second.end(),
+				                     same_dst);
+			};
+			return std::equal(edges_.begin(),
+			                  edges_.end(),
+			                  other.edges_.begin(),
+			                  other.edges_.end(),
+			                  same_src);
+		}
+
+		// order-independent hash of every node and edge, maintained by the modifiers
+		[[nodiscard]] auto structural_hash() const noexcept -> std::uint64_t {
+			return hash_;
+		}
+
+		// goes up whenever the graph changes and never comes back down, so a result computed at
+		// one version is still current while version() returns the same value. Modifiers that
+		// return false leave it alone
+		[[nodiscard]] auto version() const noexcept -> std::uint64_t {
+			return version_;
 		}
 
 		//----------   extractor -----------
@@ -456,14 +866,213 @@ namespace gdwg {
 		}
 
 	private:
+		friend struct detail::graph_access;
+
 		// sorted set of all nodes in graph
-		std::set<std::shared_ptr<N>, comparator> nodes_;
+		std::map<std::shared_ptr<N>, degree_counts, comparator> nodes_;
 		// map <src, map < dest, weight, comparator >, comparator>
 		std::map<std::shared_ptr<N>,
 		         std::map<std::shared_ptr<N>, std::set<std::shared_ptr<E>, setComparator>, comparator>,
 		         comparator>
 		   edges_;
 
+		using node_map = decltype(nodes_);
+		using src_map = decltype(edges_);
+		using dst_map = typename src_map::mapped_type;
+		using weight_set = typename dst_map::mapped_type;
+
+		// an operation of apply() with both endpoints resolved
+		struct batch_step {
+			edge_operation const* op;
+			typename node_map::iterator src;
+			typename node_map::iterator dst;
+		};
+
+		// what apply() needs to undo an operation, erases keep the storage they unlinked
+		struct batch_undo {
+			edge_operation const* op;
+			bool inserted;
+			typename weight_set::node_type weight;
+			typename dst_map::node_type dst_entry;
+			typename src_map::node_type src_entry;
+		};
+
+		std::size_t node_count_ = 0;
+		std::size_t edge_count_ = 0;
+		std::uint64_t hash_ = 0;
+		std::uint64_t version_ = 0;
+		std::vector<observer*> observers_;
+
+		// splitmix64 finaliser, spreads std::hash output so that sums of hashes stay distinct
+		static auto mix(std::uint64_t h) noexcept -> std::uint64_t {
+			h ^= h >> 30U;
+			h *= 0xbf58476d1ce4e5b9ULL;
+			h ^= h >> 27U;
+			h *= 0x94d049bb133111ebULL;
+			return h ^ (h >> 31U);
+		}
+
+		// types without a std::hash specialisation only contribute to the counts
+		template<typename T>
+		static auto hash_value(T const& value) noexcept -> std::uint64_t {
+			if constexpr (requires { std::hash<T>{}(value); }) {
+				return std::hash<T>{}(value);
+			}
+			else {
+				return 0;
+			}
+		}
+
+		static auto node_hash(N const& value) noexcept -> std::uint64_t {
+			return mix(hash_value(value));
+		}
+
+		static auto edge_hash(N const& src, N const& dst, E const& weight) noexcept -> std::uint64_t {
+			auto h = mix(hash_value(src) + 0x9e3779b97f4a7c15ULL);
+			h = mix(h ^ hash_value(dst));
+			return mix(h ^ hash_value(weight));
+		}
+
+		// bookkeeping shared by every modifier
+		auto on_node_inserted(N const& value) noexcept -> void {
+			++node_count_;
+			++version_;
+			hash_ += node_hash(value);
+			for (auto* o : observers_) {
+				o->node_inserted(value);
+			}
+		}
+
+		auto on_node_erased(N const& value) noexcept -> void {
+			--node_count_;
+			++version_;
+			hash_ -= node_hash(value);
+			for (auto* o : observers_) {
+				o->node_erased(value);
+			}
+		}
+
+		auto on_edge_inserted(N const& src, N const& dst, E const& weight) noexcept -> void {
+			on_edge_inserted(*nodes_.find(src), *nodes_.find(dst), weight);
+		}
+
+		auto on_edge_inserted(typename node_map::value_type& src,
+		                      typename node_map::value_type& dst,
+		                      E const& weight) noexcept -> void {
+			++edge_count_;
+			++version_;
+			++src.second.out;
+			++dst.second.in;
+			hash_ += edge_hash(*src.first, *dst.first, weight);
+			for (auto* o : observers_) {
+				o->edge_inserted(*src.first, *dst.first, weight);
+			}
+		}
+
+		// endpoints may already be gone when called from erase_node
+		auto on_edge_erased(N const& src, N const& dst, E const& weight) noexcept -> void {
+			--edge_count_;
+			++version_;
+			if (auto found = nodes_.find(src); found != nodes_.end()) {
+				--found->second.out;
+			}
+			if (auto found = nodes_.find(dst); found != nodes_.end()) {
+				--found->second.in;
+			}
+			hash_ -= edge_hash(src, dst, weight);
+			for (auto* o : observers_) {
+				o->edge_erased(src, dst, weight);
+			}
+		}
+
+		auto on_edge_erased(typename node_map::value_type& src,
+		                    typename node_map::value_type& dst,
+		                    E const& weight) noexcept -> void {
+			--edge_count_;
+			++version_;
+			--src.second.out;
+			--dst.second.in;
+			hash_ -= edge_hash(*src.first, *dst.first, weight);
+			for (auto* o : observers_) {
+				o->edge_erased(*src.first, *dst.first, weight);
+			}
+		}
+
+		auto notify_reloaded() noexcept -> void {
+			++version_;
+			for (auto* o : observers_) {
+				o->reloaded();
+			}
+		}
+
+		// reverts the applied part of a failed apply(), newest first
+		auto rollback(std::vector<batch_undo>& undo) noexcept -> void {
+			for (auto entry = undo.rbegin(); entry != undo.rend(); ++entry) {
+				auto const& op = *entry->op;
+				auto& src = *nodes_.find(op.src);
+				auto& dst = *nodes_.find(op.dst);
+				if (entry->inserted) {
+					auto outer = edges_.find(op.src);
+					auto inner = outer->second.find(op.dst);
+					inner->second.erase(inner->second.find(op.weight));
+					if (inner->second.empty()) {
+						outer->second.erase(inner);
+					}
+					if (outer->second.empty()) {
+						edges_.erase(outer);
+					}
+					on_edge_erased(src, dst, op.weight);
+					continue;
+				}
+
+				if (!entry->src_entry.empty()) {
+					edges_.insert(std::move(entry->src_entry));
+				}
+				auto outer = edges_.find(op.src);
+				if (!entry->dst_entry.empty()) {
+					outer->second.insert(std::move(entry->dst_entry));
+				}
+				outer->second.find(op.dst)->second.insert(std::move(entry->weight));
+				on_edge_inserted(src, dst, op.weight);
+			}
+		}
+
+		// every shared_ptr the graph creates goes through these so allocations can be counted
+		static auto make_node(N const& value) -> std::shared_ptr<N> {
+			probe::count_allocation();
+			return std::make_shared<N>(value);
+		}
+
+		static auto make_weight(E const& value) -> std::shared_ptr<E> {
+			probe::count_allocation();
+			return std::make_shared<E>(value);
+		}
+
+		auto degrees_of(N const& value, char const* caller) const -> degree_counts const& {
+			auto found = nodes_.find(value);
+			if (found == nodes_.end()) {
+				throw std::runtime_error(std::string("Cannot call gdwg::graph<N, E>::") + caller
+				                         + " if the node doesn't exist in the graph");
+			}
+			return found->second;
+		}
+
+		// containers such as std::string keep their elements on the heap once past the small
+		// buffer, which lives inside the object itself
+		template<typename T>
+		static constexpr bool has_heap_payload = requires(T const& value) {
+			value.capacity();
+			value.data();
+		};
+
+		template<typename T>
+		static auto heap_bytes(T const& value) noexcept -> std::size_t {
+			auto const* data = reinterpret_cast<char const*>(value.data());
+			auto const* self = reinterpret_cast<char const*>(&value);
+			auto const in_place = !std::less<>{}(data, self) && std::less<>{}(data, self + sizeof(T));
+			return in_place ? 0 : value.capacity() * sizeof(*value.data());
+		}
+
 		auto edge_exists(N const& src, N const& dst, E const& weight) const noexcept -> bool {
 			// iterate through set of pairs
 			for (auto const& src_nodes : edges_) {
@@ -516,6 +1125,8 @@ namespace gdwg {
 
 		// pre increment
 		auto operator++() noexcept -> iterator& {
+			[[maybe_unused]] auto const scope =
+			   probe::scope(instrumentation::operation::iterator_increment);
 			// make setlist point to start of next set
 			auto set_end = middle_iter->second.end();
 			// inner iter is not at end of inner key's set
@@ -560,6 +1171,8 @@ namespace gdwg {
 
 		// pre-decremennt
 		auto operator--() noexcept -> iterator& {
+			[[maybe_unused]] auto const scope =
+			   probe::scope(instrumentation::operation::iterator_decrement);
 			// at end of ds
 			if (inner_iter == inner()) {
 				outer_iter = std::prev(edges_->end());
@@ -658,6 +1271,30 @@ namespace gdwg {
 		return res;
 	}
 
+	namespace detail {
+		// read only view of a graph's storage for the views and algorithms built on top of it
+		struct graph_access {
+			template<typename N, typename E>
+			using node_map = typename graph<N, E>::node_map;
+			template<typename N, typename E>
+			using src_map = typename graph<N, E>::src_map;
+			template<typename N, typename E>
+			using dst_map = typename graph<N, E>::dst_map;
+			template<typename N, typename E>
+			using weight_set = typename graph<N, E>::weight_set;
+
+			template<typename N, typename E>
+			static auto nodes(graph<N, E> const& g) noexcept -> auto const& {
+				return g.nodes_;
+			}
+
+			template<typename N, typename E>
+			static auto edges(graph<N, E> const& g) noexcept -> auto const& {
+				return g.edges_;
+			}
+		};
+	} // namespace detail
+
 } // namespace gdwg
 
 #endif // GDWG_GRAPH_HPP
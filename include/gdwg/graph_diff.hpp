@@ -0,0 +1,264 @@
+#ifndef GDWG_GRAPH_DIFF_HPP
+#define GDWG_GRAPH_DIFF_HPP
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <span>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include "gdwg/detail/crc32.hpp"
+#include "gdwg/detail/varint.hpp"
+#include "gdwg/graph.hpp"
+#include "gdwg/serializer.hpp"
+#include "gdwg/trace.hpp"
+
+// The difference between two graphs as node and edge insertions and erasures, for keeping a
+// replica in step by shipping what changed rather than the whole graph. diff() walks both graphs'
+// sorted node maps and sorted edges side by side, so it is linear in their sizes and compares
+// values only with operator<. Edges that go because one of their endpoints does are left out,
+// since erasing the node takes them with it.
+//
+// A delta records the structural_hash of the graph it was taken from and of the graph it leads
+// to. apply_patch refuses a graph with a different hash before changing anything, so a replica
+// that missed a delta, or got one twice, finds out rather than drifting. encode_delta packs a
+// delta into bytes with a checksum, each run of edges sharing a source writing the source once.
+
+namespace gdwg {
+	template<typename N, typename E>
+	struct graph_delta {
+		using edge = typename graph<N, E>::value_type;
+
+		std::uint64_t base_hash = 0;
+		std::uint64_t target_hash = 0;
+		// each ascending, edges by source, destination then weight
+		std::vector<N> erased_nodes;
+		std::vector<N> inserted_nodes;
+		std::vector<edge> erased_edges;
+		std::vector<edge> inserted_edges;
+
+		// whether both graphs were the same
+		[[nodiscard]] auto empty() const noexcept -> bool {
+			return erased_nodes.empty() && inserted_nodes.empty() && erased_edges.empty()
+			       && inserted_edges.empty();
+		}
+	};
+
+	namespace detail {
+		inline constexpr auto delta_magic =
+		   std::array<char, 8>{'G', 'D', 'W', 'G', 'D', 'I', 'F', '1'};
+		// magic, then a crc32c of the rest
+		inline constexpr auto delta_header_size = delta_magic.size() + sizeof(std::uint32_t);
+
+		template<typename N, typename E>
+		auto edge_before(typename graph<N, E>::value_type const& left,
+		                 typename graph<N, E>::value_type const& right) -> bool {
+			if (left.from < right.from) {
+				return true;
+			}
+			if (right.from < left.from) {
+				return false;
+			}
+			if (left.to < right.to) {
+				return true;
+			}
+			if (right.to < left.to) {
+				return false;
+			}
+			return left.weight < right.weight;
+		}
+
+		template<typename N, typename E>
+		auto put_edges(std::vector<std::uint8_t>& out,
+		               std::vector<typename graph<N, E>::value_type> const& edges) -> void {
+			auto runs = std::size_t{0};
+			for (auto i = std::size_t{0}; i < edges.size(); ++i) {
+				runs += i == 0 || edges[i - 1].from < edges[i].from ? 1U : 0U;
+			}
+			put_varint(out, runs);
+			for (auto first = std::size_t{0}; first < edges.size();) {
+				auto last = first + 1;
+				while (last < edges.size() && !(edges[first].from < edges[last].from)) {
+					++last;
+				}
+				serializer<N>::put(out, edges[first].from);
+				put_varint(out, last - first);
+				for (auto i = first; i < last; ++i) {
+					serializer<N>::put(out, edges[i].to);
+					serializer<E>::put(out, edges[i].weight);
+				}
+				first = last;
+			}
+		}
+
+		template<typename N, typename E>
+		auto get_edges(byte_reader& in) -> std::vector<typename graph<N, E>::value_type> {
+			auto edges = std::vector<typename graph<N, E>::value_type>();
+			for (auto runs = in.varint(); runs != 0; --runs) {
+				auto const from = serializer<N>::get(in);
+				for (auto count = in.varint(); count != 0; --count) {
+					auto to = serializer<N>::get(in);
+					edges.push_back({from, std::move(to), serializer<E>::get(in)});
+				}
+			}
+			return edges;
+		}
+
+		template<typename N>
+		auto put_nodes(std::vector<std::uint8_t>& out, std::vector<N> const& nodes) -> void {
+			put_varint(out, nodes.size());
+			for (auto const& value : nodes) {
+				serializer<N>::put(out, value);
+			}
+		}
+
+		template<typename N>
+		auto get_nodes(byte_reader& in) -> std::vector<N> {
+			auto nodes = std::vector<N>();
+			for (auto count = in.varint(); count != 0; --count) {
+				nodes.push_back(serializer<N>::get(in));
+			}
+			return nodes;
+		}
+	} // namespace detail
+
+	// what to do to a to make it b
+	template<typename N, typename E>
+	auto diff(graph<N, E> const& a, graph<N, E> const& b) -> graph_delta<N, E> {
+		[[maybe_unused]] auto const span = trace::span("gdwg::diff");
+		auto delta = graph_delta<N, E>();
+		delta.base_hash = a.structural_hash();
+		delta.target_hash = b.structural_hash();
+
+		auto const& old_nodes = detail::graph_access::nodes(a);
+		auto const& new_nodes = detail::graph_access::nodes(b);
+		auto left = old_nodes.begin();
+		auto right = new_nodes.begin();
+		while (left != old_nodes.end() || right != new_nodes.end()) {
+			if (right == new_nodes.end()
+			    || (left != old_nodes.end() && *left->first < *right->first))
+			{
+				delta.erased_nodes.push_back(*(left++)->first);
+			}
+			else if (left == old_nodes.end() || *right->first < *left->first) {
+				delta.inserted_nodes.push_back(*(right++)->first);
+			}
+			else {
+				++left;
+				++right;
+			}
+		}
+
+		auto const survives = [&](N const& value) {
+			return !std::binary_search(delta.erased_nodes.begin(), delta.erased_nodes.end(), value);
+		};
+		auto old_edge = a.begin();
+		auto new_edge = b.begin();
+		while (old_edge != a.end() || new_edge != b.end()) {
+			if (new_edge == b.end()
+			    || (old_edge != a.end() && detail::edge_before<N, E>(*old_edge, *new_edge)))
+			{
+				auto edge = *old_edge++;
+				if (survives(edge.from) && survives(edge.to)) {
+					delta.erased_edges.push_back(std::move(edge));
+				}
+			}
+			else if (old_edge == a.end() || detail::edge_before<N, E>(*new_edge, *old_edge)) {
+				delta.inserted_edges.push_back(*new_edge++);
+			}
+			else {
+				++old_edge;
+				++new_edge;
+			}
+		}
+		return delta;
+	}
+
+	// turns the graph delta was taken from into the one it leads to. Nodes are erased and inserted
+	// first, then every edge change goes through one graph::apply batch
+	template<typename N, typename E>
+	auto apply_patch(graph<N, E>& g, graph_delta<N, E> const& delta) -> void {
+		[[maybe_unused]] auto const span = trace::span("gdwg::apply_patch");
+		if (g.structural_hash() != delta.base_hash) {
+			throw std::runtime_error("Cannot call gdwg::apply_patch on a graph the delta wasn't taken "
+			                         "from");
+		}
+		for (auto const& value : delta.erased_nodes) {
+			g.erase_node(value);
+		}
+		for (auto const& value : delta.inserted_nodes) {
+			g.insert_node(value);
+		}
+
+		using kind = typename graph<N, E>::edge_operation::kind;
+		auto batch = typename graph<N, E>::batch();
+		batch.reserve(delta.erased_edges.size() + delta.inserted_edges.size());
+		for (auto const& [src, dst, weight] : delta.erased_edges) {
+			batch.push_back({kind::erase, src, dst, weight});
+		}
+		for (auto const& [src, dst, weight] : delta.inserted_edges) {
+			batch.push_back({kind::insert, src, dst, weight});
+		}
+		g.apply(batch);
+	}
+
+	template<typename N, typename E>
+	auto encode_delta(graph_delta<N, E> const& delta) -> std::vector<std::uint8_t> {
+		[[maybe_unused]] auto const span = trace::span("gdwg::encode_delta");
+		auto out = std::vector<std::uint8_t>(detail::delta_header_size);
+		std::memcpy(out.data(), detail::delta_magic.data(), detail::delta_magic.size());
+		auto const body = out.size();
+		auto constexpr hash_size = sizeof(std::uint64_t);
+		out.resize(body + 2 * hash_size);
+		std::memcpy(out.data() + body, &delta.base_hash, hash_size);
+		std::memcpy(out.data() + body + hash_size, &delta.target_hash, hash_size);
+		detail::put_nodes(out, delta.erased_nodes);
+		detail::put_nodes(out, delta.inserted_nodes);
+		detail::put_edges<N, E>(out, delta.erased_edges);
+		detail::put_edges<N, E>(out, delta.inserted_edges);
+
+		auto const crc = detail::crc32c(out.data() + body, out.size() - body);
+		std::memcpy(out.data() + detail::delta_magic.size(), &crc, sizeof(crc));
+		return out;
+	}
+
+	template<typename N, typename E>
+	auto decode_delta(std::span<std::uint8_t const> bytes) -> graph_delta<N, E> {
+		[[maybe_unused]] auto const span = trace::span("gdwg::decode_delta");
+		auto const& magic = detail::delta_magic;
+		auto crc = std::uint32_t{0};
+		if (bytes.size() >= detail::delta_header_size) {
+			std::memcpy(&crc, bytes.data() + magic.size(), sizeof(crc));
+		}
+		if (bytes.size() < detail::delta_header_size + 2 * sizeof(std::uint64_t)
+		    || !std::equal(magic.begin(), magic.end(), bytes.begin())
+		    || detail::crc32c(bytes.data() + detail::delta_header_size,
+		                      bytes.size() - detail::delta_header_size)
+		          != crc)
+		{
+			throw std::runtime_error("Cannot call gdwg::decode_delta on bytes that aren't an intact "
+			                         "delta");
+		}
+
+		auto in = byte_reader(bytes.subspan(detail::delta_header_size));
+		auto delta = graph_delta<N, E>();
+		auto constexpr hash_size = sizeof(std::uint64_t);
+		std::memcpy(&delta.base_hash, in.bytes(hash_size).data(), hash_size);
+		std::memcpy(&delta.target_hash, in.bytes(hash_size).data(), hash_size);
+		delta.erased_nodes = detail::get_nodes<N>(in);
+		delta.inserted_nodes = detail::get_nodes<N>(in);
+		delta.erased_edges = detail::get_edges<N, E>(in);
+		delta.inserted_edges = detail::get_edges<N, E>(in);
+		if (in.remaining() != 0) {
+			throw std::runtime_error("Cannot call gdwg::decode_delta on bytes that aren't an intact "
+			                         "delta");
+		}
+		return delta;
+	}
+} // namespace gdwg
+
+#endif // GDWG_GRAPH_DIFF_HPP
@@ -0,0 +1,498 @@
+#ifndef GDWG_INCREMENTAL_HPP
+#define GDWG_INCREMENTAL_HPP
+
+#include <array>
+#include <cstddef>
+#include <functional>
+#include <map>
+#include <optional>
+#include <queue>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include "gdwg/detail/attached_observer.hpp"
+#include "gdwg/graph.hpp"
+#include "gdwg/trace.hpp"
+
+// Results kept up to date through a graph's change feed. Each one subscribes to the graph it is
+// built from and does work proportional to the part of the graph a change touches, rather than
+// recomputing from scratch. Neither is safe to use while another thread modifies the graph.
+
+namespace gdwg {
+	namespace detail {
+		// stable small integer ids for the nodes an incremental structure is tracking, reused after
+		// the node is erased
+		template<typename N>
+		class node_slots {
+		public:
+			static constexpr auto none = static_cast<std::size_t>(-1);
+
+			auto add(N const& value) -> std::size_t {
+				auto slot = next_;
+				if (free_.empty()) {
+					++next_;
+				}
+				else {
+					slot = free_.back();
+					free_.pop_back();
+				}
+				ids_.emplace(value, slot);
+				return slot;
+			}
+
+			auto remove(N const& value) -> std::size_t {
+				auto found = ids_.find(value);
+				auto const slot = found->second;
+				ids_.erase(found);
+				free_.push_back(slot);
+				return slot;
+			}
+
+			auto rename(N const& old_data, N const& new_data) -> void {
+				auto handle = ids_.extract(old_data);
+				handle.key() = new_data;
+				ids_.insert(std::move(handle));
+			}
+
+			[[nodiscard]] auto find(N const& value) const -> std::size_t {
+				auto found = ids_.find(value);
+				return found == ids_.end() ? none : found->second;
+			}
+
+			auto clear() noexcept -> void {
+				ids_.clear();
+				free_.clear();
+				next_ = 0;
+			}
+
+		private:
+			std::map<N, std::size_t> ids_;
+			std::vector<std::size_t> free_;
+			std::size_t next_ = 0;
+		};
+	} // namespace detail
+
+	// which nodes are joined by a path when edge directions are ignored. Inserting an edge merges
+	// the smaller component into the larger. Erasing the last edge between two nodes searches
+	// outwards from both ends at once and stops as soon as they meet or the smaller side runs out,
+	// so a split costs about the size of the piece that broke off
+	template<typename N, typename E>
+	class incremental_connectivity : private detail::attached_observer<N, E> {
+	public:
+		explicit incremental_connectivity(graph<N, E>& g)
+		: detail::attached_observer<N, E>(g) {
+			rebuild();
+			this->subscribe();
+		}
+
+		[[nodiscard]] auto connected(N const& a, N const& b) const -> bool {
+			return component_of(a, "connected") == component_of(b, "connected");
+		}
+
+		[[nodiscard]] auto component_count() const noexcept -> std::size_t {
+			return component_count_;
+		}
+
+		[[nodiscard]] auto component_size(N const& value) const -> std::size_t {
+			return members_[component_of(value, "component_size")].size();
+		}
+
+	private:
+		using slot = std::size_t;
+
+		struct vertex {
+			// neighbour in either direction, and how many edges join the two
+			std::map<slot, std::size_t> neighbours;
+			std::size_t component = 0;
+			// where the vertex sits in its component's member list
+			std::size_t position = 0;
+		};
+
+		detail::node_slots<N> slots_;
+		std::vector<vertex> vertices_;
+		std::vector<std::vector<slot>> members_;
+		std::vector<std::size_t> free_components_;
+		std::size_t component_count_ = 0;
+
+		auto component_of(N const& value, char const* caller) const -> std::size_t {
+			auto const s = slots_.find(value);
+			if (s == detail::node_slots<N>::none) {
+				throw std::runtime_error(std::string("Cannot call gdwg::incremental_connectivity<N, "
+				                                     "E>::")
+				                         + caller + " if the node doesn't exist in the graph");
+			}
+			return vertices_[s].component;
+		}
+
+		auto rebuild() -> void {
+			[[maybe_unused]] auto const span = trace::span("gdwg::incremental_connectivity::rebuild");
+			slots_.clear();
+			vertices_.clear();
+			members_.clear();
+			free_components_.clear();
+			component_count_ = 0;
+			for (auto const& value : this->graph_->nodes()) {
+				node_inserted(value);
+			}
+			for (auto const& [from, to, weight] : *this->graph_) {
+				edge_inserted(from, to, weight);
+			}
+		}
+
+		auto new_component() -> std::size_t {
+			++component_count_;
+			if (free_components_.empty()) {
+				members_.emplace_back();
+				return members_.size() - 1;
+			}
+			auto const c = free_components_.back();
+			free_components_.pop_back();
+			return c;
+		}
+
+		auto drop_component(std::size_t c) -> void {
+			--component_count_;
+			members_[c].clear();
+			free_components_.push_back(c);
+		}
+
+		auto move_to(slot v, std::size_t to) -> void {
+			auto& from = members_[vertices_[v].component];
+			auto const position = vertices_[v].position;
+			from[position] = from.back();
+			vertices_[from[position]].position = position;
+			from.pop_back();
+			vertices_[v].component = to;
+			vertices_[v].position = members_[to].size();
+			members_[to].push_back(v);
+		}
+
+		auto node_inserted(N const& value) -> void override {
+			auto const v = slots_.add(value);
+			if (v == vertices_.size()) {
+				vertices_.emplace_back();
+			}
+			auto const c = new_component();
+			vertices_[v] = vertex{{}, c, 0};
+			members_[c].push_back(v);
+		}
+
+		// the graph reports every edge of a node before the node itself, so it is isolated by now
+		auto node_erased(N const& value) -> void override {
+			auto const v = slots_.remove(value);
+			drop_component(vertices_[v].component);
+		}
+
+		auto node_replaced(N const& old_data, N const& new_data) -> void override {
+			slots_.rename(old_data, new_data);
+		}
+
+		auto edge_inserted(N const& src, N const& dst, E const& /*weight*/) -> void override {
+			auto const u = slots_.find(src);
+			auto const v = slots_.find(dst);
+			if (u == v) {
+				return;
+			}
+			++vertices_[u].neighbours[v];
+			++vertices_[v].neighbours[u];
+
+			auto big = vertices_[u].component;
+			auto small = vertices_[v].component;
+			if (big == small) {
+				return;
+			}
+			if (members_[big].size() < members_[small].size()) {
+				std::swap(big, small);
+			}
+			while (!members_[small].empty()) {
+				move_to(members_[small].back(), big);
+			}
+			drop_component(small);
+		}
+
+		auto edge_erased(N const& src, N const& dst, E const& /*weight*/) -> void override {
+			auto const u = slots_.find(src);
+			auto const v = slots_.find(dst);
+			if (u == v) {
+				return;
+			}
+			unlink(v, u);
+			if (!unlink(u, v)) {
+				return;
+			}
+
+			// alternate one vertex of each search at a time
+			auto seen = std::unordered_map<slot, int>{{u, 0}, {v, 1}};
+			auto frontier = std::array<std::queue<slot>, 2>();
+			auto reached = std::array<std::vector<slot>, 2>{std::vector{u}, std::vector{v}};
+			frontier[0].push(u);
+			frontier[1].push(v);
+			for (auto side = 0;; side = 1 - side) {
+				if (frontier[side].empty()) {
+					break;
+				}
+				auto const x = frontier[side].front();
+				frontier[side].pop();
+				for (auto const& [y, count] : vertices_[x].neighbours) {
+					auto [found, inserted] = seen.emplace(y, side);
+					if (!inserted) {
+						if (found->second != side) {
+							return;
+						}
+						continue;
+					}
+					frontier[side].push(y);
+					reached[side].push_back(y);
+				}
+			}
+
+			// whichever search ran out first holds everything that broke off
+			auto const split = frontier[0].empty() ? 0 : 1;
+			auto const c = new_component();
+			for (auto x : reached[split]) {
+				move_to(x, c);
+			}
+		}
+
+		// true if no edge joins a and b any more
+		auto unlink(slot a, slot b) -> bool {
+			auto found = vertices_[a].neighbours.find(b);
+			if (--found->second != 0) {
+				return false;
+			}
+			vertices_[a].neighbours.erase(found);
+			return true;
+		}
+
+		auto reloaded() -> void override {
+			rebuild();
+		}
+	};
+
+	// shortest distances from one source, treating the weights as non-negative lengths. E needs
+	// operator+ and a value-initialised E as zero. Each node keeps the neighbour its shortest path
+	// arrives from. A new edge that shortens a path starts Dijkstra's algorithm from its far end;
+	// erasing an edge on the tree of shortest paths resets the subtree hanging below it and
+	// re-runs Dijkstra over just that subtree, seeded from the edges that enter it
+	template<typename N, typename E>
+	class incremental_shortest_paths : private detail::attached_observer<N, E> {
+	public:
+		incremental_shortest_paths(graph<N, E>& g, N source)
+		: detail::attached_observer<N, E>(g)
+		, source_(std::move(source)) {
+			rebuild();
+			this->subscribe();
+		}
+
+		[[nodiscard]] auto source() const noexcept -> N const& {
+			return source_;
+		}
+
+		// nullopt when dst can't be reached
+		[[nodiscard]] auto distance(N const& dst) const -> std::optional<E> {
+			return vertices_[slot_of(dst, "distance")].distance;
+		}
+
+		// source to dst inclusive, empty when dst can't be reached
+		[[nodiscard]] auto path(N const& dst) const -> std::vector<N> {
+			auto v = slot_of(dst, "path");
+			if (!vertices_[v].distance) {
+				return {};
+			}
+			auto res_vector = std::vector<N>();
+			for (; v != none; v = vertices_[v].parent) {
+				res_vector.push_back(names_.at(v));
+			}
+			return std::vector<N>(res_vector.rbegin(), res_vector.rend());
+		}
+
+	private:
+		using slot = std::size_t;
+		static constexpr auto none = detail::node_slots<N>::none;
+
+		struct vertex {
+			// neighbour to every weight of the edges joining them, in both directions
+			std::map<slot, std::set<E>> out;
+			std::map<slot, std::set<E>> in;
+			std::optional<E> distance;
+			slot parent = none;
+		};
+
+		using entry = std::pair<E, slot>;
+		using heap = std::priority_queue<entry, std::vector<entry>, std::greater<>>;
+
+		N source_;
+		detail::node_slots<N> slots_;
+		std::vector<vertex> vertices_;
+		// slot back to node, for path()
+		std::map<slot, N> names_;
+
+		auto slot_of(N const& value, char const* caller) const -> slot {
+			auto const s = slots_.find(value);
+			if (s == none) {
+				throw std::runtime_error(std::string("Cannot call gdwg::incremental_shortest_paths<N, "
+				                                     "E>::")
+				                         + caller + " if the node doesn't exist in the graph");
+			}
+			return s;
+		}
+
+		auto rebuild() -> void {
+			[[maybe_unused]] auto const span =
+			   trace::span("gdwg::incremental_shortest_paths::rebuild");
+			slots_.clear();
+			vertices_.clear();
+			names_.clear();
+			for (auto const& value : this->graph_->nodes()) {
+				add_vertex(value);
+			}
+			for (auto const& [from, to, weight] : *this->graph_) {
+				auto const u = slots_.find(from);
+				auto const v = slots_.find(to);
+				vertices_[u].out[v].insert(weight);
+				vertices_[v].in[u].insert(weight);
+			}
+			if (auto const s = slots_.find(source_); s != none) {
+				auto pending = heap();
+				pending.emplace(*vertices_[s].distance, s);
+				settle(pending);
+			}
+		}
+
+		auto add_vertex(N const& value) -> void {
+			auto const v = slots_.add(value);
+			if (v == vertices_.size()) {
+				vertices_.emplace_back();
+			}
+			vertices_[v] = vertex{};
+			names_.insert_or_assign(v, value);
+			if (value == source_) {
+				vertices_[v].distance = E{};
+			}
+		}
+
+		// Dijkstra from whatever is queued, only ever lowering distances
+		auto settle(heap& pending) -> void {
+			while (!pending.empty()) {
+				auto const [d, x] = pending.top();
+				pending.pop();
+				if (vertices_[x].distance != d) {
+					continue;
+				}
+				for (auto const& [y, weights] : vertices_[x].out) {
+					auto const through = d + *weights.begin();
+					if (!vertices_[y].distance || through < *vertices_[y].distance) {
+						vertices_[y].distance = through;
+						vertices_[y].parent = x;
+						pending.emplace(through, y);
+					}
+				}
+			}
+		}
+
+		auto node_inserted(N const& value) -> void override {
+			add_vertex(value);
+		}
+
+		auto node_erased(N const& value) -> void override {
+			auto const v = slots_.remove(value);
+			vertices_[v] = vertex{};
+			names_.erase(v);
+		}
+
+		auto node_replaced(N const& old_data, N const& new_data) -> void override {
+			auto const v = slots_.find(old_data);
+			slots_.rename(old_data, new_data);
+			names_[v] = new_data;
+			// the source follows its node, but a node renamed to the source's value becomes it
+			if (old_data == source_) {
+				source_ = new_data;
+			}
+			else if (new_data == source_) {
+				rebuild();
+			}
+		}
+
+		auto edge_inserted(N const& src, N const& dst, E const& weight) -> void override {
+			auto const u = slots_.find(src);
+			auto const v = slots_.find(dst);
+			vertices_[u].out[v].insert(weight);
+			vertices_[v].in[u].insert(weight);
+			auto const& from = vertices_[u].distance;
+			auto& to = vertices_[v];
+			if (!from || (to.distance && !(*from + weight < *to.distance))) {
+				return;
+			}
+			to.distance = *from + weight;
+			to.parent = u;
+			auto pending = heap();
+			pending.emplace(*to.distance, v);
+			settle(pending);
+		}
+
+		auto edge_erased(N const& src, N const& dst, E const& weight) -> void override {
+			auto const u = slots_.find(src);
+			auto const v = slots_.find(dst);
+			auto const was_shortest = weight == *vertices_[u].out[v].begin();
+			forget(vertices_[u].out, v, weight);
+			forget(vertices_[v].in, u, weight);
+			if (vertices_[v].parent != u || !was_shortest) {
+				return;
+			}
+
+			// everything whose shortest path ran through the erased edge
+			auto affected = std::unordered_set<slot>{v};
+			auto order = std::vector<slot>{v};
+			for (auto i = std::size_t{0}; i < order.size(); ++i) {
+				for (auto const& [y, weights] : vertices_[order[i]].out) {
+					if (vertices_[y].parent == order[i] && affected.insert(y).second) {
+						order.push_back(y);
+					}
+				}
+			}
+			for (auto x : order) {
+				vertices_[x].distance.reset();
+				vertices_[x].parent = none;
+			}
+
+			auto pending = heap();
+			for (auto x : order) {
+				auto& target = vertices_[x];
+				for (auto const& [p, weights] : target.in) {
+					auto const& from = vertices_[p].distance;
+					if (affected.contains(p) || !from) {
+						continue;
+					}
+					auto const through = *from + *weights.begin();
+					if (!target.distance || through < *target.distance) {
+						target.distance = through;
+						target.parent = p;
+					}
+				}
+				if (target.distance) {
+					pending.emplace(*target.distance, x);
+				}
+			}
+			settle(pending);
+		}
+
+		static auto forget(std::map<slot, std::set<E>>& edges, slot other, E const& weight) -> void {
+			auto found = edges.find(other);
+			found->second.erase(weight);
+			if (found->second.empty()) {
+				edges.erase(found);
+			}
+		}
+
+		auto reloaded() -> void override {
+			rebuild();
+		}
+	};
+} // namespace gdwg
+
+#endif // GDWG_INCREMENTAL_HPP
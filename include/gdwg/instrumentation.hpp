@@ -0,0 +1,239 @@
+#ifndef GDWG_INSTRUMENTATION_HPP
+#define GDWG_INSTRUMENTATION_HPP
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <string_view>
+#include <type_traits>
+
+// Per operation counters and latency histograms for gdwg::graph.
+// Off by default, build with -DGDWG_INSTRUMENTATION=1 to turn them on. When off every probe is an
+// empty inline function or an empty object, so the graph compiles to the same code as without them.
+// Every translation unit in a program should agree on the setting.
+
+#ifndef GDWG_INSTRUMENTATION
+#define GDWG_INSTRUMENTATION 0
+#endif
+
+namespace gdwg::instrumentation {
+	enum class operation : std::size_t {
+		insert_node,
+		insert_edge,
+		replace_node,
+		erase_node,
+		erase_edge,
+		apply,
+		find,
+		iterator_increment,
+		iterator_decrement,
+		count
+	};
+
+	inline constexpr auto operation_count = static_cast<std::size_t>(operation::count);
+
+	// bucket i counts calls that took [2^(i-1), 2^i) nanoseconds, bucket 0 is anything under 1ns
+	inline constexpr std::size_t histogram_buckets = 40;
+
+	[[nodiscard]] constexpr auto to_string(operation op) noexcept -> std::string_view {
+		switch (op) {
+		case operation::insert_node: return "insert_node";
+		case operation::insert_edge: return "insert_edge";
+		case operation::replace_node: return "replace_node";
+		case operation::erase_node: return "erase_node";
+		case operation::erase_edge: return "erase_edge";
+		case operation::apply: return "apply";
+		case operation::find: return "find";
+		case operation::iterator_increment: return "iterator_increment";
+		case operation::iterator_decrement: return "iterator_decrement";
+		case operation::count: break;
+		}
+		return "unknown";
+	}
+
+	// plain copy of the counters for one operation
+	struct operation_stats {
+		std::uint64_t calls = 0;
+		std::uint64_t allocations = 0;
+		std::uint64_t comparisons = 0;
+		std::array<std::uint64_t, histogram_buckets> latency_ns{};
+
+		// upper bound in nanoseconds of the bucket holding the given quantile, 0 when never called
+		[[nodiscard]] auto percentile(double quantile) const noexcept -> std::uint64_t {
+			auto total = std::uint64_t{0};
+			for (auto bucket : latency_ns) {
+				total += bucket;
+			}
+			if (total == 0) {
+				return 0;
+			}
+
+			auto const target = static_cast<double>(total) * quantile;
+			auto seen = std::uint64_t{0};
+			for (auto i = std::size_t{0}; i < histogram_buckets; ++i) {
+				seen += latency_ns[i];
+				if (static_cast<double>(seen) >= target && latency_ns[i] != 0) {
+					return std::uint64_t{1} << i;
+				}
+			}
+			return std::uint64_t{1} << (histogram_buckets - 1);
+		}
+	};
+
+	// point in time copy of every counter, safe to keep around and print
+	struct snapshot {
+		std::array<operation_stats, operation_count> operations{};
+
+		[[nodiscard]] auto operator[](operation op) const noexcept -> operation_stats const& {
+			return operations[static_cast<std::size_t>(op)];
+		}
+
+		// one line per operation that was called
+		friend auto operator<<(std::ostream& os, snapshot const& snap) -> std::ostream& {
+			for (auto i = std::size_t{0}; i < operation_count; ++i) {
+				auto const& stats = snap.operations[i];
+				if (stats.calls == 0) {
+					continue;
+				}
+				os << to_string(static_cast<operation>(i)) << " calls=" << stats.calls
+				   << " allocations=" << stats.allocations << " comparisons=" << stats.comparisons
+				   << " p50<=" << stats.percentile(0.5) << "ns p99<=" << stats.percentile(0.99)
+				   << "ns max<=" << stats.percentile(1.0) << "ns\n";
+			}
+			return os;
+		}
+	};
+
+	// instrumentation compiled out
+	struct null_policy {
+		static constexpr bool enabled = false;
+
+		class scope {
+		public:
+			explicit scope(operation /*op*/) noexcept {}
+		};
+
+		static auto count_allocation() noexcept -> void {}
+		static auto count_comparison() noexcept -> void {}
+
+		[[nodiscard]] static auto take_snapshot() noexcept -> snapshot {
+			return {};
+		}
+		static auto reset() noexcept -> void {}
+	};
+
+	// process wide relaxed atomic counters, attributed to the innermost operation running on the
+	// calling thread
+	struct counting_policy {
+		static constexpr bool enabled = true;
+
+		class scope {
+		public:
+			explicit scope(operation op) noexcept
+			: op_(op)
+			, outer_(current())
+			, start_(std::chrono::steady_clock::now()) {
+				current() = static_cast<std::size_t>(op);
+				slot(op).calls.fetch_add(1, std::memory_order_relaxed);
+			}
+
+			scope(scope const&) = delete;
+			auto operator=(scope const&) -> scope& = delete;
+
+			~scope() {
+				auto const elapsed = std::chrono::steady_clock::now() - start_;
+				auto const ns = static_cast<std::uint64_t>(
+				   std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count());
+				auto const bucket = std::min<std::size_t>(static_cast<std::size_t>(std::bit_width(ns)),
+				                                          histogram_buckets - 1);
+				slot(op_).latency_ns[bucket].fetch_add(1, std::memory_order_relaxed);
+				current() = outer_;
+			}
+
+		private:
+			operation op_;
+			std::size_t outer_;
+			std::chrono::steady_clock::time_point start_;
+		};
+
+		static auto count_allocation() noexcept -> void {
+			if (auto op = current(); op != idle) {
+				counters()[op].allocations.fetch_add(1, std::memory_order_relaxed);
+			}
+		}
+
+		static auto count_comparison() noexcept -> void {
+			if (auto op = current(); op != idle) {
+				counters()[op].comparisons.fetch_add(1, std::memory_order_relaxed);
+			}
+		}
+
+		[[nodiscard]] static auto take_snapshot() noexcept -> snapshot {
+			auto snap = snapshot{};
+			for (auto i = std::size_t{0}; i < operation_count; ++i) {
+				auto const& from = counters()[i];
+				auto& to = snap.operations[i];
+				to.calls = from.calls.load(std::memory_order_relaxed);
+				to.allocations = from.allocations.load(std::memory_order_relaxed);
+				to.comparisons = from.comparisons.load(std::memory_order_relaxed);
+				for (auto b = std::size_t{0}; b < histogram_buckets; ++b) {
+					to.latency_ns[b] = from.latency_ns[b].load(std::memory_order_relaxed);
+				}
+			}
+			return snap;
+		}
+
+		static auto reset() noexcept -> void {
+			for (auto& slot : counters()) {
+				slot.calls.store(0, std::memory_order_relaxed);
+				slot.allocations.store(0, std::memory_order_relaxed);
+				slot.comparisons.store(0, std::memory_order_relaxed);
+				for (auto& bucket : slot.latency_ns) {
+					bucket.store(0, std::memory_order_relaxed);
+				}
+			}
+		}
+
+	private:
+		static constexpr auto idle = operation_count;
+
+		struct atomic_stats {
+			std::atomic<std::uint64_t> calls{0};
+			std::atomic<std::uint64_t> allocations{0};
+			std::atomic<std::uint64_t> comparisons{0};
+			std::array<std::atomic<std::uint64_t>, histogram_buckets> latency_ns{};
+		};
+
+		static auto counters() noexcept -> std::array<atomic_stats, operation_count>& {
+			static auto stats = std::array<atomic_stats, operation_count>{};
+			return stats;
+		}
+
+		static auto slot(operation op) noexcept -> atomic_stats& {
+			return counters()[static_cast<std::size_t>(op)];
+		}
+
+		static auto current() noexcept -> std::size_t& {
+			thread_local auto op = idle;
+			return op;
+		}
+	};
+
+	using policy = std::conditional_t<GDWG_INSTRUMENTATION != 0, counting_policy, null_policy>;
+
+	// counters gathered so far, all zero when instrumentation is compiled out
+	[[nodiscard]] inline auto take_snapshot() noexcept -> snapshot {
+		return policy::take_snapshot();
+	}
+
+	inline auto reset() noexcept -> void {
+		policy::reset();
+	}
+} // namespace gdwg::instrumentation
+
+#endif // GDWG_INSTRUMENTATION_HPP
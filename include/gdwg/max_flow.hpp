@@ -0,0 +1,369 @@
+#ifndef GDWG_MAX_FLOW_HPP
+#define GDWG_MAX_FLOW_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "gdwg/frozen_graph.hpp"
+#include "gdwg/trace.hpp"
+
+// Maximum flow and minimum cut with edge weights as capacities, by push-relabel with the highest
+// label rule. Parallel edges between the same two nodes are summed into one arc, and every arc
+// and its reverse live in flat arrays grouped by tail node, so the solver never touches the
+// graph's maps. Two heuristics keep the number of relabels down: a periodic global relabel sets
+// every label to the exact residual distance to the sink by one backwards breadth first search,
+// and when relabelling empties a label every node above it is cut off from the sink and lifted
+// out of the way at once.
+//
+// Only the first phase runs, which finds the flow's value and the cut. The second phase, which
+// returns surplus preflow to the source to make an actual flow, would only matter for reporting
+// flow per edge.
+
+namespace gdwg {
+	// what capacities are summed in, wide enough that adding up edges won't overflow
+	template<typename E>
+	using flow_t = std::conditional_t<std::is_integral_v<E>, std::int64_t, double>;
+
+	template<typename E>
+	struct max_flow_result {
+		using node_id = std::uint32_t;
+
+		// an edge across the cut, with parallel edges summed
+		struct cut_edge {
+			node_id src;
+			node_id dst;
+			flow_t<E> capacity;
+		};
+
+		flow_t<E> flow = 0;
+		// source_side[id] is 1 for the nodes that can no longer reach the sink, which makes this
+		// the minimum cut closest to the sink
+		std::vector<std::uint8_t> source_side;
+		// every edge from the source side to the sink side, their capacities add up to flow
+		std::vector<cut_edge> cut;
+	};
+
+	namespace detail {
+		template<typename F>
+		class push_relabel {
+		public:
+			using node_id = std::uint32_t;
+
+			struct edge {
+				node_id src;
+				node_id dst;
+				F capacity;
+			};
+
+			// edges must have src != dst and be summed already
+			push_relabel(std::size_t n, std::vector<edge> const& edges)
+			: n_(n)
+			, first_(n + 1, 0) {
+				for (auto const& e : edges) {
+					++first_[e.src + 1];
+					++first_[e.dst + 1];
+				}
+				for (auto v = std::size_t{0}; v < n; ++v) {
+					first_[v + 1] += first_[v];
+				}
+				auto fill = std::vector<std::size_t>(first_.begin(), first_.end() - 1);
+				head_.resize(first_[n]);
+				residual_.resize(first_[n]);
+				reverse_.resize(first_[n]);
+				for (auto const& e : edges) {
+					auto const forward = fill[e.src]++;
+					auto const backward = fill[e.dst]++;
+					head_[forward] = e.dst;
+					residual_[forward] = e.capacity;
+					reverse_[forward] = backward;
+					head_[backward] = e.src;
+					residual_[backward] = 0;
+					reverse_[backward] = forward;
+				}
+			}
+
+			auto run(node_id source, node_id sink) -> F {
+				source_ = source;
+				sink_ = sink;
+				label_.assign(n_, 0);
+				excess_.assign(n_, 0);
+				current_.assign(first_.begin(), first_.end() - 1);
+				active_head_.assign(n_ + 1, none);
+				active_next_.assign(n_, none);
+				all_head_.assign(n_ + 1, none);
+				all_next_.assign(n_, none);
+				all_prev_.assign(n_, none);
+
+				for (auto a = first_[source]; a < first_[source + 1]; ++a) {
+					auto const amount = residual_[a];
+					if (amount > 0) {
+						residual_[a] = 0;
+						residual_[reverse_[a]] += amount;
+						excess_[head_[a]] += amount;
+						excess_[source] -= amount;
+					}
+				}
+				global_relabel();
+
+				auto const relabel_every = 6 * n_ + head_.size() / 2;
+				while (highest_active_ != none) {
+					auto const v = active_head_[highest_active_];
+					if (v == none) {
+						--highest_active_;
+						continue;
+					}
+					active_head_[highest_active_] = active_next_[v];
+					discharge(v);
+					if (work_ > relabel_every) {
+						global_relabel();
+					}
+				}
+				return excess_[sink];
+			}
+
+			// nodes that can't reach the sink in what is left of the graph
+			auto source_side() const -> std::vector<std::uint8_t> {
+				auto side = std::vector<std::uint8_t>(n_, 1);
+				auto queue = std::vector<node_id>{sink_};
+				side[sink_] = 0;
+				for (auto i = std::size_t{0}; i < queue.size(); ++i) {
+					auto const w = queue[i];
+					for (auto a = first_[w]; a < first_[w + 1]; ++a) {
+						auto const u = head_[a];
+						if (side[u] != 0 && residual_[reverse_[a]] > 0) {
+							side[u] = 0;
+							queue.push_back(u);
+						}
+					}
+				}
+				return side;
+			}
+
+		private:
+			static constexpr auto none = ~node_id{0};
+
+			std::size_t n_;
+			node_id source_ = 0;
+			node_id sink_ = 0;
+			// arcs of node v are first_[v] to first_[v + 1], each paired with its reverse
+			std::vector<std::size_t> first_;
+			std::vector<node_id> head_;
+			std::vector<F> residual_;
+			std::vector<std::size_t> reverse_;
+
+			std::vector<node_id> label_;
+			std::vector<F> excess_;
+			// the next arc discharge looks at for each node
+			std::vector<std::size_t> current_;
+			// active nodes by label, singly linked
+			std::vector<node_id> active_head_;
+			std::vector<node_id> active_next_;
+			// every node below n by label, doubly linked for the gap heuristic
+			std::vector<node_id> all_head_;
+			std::vector<node_id> all_next_;
+			std::vector<node_id> all_prev_;
+			node_id highest_active_ = none;
+			node_id highest_label_ = 0;
+			// arcs scanned and relabels since the last global relabel
+			std::size_t work_ = 0;
+
+			auto activate(node_id v) noexcept -> void {
+				auto const d = label_[v];
+				active_next_[v] = active_head_[d];
+				active_head_[d] = v;
+				if (highest_active_ == none || d > highest_active_) {
+					highest_active_ = d;
+				}
+			}
+
+			auto link(node_id v) noexcept -> void {
+				auto const d = label_[v];
+				all_prev_[v] = none;
+				all_next_[v] = all_head_[d];
+				if (all_head_[d] != none) {
+					all_prev_[all_head_[d]] = v;
+				}
+				all_head_[d] = v;
+				highest_label_ = std::max(highest_label_, d);
+			}
+
+			auto unlink(node_id v) noexcept -> void {
+				if (all_prev_[v] != none) {
+					all_next_[all_prev_[v]] = all_next_[v];
+				}
+				else {
+					all_head_[label_[v]] = all_next_[v];
+				}
+				if (all_next_[v] != none) {
+					all_prev_[all_next_[v]] = all_prev_[v];
+				}
+			}
+
+			// exact distances to the sink, by breadth first search backwards along residual arcs
+			auto global_relabel() -> void {
+				work_ = 0;
+				auto const far = static_cast<node_id>(n_);
+				std::fill(label_.begin(), label_.end(), far);
+				std::fill(active_head_.begin(), active_head_.end(), none);
+				std::fill(all_head_.begin(), all_head_.end(), none);
+				highest_active_ = none;
+				highest_label_ = 0;
+
+				auto queue = std::vector<node_id>{sink_};
+				label_[sink_] = 0;
+				for (auto i = std::size_t{0}; i < queue.size(); ++i) {
+					auto const w = queue[i];
+					link(w);
+					if (excess_[w] > 0 && w != sink_) {
+						activate(w);
+					}
+					for (auto a = first_[w]; a < first_[w + 1]; ++a) {
+						auto const u = head_[a];
+						if (label_[u] == far && u != source_ && residual_[reverse_[a]] > 0) {
+							label_[u] = label_[w] + 1;
+							current_[u] = first_[u];
+							queue.push_back(u);
+						}
+					}
+				}
+			}
+
+			auto discharge(node_id v) -> void {
+				auto const far = static_cast<node_id>(n_);
+				while (excess_[v] > 0) {
+					auto const end = first_[v + 1];
+					auto a = current_[v];
+					for (; a < end && excess_[v] > 0; ++a) {
+						auto const w = head_[a];
+						if (residual_[a] <= 0 || label_[w] + 1 != label_[v]) {
+							continue;
+						}
+						auto const amount = std::min(excess_[v], residual_[a]);
+						if (excess_[w] == 0 && w != sink_) {
+							activate(w);
+						}
+						residual_[a] -= amount;
+						residual_[reverse_[a]] += amount;
+						excess_[v] -= amount;
+						excess_[w] += amount;
+						if (excess_[v] == 0) {
+							break;
+						}
+					}
+					work_ += a - current_[v];
+					current_[v] = a;
+					if (excess_[v] == 0) {
+						return;
+					}
+
+					// relabel, or cut off everything above v's label if v was the last one on it
+					auto const old = label_[v];
+					unlink(v);
+					if (all_head_[old] == none) {
+						gap(old);
+						label_[v] = far;
+						return;
+					}
+					auto lowest = far;
+					for (auto b = first_[v]; b < end; ++b) {
+						if (residual_[b] > 0) {
+							lowest = std::min(lowest, label_[head_[b]] + 1);
+						}
+					}
+					work_ += 12 + (end - first_[v]);
+					label_[v] = lowest;
+					current_[v] = first_[v];
+					if (lowest >= far) {
+						return;
+					}
+					link(v);
+				}
+			}
+
+			// nothing above label can reach the sink any more
+			auto gap(node_id label) noexcept -> void {
+				auto const far = static_cast<node_id>(n_);
+				for (auto d = label + 1; d <= highest_label_; ++d) {
+					for (auto v = all_head_[d]; v != none; v = all_next_[v]) {
+						label_[v] = far;
+					}
+					all_head_[d] = none;
+					active_head_[d] = none;
+				}
+				highest_label_ = label == 0 ? 0 : label - 1;
+				if (highest_active_ != none && highest_active_ > highest_label_) {
+					highest_active_ = highest_label_;
+				}
+			}
+		};
+	} // namespace detail
+
+	// the most flow that can go from source to sink, and a minimum cut separating them
+	template<typename N, typename E>
+	auto max_flow(frozen_graph<N, E> const& g, std::uint32_t source, std::uint32_t sink)
+	   -> max_flow_result<E> {
+		[[maybe_unused]] auto const span = trace::span("gdwg::max_flow");
+		using solver = detail::push_relabel<flow_t<E>>;
+		auto const n = g.num_nodes();
+		if (source >= n || sink >= n) {
+			throw std::runtime_error("Cannot call gdwg::max_flow if source or sink don't exist in "
+			                         "the graph");
+		}
+		if (source == sink) {
+			throw std::runtime_error("Cannot call gdwg::max_flow with the same source and sink");
+		}
+
+		// rows are sorted by target, so parallel edges sit next to each other
+		auto edges = std::vector<typename solver::edge>();
+		for (auto u = std::uint32_t{0}; u < n; ++u) {
+			auto const targets = g.out_neighbors(u);
+			auto const weights = g.out_weights(u);
+			for (auto i = std::size_t{0}; i < targets.size(); ++i) {
+				auto const capacity = static_cast<flow_t<E>>(weights[i]);
+				if (capacity < 0) {
+					throw std::runtime_error("Cannot call gdwg::max_flow with a negative capacity");
+				}
+				if (targets[i] == u) {
+					continue;
+				}
+				if (!edges.empty() && edges.back().src == u && edges.back().dst == targets[i]) {
+					edges.back().capacity += capacity;
+				}
+				else {
+					edges.push_back({u, targets[i], capacity});
+				}
+			}
+		}
+
+		auto flow = solver(n, edges);
+		auto result = max_flow_result<E>();
+		result.flow = flow.run(source, sink);
+		result.source_side = flow.source_side();
+		for (auto const& e : edges) {
+			if (result.source_side[e.src] != 0 && result.source_side[e.dst] == 0 && e.capacity > 0) {
+				result.cut.push_back({e.src, e.dst, e.capacity});
+			}
+		}
+		return result;
+	}
+
+	// node ids line up with g.nodes()
+	template<typename N, typename E>
+	auto max_flow(graph<N, E> const& g, N const& source, N const& sink) -> max_flow_result<E> {
+		auto const frozen = frozen_graph<N, E>(g);
+		auto const from = frozen.find(source);
+		auto const to = frozen.find(sink);
+		if (!from || !to) {
+			throw std::runtime_error("Cannot call gdwg::max_flow if source or sink don't exist in "
+			                         "the graph");
+		}
+		return max_flow(frozen, *from, *to);
+	}
+} // namespace gdwg
+
+#endif // GDWG_MAX_FLOW_HPP
@@ -0,0 +1,239 @@
+#ifndef GDWG_NEIGHBORHOOD_HPP
+#define GDWG_NEIGHBORHOOD_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <numeric>
+#include <optional>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "gdwg/detail/parallel.hpp"
+#include "gdwg/detail/simd.hpp"
+#include "gdwg/frozen_graph.hpp"
+#include "gdwg/trace.hpp"
+
+// Queries about shared neighbours. neighbor_sets keeps every node's distinct outgoing
+// neighbours, the same sets connections() returns, as ascending ids in one array, so comparing
+// two of them is a vector intersection with no allocation. triangle_count() looks at the graph
+// with edge directions, self loops and repeated weights ignored.
+
+namespace gdwg {
+	template<typename N, typename E>
+	class neighbor_sets {
+	public:
+		using node_id = std::uint32_t;
+
+		neighbor_sets() = default;
+
+		explicit neighbor_sets(graph<N, E> const& g)
+		: neighbor_sets(frozen_graph<N, E>(g)) {}
+
+		explicit neighbor_sets(frozen_graph<N, E> const& g)
+		: nodes_(g.nodes())
+		, sorted_(g.order() == node_order::sorted) {
+			[[maybe_unused]] auto const span = trace::span("gdwg::neighbor_sets::build");
+			offsets_.reserve(nodes_.size() + 1);
+			for (auto v = node_id{0}; v < nodes_.size(); ++v) {
+				// rows are sorted by id, so repeats from several weights sit together
+				auto const row = g.out_neighbors(v);
+				std::unique_copy(row.begin(), row.end(), std::back_inserter(targets_));
+				offsets_.push_back(targets_.size());
+			}
+			targets_.shrink_to_fit();
+			if (!sorted_) {
+				by_value_.resize(nodes_.size());
+				std::iota(by_value_.begin(), by_value_.end(), node_id{0});
+				std::sort(by_value_.begin(), by_value_.end(), [&](node_id left, node_id right) {
+					return nodes_[left] < nodes_[right];
+				});
+			}
+		}
+
+		// nodes both a and b have an edge to, ascending
+		[[nodiscard]] auto common_neighbors(N const& a, N const& b) const -> std::vector<N> {
+			auto const [left, right] = rows(a, b, "common_neighbors");
+			auto common = std::vector<node_id>(std::min(left.size(), right.size()));
+			common.resize(detail::intersect(left, right, common.data()));
+			auto res_vector = std::vector<N>();
+			res_vector.reserve(common.size());
+			for (auto id : common) {
+				res_vector.push_back(nodes_[id]);
+			}
+			if (!sorted_) {
+				std::sort(res_vector.begin(), res_vector.end());
+			}
+			return res_vector;
+		}
+
+		[[nodiscard]] auto count_common_neighbors(N const& a, N const& b) const -> std::size_t {
+			auto const [left, right] = rows(a, b, "count_common_neighbors");
+			return detail::intersect(left, right);
+		}
+
+		// shared neighbours over all neighbours of either, 0 when neither has any
+		[[nodiscard]] auto jaccard(N const& a, N const& b) const -> double {
+			auto const [left, right] = rows(a, b, "jaccard");
+			auto const shared = detail::intersect(left, right);
+			auto const either = left.size() + right.size() - shared;
+			return either == 0 ? 0.0 : static_cast<double>(shared) / static_cast<double>(either);
+		}
+
+		// a's distinct outgoing neighbours as ascending ids
+		[[nodiscard]] auto neighbors(node_id a) const noexcept -> std::span<node_id const> {
+			return std::span<node_id const>(targets_.data() + offsets_[a],
+			                                offsets_[a + 1] - offsets_[a]);
+		}
+
+	private:
+		struct row_pair {
+			std::span<node_id const> left;
+			std::span<node_id const> right;
+		};
+
+		std::vector<N> nodes_;
+		bool sorted_ = true;
+		std::vector<node_id> by_value_;
+		std::vector<std::size_t> offsets_{0};
+		std::vector<node_id> targets_;
+
+		auto find(N const& value) const -> std::optional<node_id> {
+			if (sorted_) {
+				auto found = std::lower_bound(nodes_.begin(), nodes_.end(), value);
+				if (found == nodes_.end() || value < *found) {
+					return std::nullopt;
+				}
+				return static_cast<node_id>(found - nodes_.begin());
+			}
+			auto found = std::lower_bound(by_value_.begin(),
+			                              by_value_.end(),
+			                              value,
+			                              [&](node_id id, N const& v) { return nodes_[id] < v; });
+			if (found == by_value_.end() || value < nodes_[*found]) {
+				return std::nullopt;
+			}
+			return *found;
+		}
+
+		auto rows(N const& a, N const& b, char const* caller) const -> row_pair {
+			auto const left = find(a);
+			auto const right = find(b);
+			if (!left || !right) {
+				throw std::runtime_error(std::string("Cannot call gdwg::neighbor_sets<N, E>::") + caller
+				                         + " if a or b node don't exist in the graph");
+			}
+			return {neighbors(*left), neighbors(*right)};
+		}
+	};
+
+	namespace detail {
+		// the undirected simple graph underneath a frozen_graph, every row ascending
+		struct undirected_rows {
+			using node_id = std::uint32_t;
+
+			std::vector<std::size_t> offsets{0};
+			std::vector<node_id> targets;
+
+			[[nodiscard]] auto size() const noexcept -> std::size_t {
+				return offsets.size() - 1;
+			}
+
+			[[nodiscard]] auto row(node_id v) const noexcept -> std::span<node_id const> {
+				return {targets.data() + offsets[v], offsets[v + 1] - offsets[v]};
+			}
+
+			[[nodiscard]] auto degree(node_id v) const noexcept -> std::size_t {
+				return offsets[v + 1] - offsets[v];
+			}
+		};
+
+		// both directions merged, with repeats and self loops dropped
+		template<typename N, typename E>
+		auto make_undirected_rows(frozen_graph<N, E> const& g) -> undirected_rows {
+			using node_id = undirected_rows::node_id;
+			auto const n = g.num_nodes();
+			auto rows = undirected_rows{};
+			rows.offsets.reserve(n + 1);
+			rows.targets.reserve(2 * g.num_edges());
+			for (auto v = node_id{0}; v < n; ++v) {
+				auto const begin = rows.targets.size();
+				auto const out = g.out_neighbors(v);
+				auto const in = g.in_neighbors(v);
+				auto const into = std::back_inserter(rows.targets);
+				std::set_union(out.begin(), out.end(), in.begin(), in.end(), into);
+				auto const first = rows.targets.begin() + static_cast<std::ptrdiff_t>(begin);
+				rows.targets.erase(std::unique(first, rows.targets.end()), rows.targets.end());
+				rows.targets.erase(std::remove(first, rows.targets.end(), v), rows.targets.end());
+				rows.offsets.push_back(rows.targets.size());
+			}
+			rows.targets.shrink_to_fit();
+			return rows;
+		}
+
+		// Every edge is kept only at the end lower(v, w) ranks first, so each triangle is found
+		// once, from its lowest corner. Nodes are handed to threads in small blocks, since their
+		// work varies widely
+		template<typename Lower>
+		auto count_triangles(undirected_rows const& rows, Lower lower, std::size_t threads)
+		   -> std::uint64_t {
+			using node_id = undirected_rows::node_id;
+			auto const n = rows.size();
+			auto oriented = undirected_rows{};
+			oriented.offsets.reserve(n + 1);
+			for (auto v = node_id{0}; v < n; ++v) {
+				for (auto w : rows.row(v)) {
+					if (lower(v, w)) {
+						oriented.targets.push_back(w);
+					}
+				}
+				oriented.offsets.push_back(oriented.targets.size());
+			}
+
+			constexpr auto block = std::size_t{64};
+			auto next = std::atomic<std::size_t>(0);
+			auto total = std::atomic<std::uint64_t>(0);
+			auto const workers = resolve_threads(threads);
+			parallel_for(workers, workers, [&](std::size_t, std::size_t, std::size_t) {
+				auto mine = std::uint64_t{0};
+				for (auto begin = next.fetch_add(block); begin < n; begin = next.fetch_add(block)) {
+					for (auto v = static_cast<node_id>(begin); v < std::min(begin + block, n); ++v) {
+						auto const higher = oriented.row(v);
+						for (auto w : higher) {
+							mine += intersect(higher, oriented.row(w));
+						}
+					}
+				}
+				total.fetch_add(mine, std::memory_order_relaxed);
+			});
+			return total.load();
+		}
+	} // namespace detail
+
+	// Triangles in the undirected simple graph underneath g. Edges are oriented towards the end
+	// with the higher (degree, id), so no node keeps more than about sqrt(2E) neighbours however
+	// skewed the degrees are
+	template<typename N, typename E>
+	auto triangle_count(frozen_graph<N, E> const& g, std::size_t threads = 0) -> std::uint64_t {
+		using node_id = std::uint32_t;
+		[[maybe_unused]] auto const span = trace::span("gdwg::triangle_count");
+		auto const rows = detail::make_undirected_rows(g);
+		auto const lower = [&](node_id left, node_id right) {
+			auto const l = rows.degree(left);
+			auto const r = rows.degree(right);
+			return l < r || (l == r && left < right);
+		};
+		return detail::count_triangles(rows, lower, threads);
+	}
+
+	template<typename N, typename E>
+	auto triangle_count(graph<N, E> const& g, std::size_t threads = 0) -> std::uint64_t {
+		return triangle_count(frozen_graph<N, E>(g), threads);
+	}
+} // namespace gdwg
+
+#endif // GDWG_NEIGHBORHOOD_HPP
@@ -0,0 +1,200 @@
+#ifndef GDWG_PAGERANK_HPP
+#define GDWG_PAGERANK_HPP
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include "gdwg/detail/parallel.hpp"
+#include "gdwg/detail/simd.hpp"
+#include "gdwg/frozen_graph.hpp"
+#include "gdwg/trace.hpp"
+
+// PageRank over a frozen_graph, following each edge with probability proportional to its weight.
+// Updates pull along incoming rows, so each node's new rank is written by one thread and no
+// atomics are needed, and the weighted sum over a row is one vector gather_dot. Rank held by
+// nodes without outgoing weight is spread by the teleport distribution, uniform for pagerank()
+// and the given one for personalized_pagerank(). The graph overloads freeze the graph first, so
+// ranks line up with g.nodes().
+
+namespace gdwg {
+	struct pagerank_options {
+		// probability of following an edge rather than teleporting
+		double damping = 0.85;
+		// stop once the L1 change in ranks over an iteration is below this
+		double tolerance = 1e-9;
+		std::size_t max_iterations = 100;
+		// 0 means one per hardware thread
+		std::size_t threads = 0;
+	};
+
+	struct pagerank_result {
+		// rank[id] for every node id, summing to 1
+		std::vector<double> rank;
+		std::size_t iterations = 0;
+		// L1 change in ranks over the last iteration
+		double residual = 0;
+		bool converged = true;
+	};
+
+	namespace detail {
+		// incoming rows with each weight turned into the share of its source's outgoing weight
+		struct pull_matrix {
+			std::vector<std::size_t> offsets;
+			std::vector<std::uint32_t> sources;
+			std::vector<double> coef;
+			// nodes with no outgoing weight
+			std::vector<std::uint32_t> dangling;
+		};
+
+		template<typename N, typename E>
+		auto make_pull_matrix(frozen_graph<N, E> const& g) -> pull_matrix {
+			auto const n = g.num_nodes();
+			auto out_weight = std::vector<double>(n);
+			for (auto v = std::uint32_t{0}; v < n; ++v) {
+				for (auto const& weight : g.out_weights(v)) {
+					auto const w = static_cast<double>(weight);
+					if (w < 0) {
+						throw std::runtime_error("Cannot call gdwg::pagerank with a negative edge "
+						                         "weight");
+					}
+					out_weight[v] += w;
+				}
+			}
+
+			auto matrix = pull_matrix{};
+			auto const offsets = g.in_offsets();
+			auto const sources = g.in_sources();
+			matrix.offsets.assign(offsets.begin(), offsets.end());
+			matrix.sources.assign(sources.begin(), sources.end());
+			matrix.coef.resize(sources.size());
+			for (auto v = std::uint32_t{0}; v < n; ++v) {
+				auto const weights = g.in_weights(v);
+				for (auto e = offsets[v]; e < offsets[v + 1]; ++e) {
+					auto const total = out_weight[sources[e]];
+					matrix.coef[e] = total > 0 ? static_cast<double>(weights[e - offsets[v]]) / total
+					                           : 0.0;
+				}
+				if (out_weight[v] <= 0) {
+					matrix.dangling.push_back(v);
+				}
+			}
+			return matrix;
+		}
+
+		inline auto power_iterate(pull_matrix const& matrix,
+		                          std::vector<double> const& teleport,
+		                          pagerank_options const& options) -> pagerank_result {
+			auto const n = teleport.size();
+			auto const d = options.damping;
+			auto result = pagerank_result{teleport, 0, 0, n == 0};
+			auto next = std::vector<double>(n);
+			auto const threads =
+			   std::min(resolve_threads(options.threads), std::max<std::size_t>(n, 1));
+			auto partial = std::vector<double>(threads);
+
+			while (n != 0 && result.iterations < options.max_iterations) {
+				auto const& rank = result.rank;
+				auto leaked = 0.0;
+				for (auto v : matrix.dangling) {
+					leaked += rank[v];
+				}
+				parallel_for(n, threads, [&](std::size_t begin, std::size_t end, std::size_t index) {
+					auto change = 0.0;
+					for (auto v = begin; v < end; ++v) {
+						auto const first = matrix.offsets[v];
+						auto const pulled = gather_dot(rank.data(),
+						                               matrix.sources.data() + first,
+						                               matrix.coef.data() + first,
+						                               matrix.offsets[v + 1] - first);
+						next[v] = (1 - d + d * leaked) * teleport[v] + d * pulled;
+						change += std::abs(next[v] - rank[v]);
+					}
+					partial[index] = change;
+				});
+
+				result.rank.swap(next);
+				++result.iterations;
+				result.residual = 0;
+				for (auto& change : partial) {
+					result.residual += change;
+					change = 0;
+				}
+				if (result.residual < options.tolerance) {
+					result.converged = true;
+					break;
+				}
+			}
+			return result;
+		}
+
+		inline auto check_damping(pagerank_options const& options) -> void {
+			if (!(options.damping >= 0 && options.damping <= 1)) {
+				throw std::runtime_error("Cannot call gdwg::pagerank with a damping factor outside "
+				                         "[0, 1]");
+			}
+		}
+	} // namespace detail
+
+	template<typename N, typename E>
+	auto pagerank(frozen_graph<N, E> const& g, pagerank_options const& options = {})
+	   -> pagerank_result {
+		[[maybe_unused]] auto const span = trace::span("gdwg::pagerank");
+		detail::check_damping(options);
+		auto const n = g.num_nodes();
+		auto const teleport = std::vector<double>(n, n == 0 ? 0.0 : 1.0 / static_cast<double>(n));
+		return detail::power_iterate(detail::make_pull_matrix(g), teleport, options);
+	}
+
+	template<typename N, typename E>
+	auto pagerank(graph<N, E> const& g, pagerank_options const& options = {}) -> pagerank_result {
+		return pagerank(frozen_graph<N, E>(g), options);
+	}
+
+	// PageRank that teleports only to the given nodes, in proportion to their weights, so ranks
+	// measure closeness to them
+	template<typename N, typename E>
+	auto personalized_pagerank(frozen_graph<N, E> const& g,
+	                           std::map<N, double> const& personalization,
+	                           pagerank_options const& options = {}) -> pagerank_result {
+		[[maybe_unused]] auto const span = trace::span("gdwg::personalized_pagerank");
+		detail::check_damping(options);
+		auto teleport = std::vector<double>(g.num_nodes());
+		auto total = 0.0;
+		for (auto const& [node, weight] : personalization) {
+			auto const id = g.find(node);
+			if (!id) {
+				throw std::runtime_error("Cannot call gdwg::personalized_pagerank if a personalised "
+				                         "node doesn't exist in the graph");
+			}
+			if (!(weight >= 0)) {
+				throw std::runtime_error("Cannot call gdwg::personalized_pagerank with a negative "
+				                         "personalisation weight");
+			}
+			teleport[*id] = weight;
+			total += weight;
+		}
+		if (!(total > 0)) {
+			throw std::runtime_error("Cannot call gdwg::personalized_pagerank without a positive "
+			                         "personalisation weight");
+		}
+		for (auto& share : teleport) {
+			share /= total;
+		}
+		return detail::power_iterate(detail::make_pull_matrix(g), teleport, options);
+	}
+
+	template<typename N, typename E>
+	auto personalized_pagerank(graph<N, E> const& g,
+	                           std::map<N, double> const& personalization,
+	                           pagerank_options const& options = {}) -> pagerank_result {
+		return personalized_pagerank(frozen_graph<N, E>(g), personalization, options);
+	}
+} // namespace gdwg
+
+#endif // GDWG_PAGERANK_HPP
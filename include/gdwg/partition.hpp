@@ -0,0 +1,348 @@
+#ifndef GDWG_PARTITION_HPP
+#define GDWG_PARTITION_HPP
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <numeric>
+#include <random>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include "gdwg/frozen_graph.hpp"
+#include "gdwg/trace.hpp"
+
+// Splits the nodes of a graph into parts of about equal size with few edges between parts, for
+// spreading a graph over several processes. Edge directions are ignored and a pair of nodes
+// joined by several edges is held together that many times harder. Parts are numbered
+// 0..parts-1 and indexed by frozen_graph id, so the graph overloads line up with g.nodes().
+
+namespace gdwg {
+	enum class partition_method {
+		// a scrambled node id, balanced but blind to the edges
+		hash,
+		// starts from hash, then moves each node to the part most of its neighbours are in
+		label_propagation,
+		// coarsens by heavy edge matching, grows parts on the coarsest graph, then refines each
+		// level on the way back up, as METIS does
+		multilevel,
+	};
+
+	struct partition_options {
+		partition_method method = partition_method::multilevel;
+		// a part may hold up to (1 + imbalance) times its share of the nodes
+		double imbalance = 0.05;
+		// refinement passes per level, each stops early once no node moves
+		std::size_t rounds = 10;
+		std::uint64_t seed = 0x5eed;
+	};
+
+	struct partitioning {
+		// part[id] for every node id
+		std::vector<std::uint32_t> part;
+		std::uint32_t parts = 0;
+		// edges, one per weight, whose ends are in different parts
+		std::size_t edge_cut = 0;
+	};
+
+	namespace detail {
+		using part_id = std::uint32_t;
+
+		// undirected graph with node and edge weights, without self loops
+		struct weighted_graph {
+			std::vector<std::size_t> offsets{0};
+			std::vector<std::uint32_t> adjacent;
+			std::vector<std::uint64_t> edge_weight;
+			std::vector<std::uint64_t> node_weight;
+
+			[[nodiscard]] auto size() const noexcept -> std::size_t {
+				return node_weight.size();
+			}
+		};
+
+		template<typename N, typename E>
+		auto undirected_weighted(frozen_graph<N, E> const& g) -> weighted_graph {
+			auto const n = g.num_nodes();
+			auto res = weighted_graph{};
+			res.node_weight.assign(n, 1);
+			auto ends = std::vector<std::uint32_t>();
+			for (auto v = std::uint32_t{0}; v < n; ++v) {
+				ends.clear();
+				auto const out = g.out_neighbors(v);
+				auto const in = g.in_neighbors(v);
+				std::merge(out.begin(), out.end(), in.begin(), in.end(), std::back_inserter(ends));
+				for (auto i = std::size_t{0}; i < ends.size();) {
+					auto j = i;
+					while (j < ends.size() && ends[j] == ends[i]) {
+						++j;
+					}
+					if (ends[i] != v) {
+						res.adjacent.push_back(ends[i]);
+						res.edge_weight.push_back(j - i);
+					}
+					i = j;
+				}
+				res.offsets.push_back(res.adjacent.size());
+			}
+			return res;
+		}
+
+		inline auto scramble(std::uint64_t x) noexcept -> std::uint64_t {
+			x += 0x9e3779b97f4a7c15U;
+			x = (x ^ (x >> 30U)) * 0xbf58476d1ce4e5b9U;
+			x = (x ^ (x >> 27U)) * 0x94d049bb133111ebU;
+			return x ^ (x >> 31U);
+		}
+
+		inline auto edge_cut(weighted_graph const& g, std::vector<part_id> const& part)
+		   -> std::size_t {
+			auto cut = std::uint64_t{0};
+			for (auto v = std::size_t{0}; v < g.size(); ++v) {
+				for (auto e = g.offsets[v]; e < g.offsets[v + 1]; ++e) {
+					cut += part[v] != part[g.adjacent[e]] ? g.edge_weight[e] : 0;
+				}
+			}
+			// every edge was seen from both ends
+			return static_cast<std::size_t>(cut / 2);
+		}
+
+		// Greedy moves towards the part each node is most strongly tied to, never past a part's
+		// capacity. A move that leaves the tie unchanged is only taken towards a lighter part
+		inline auto refine(weighted_graph const& g,
+		                   std::vector<part_id>& part,
+		                   part_id parts,
+		                   std::uint64_t capacity,
+		                   std::size_t rounds,
+		                   std::mt19937_64& rng) -> void {
+			auto load = std::vector<std::uint64_t>(parts);
+			for (auto v = std::size_t{0}; v < g.size(); ++v) {
+				load[part[v]] += g.node_weight[v];
+			}
+			auto order = std::vector<std::uint32_t>(g.size());
+			std::iota(order.begin(), order.end(), std::uint32_t{0});
+			auto tie = std::vector<std::uint64_t>(parts);
+			auto touched = std::vector<part_id>();
+
+			for (auto round = std::size_t{0}; round < rounds; ++round) {
+				std::shuffle(order.begin(), order.end(), rng);
+				auto moved = false;
+				for (auto v : order) {
+					auto const mine = part[v];
+					for (auto e = g.offsets[v]; e < g.offsets[v + 1]; ++e) {
+						auto const p = part[g.adjacent[e]];
+						if (tie[p] == 0) {
+							touched.push_back(p);
+						}
+						tie[p] += g.edge_weight[e];
+					}
+
+					auto best = mine;
+					for (auto p : touched) {
+						if (p == mine || load[p] + g.node_weight[v] > capacity) {
+							continue;
+						}
+						auto const lighter = load[p] + g.node_weight[v] < load[best];
+						if (tie[p] > tie[best] || (tie[p] == tie[best] && lighter)) {
+							best = p;
+						}
+					}
+					for (auto p : touched) {
+						tie[p] = 0;
+					}
+					touched.clear();
+
+					if (best != mine) {
+						load[mine] -= g.node_weight[v];
+						load[best] += g.node_weight[v];
+						part[v] = best;
+						moved = true;
+					}
+				}
+				if (!moved) {
+					return;
+				}
+			}
+		}
+
+		// Heavy edge matching: each unmatched node, in random order, pairs with the unmatched
+		// neighbour it shares the heaviest edge with. Returns the coarser graph and each node's
+		// coarse id
+		inline auto coarsen(weighted_graph const& g, std::mt19937_64& rng)
+		   -> std::pair<weighted_graph, std::vector<std::uint32_t>> {
+			constexpr auto unmatched = std::uint32_t{0xffffffff};
+			auto const n = g.size();
+			auto order = std::vector<std::uint32_t>(n);
+			std::iota(order.begin(), order.end(), std::uint32_t{0});
+			std::shuffle(order.begin(), order.end(), rng);
+
+			auto coarse_id = std::vector<std::uint32_t>(n, unmatched);
+			auto members = std::vector<std::pair<std::uint32_t, std::uint32_t>>();
+			for (auto v : order) {
+				if (coarse_id[v] != unmatched) {
+					continue;
+				}
+				auto mate = v;
+				auto heaviest = std::uint64_t{0};
+				for (auto e = g.offsets[v]; e < g.offsets[v + 1]; ++e) {
+					auto const w = g.adjacent[e];
+					if (coarse_id[w] == unmatched && g.edge_weight[e] > heaviest) {
+						mate = w;
+						heaviest = g.edge_weight[e];
+					}
+				}
+				coarse_id[v] = coarse_id[mate] = static_cast<std::uint32_t>(members.size());
+				members.emplace_back(v, mate);
+			}
+
+			auto res = weighted_graph{};
+			res.node_weight.reserve(members.size());
+			auto slot = std::vector<std::size_t>(members.size(), 0);
+			auto const none = std::size_t{0};
+			for (auto c = std::uint32_t{0}; c < members.size(); ++c) {
+				auto const row_start = res.adjacent.size();
+				auto const [a, b] = members[c];
+				auto absorb = [&](std::uint32_t v) {
+					for (auto e = g.offsets[v]; e < g.offsets[v + 1]; ++e) {
+						auto const target = coarse_id[g.adjacent[e]];
+						if (target == c) {
+							continue;
+						}
+						// slot holds one past the target's position within this row
+						if (slot[target] == none) {
+							res.adjacent.push_back(target);
+							res.edge_weight.push_back(0);
+							slot[target] = res.adjacent.size() - row_start;
+						}
+						res.edge_weight[row_start + slot[target] - 1] += g.edge_weight[e];
+					}
+				};
+				absorb(a);
+				res.node_weight.push_back(g.node_weight[a]);
+				if (b != a) {
+					absorb(b);
+					res.node_weight.back() += g.node_weight[b];
+				}
+				for (auto e = row_start; e < res.adjacent.size(); ++e) {
+					slot[res.adjacent[e]] = none;
+				}
+				res.offsets.push_back(res.adjacent.size());
+			}
+			return {std::move(res), std::move(coarse_id)};
+		}
+
+		// breadth first growth of one part at a time up to its share of what is left, the last
+		// part takes everything still unassigned
+		inline auto grow(weighted_graph const& g, part_id parts, std::mt19937_64& rng)
+		   -> std::vector<part_id> {
+			constexpr auto unassigned = std::uint32_t{0xffffffff};
+			auto const n = g.size();
+			auto part = std::vector<part_id>(n, unassigned);
+			auto order = std::vector<std::uint32_t>(n);
+			std::iota(order.begin(), order.end(), std::uint32_t{0});
+			std::shuffle(order.begin(), order.end(), rng);
+			auto remaining =
+			   std::accumulate(g.node_weight.begin(), g.node_weight.end(), std::uint64_t{0});
+
+			auto next_seed = std::size_t{0};
+			auto queue = std::vector<std::uint32_t>();
+			for (auto p = part_id{0}; p < parts; ++p) {
+				auto const target = remaining / (parts - p);
+				auto load = std::uint64_t{0};
+				queue.clear();
+				for (auto head = std::size_t{0}; load < target || p + 1 == parts;) {
+					if (head == queue.size()) {
+						while (next_seed < n && part[order[next_seed]] != unassigned) {
+							++next_seed;
+						}
+						if (next_seed == n) {
+							break;
+						}
+						queue.push_back(order[next_seed]);
+					}
+					auto const v = queue[head++];
+					if (part[v] != unassigned) {
+						continue;
+					}
+					part[v] = p;
+					load += g.node_weight[v];
+					for (auto e = g.offsets[v]; e < g.offsets[v + 1]; ++e) {
+						if (part[g.adjacent[e]] == unassigned) {
+							queue.push_back(g.adjacent[e]);
+						}
+					}
+				}
+				remaining -= std::min(load, remaining);
+			}
+			return part;
+		}
+	} // namespace detail
+
+	template<typename N, typename E>
+	auto partition(frozen_graph<N, E> const& g,
+	               std::uint32_t parts,
+	               partition_options const& options = {}) -> partitioning {
+		using detail::part_id;
+		[[maybe_unused]] auto const span = trace::span("gdwg::partition");
+		if (parts == 0) {
+			throw std::runtime_error("Cannot call gdwg::partition with 0 parts");
+		}
+		auto const n = g.num_nodes();
+		auto const level0 = detail::undirected_weighted(g);
+		auto const share = (static_cast<double>(n) / parts) * (1 + options.imbalance);
+		auto const capacity = static_cast<std::uint64_t>(std::max(1.0, std::ceil(share)));
+		auto rng = std::mt19937_64(options.seed);
+
+		auto res = partitioning{std::vector<part_id>(n), parts, 0};
+		for (auto v = std::size_t{0}; v < n; ++v) {
+			res.part[v] = static_cast<part_id>(detail::scramble(v ^ options.seed) % parts);
+		}
+
+		if (options.method == partition_method::label_propagation) {
+			detail::refine(level0, res.part, parts, capacity, options.rounds, rng);
+		}
+		else if (options.method == partition_method::multilevel && parts > 1) {
+			auto levels = std::vector<detail::weighted_graph>();
+			auto maps = std::vector<std::vector<std::uint32_t>>();
+			auto const* current = &level0;
+			auto const small_enough = std::max<std::size_t>(20 * std::size_t{parts}, 64);
+			while (current->size() > small_enough) {
+				auto [coarse, map] = detail::coarsen(*current, rng);
+				// matching has stalled, say on a star
+				if (coarse.size() * 10 > current->size() * 9) {
+					break;
+				}
+				levels.push_back(std::move(coarse));
+				maps.push_back(std::move(map));
+				current = &levels.back();
+			}
+
+			auto part = detail::grow(*current, parts, rng);
+			detail::refine(*current, part, parts, capacity, options.rounds, rng);
+			for (auto level = levels.size(); level > 0; --level) {
+				auto const& finer = level == 1 ? level0 : levels[level - 2];
+				auto const& map = maps[level - 1];
+				auto projected = std::vector<part_id>(finer.size());
+				for (auto v = std::size_t{0}; v < finer.size(); ++v) {
+					projected[v] = part[map[v]];
+				}
+				part = std::move(projected);
+				detail::refine(finer, part, parts, capacity, options.rounds, rng);
+			}
+			res.part = std::move(part);
+		}
+		res.edge_cut = detail::edge_cut(level0, res.part);
+		return res;
+	}
+
+	template<typename N, typename E>
+	auto partition(graph<N, E> const& g,
+	               std::uint32_t parts,
+	               partition_options const& options = {}) -> partitioning {
+		return partition(frozen_graph<N, E>(g), parts, options);
+	}
+} // namespace gdwg
+
+#endif // GDWG_PARTITION_HPP
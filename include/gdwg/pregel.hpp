@@ -0,0 +1,375 @@
+#ifndef GDWG_PREGEL_HPP
+#define GDWG_PREGEL_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <span>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include "gdwg/detail/parallel.hpp"
+#include "gdwg/frozen_graph.hpp"
+#include "gdwg/trace.hpp"
+
+// A bulk synchronous vertex program engine in the style of Pregel. Each superstep calls
+// compute(vertex, messages) on every node that hasn't voted to halt or has been sent a message,
+// and messages sent during one superstep are delivered at the start of the next. Nodes are split
+// into one contiguous range per thread. Each thread buffers what it sends by the range the
+// target sits in, so delivery is one pass per range with no locks, folding messages into one per
+// node with the combiner if there is one. Aggregators reduce a value over every node in a
+// superstep and show the result to every node in the next. The run ends once every node has
+// halted and no messages are in flight, or after max_supersteps.
+
+namespace gdwg {
+	struct pregel_options {
+		std::size_t max_supersteps = 100;
+		// 0 means one per hardware thread
+		std::size_t threads = 0;
+	};
+
+	struct pregel_result {
+		std::size_t supersteps = 0;
+		std::uint64_t messages = 0;
+		// every node halted with nothing left to deliver, rather than hitting max_supersteps
+		bool halted = true;
+	};
+
+	namespace detail {
+		class aggregator_slot_base {
+		public:
+			virtual ~aggregator_slot_base() = default;
+			virtual auto start(std::size_t threads) -> void = 0;
+			virtual auto finish() -> void = 0;
+		};
+
+		template<typename T>
+		class aggregator_slot final : public aggregator_slot_base {
+		public:
+			aggregator_slot(T identity, std::function<T(T const&, T const&)> reduce)
+			: identity_(std::move(identity))
+			, reduce_(std::move(reduce))
+			, current_(identity_) {}
+
+			auto start(std::size_t threads) -> void override {
+				partial_.assign(threads, identity_);
+			}
+
+			// folds every thread's share into what the next superstep sees
+			auto finish() -> void override {
+				current_ = identity_;
+				for (auto const& share : partial_) {
+					current_ = reduce_(current_, share);
+				}
+			}
+
+			auto add(std::size_t thread, T const& value) -> void {
+				partial_[thread] = reduce_(partial_[thread], value);
+			}
+
+			[[nodiscard]] auto current() const noexcept -> T const& {
+				return current_;
+			}
+
+		private:
+			T identity_;
+			std::function<T(T const&, T const&)> reduce_;
+			T current_;
+			std::vector<T> partial_;
+		};
+	} // namespace detail
+
+	// Value is each node's state and Message what nodes send each other, which must be default
+	// constructible
+	template<typename N, typename E, typename Value, typename Message>
+	class pregel {
+	public:
+		using node_id = std::uint32_t;
+
+		// handle to an aggregator, valid for the engine that made it
+		template<typename T>
+		class aggregator {
+		public:
+			aggregator() = default;
+
+		private:
+			friend class pregel;
+			detail::aggregator_slot<T>* slot_ = nullptr;
+
+			explicit aggregator(detail::aggregator_slot<T>* slot)
+			: slot_(slot) {}
+		};
+
+		// the node compute() is running on and what it may do during this superstep
+		class vertex {
+		public:
+			[[nodiscard]] auto id() const noexcept -> node_id {
+				return id_;
+			}
+
+			[[nodiscard]] auto node() const -> N const& {
+				return engine_->graph_.node(id_);
+			}
+
+			[[nodiscard]] auto value() const noexcept -> Value& {
+				return engine_->values_[id_];
+			}
+
+			[[nodiscard]] auto superstep() const noexcept -> std::size_t {
+				return engine_->superstep_;
+			}
+
+			[[nodiscard]] auto num_nodes() const noexcept -> std::size_t {
+				return engine_->graph_.num_nodes();
+			}
+
+			// one entry per edge, so a target appears once per weight
+			[[nodiscard]] auto out_neighbors() const noexcept -> std::span<node_id const> {
+				return engine_->graph_.out_neighbors(id_);
+			}
+
+			[[nodiscard]] auto out_weights() const noexcept -> std::span<E const> {
+				return engine_->graph_.out_weights(id_);
+			}
+
+			// delivered to target at the start of the next superstep
+			auto send(node_id target, Message message) -> void {
+				engine_->outbox_[thread_][engine_->owner(target)].emplace_back(target,
+				                                                               std::move(message));
+				++sent_;
+			}
+
+			// one copy along every outgoing edge
+			auto send_to_neighbors(Message const& message) -> void {
+				for (auto target : out_neighbors()) {
+					send(target, message);
+				}
+			}
+
+			// stop calling compute() on this node until it is sent a message
+			auto vote_to_halt() noexcept -> void {
+				engine_->halted_[id_] = 1;
+			}
+
+			template<typename T>
+			auto aggregate(aggregator<T> const& into, T const& value) -> void {
+				into.slot_->add(thread_, value);
+			}
+
+			// the aggregator's result over the previous superstep, its identity in the first
+			template<typename T>
+			[[nodiscard]] auto aggregated(aggregator<T> const& from) const noexcept -> T const& {
+				return from.slot_->current();
+			}
+
+		private:
+			friend class pregel;
+			pregel* engine_;
+			std::size_t thread_;
+			node_id id_ = 0;
+			std::uint64_t sent_ = 0;
+
+			vertex(pregel* engine, std::size_t thread)
+			: engine_(engine)
+			, thread_(thread) {}
+		};
+
+		explicit pregel(frozen_graph<N, E> g, Value initial = Value())
+		: graph_(std::move(g))
+		, values_(graph_.num_nodes(), initial) {}
+
+		explicit pregel(graph<N, E> const& g, Value initial = Value())
+		: pregel(frozen_graph<N, E>(g), std::move(initial)) {}
+
+		// folds two messages to the same node into one, before compute() sees them
+		template<typename Combine>
+		auto set_combiner(Combine&& combine) -> void {
+			combiner_ = std::forward<Combine>(combine);
+		}
+
+		template<typename T, typename Reduce>
+		auto add_aggregator(T identity, Reduce&& reduce) -> aggregator<T> {
+			auto slot = std::make_unique<detail::aggregator_slot<T>>(std::move(identity),
+			                                                         std::forward<Reduce>(reduce));
+			auto* handle = slot.get();
+			aggregators_.push_back(std::move(slot));
+			return aggregator<T>(handle);
+		}
+
+		// runs compute(vertex&, std::span<Message const>) until every node halts. Values carry
+		// over from any earlier run, everything else starts afresh
+		template<typename Compute>
+		auto run(Compute&& compute, pregel_options const& options = {}) -> pregel_result {
+			[[maybe_unused]] auto const span = trace::span("gdwg::pregel::run");
+			auto const n = graph_.num_nodes();
+			threads_ =
+			   std::min(detail::resolve_threads(options.threads), std::max<std::size_t>(n, 1));
+			halted_.assign(n, 0);
+			first_.assign(n, 0);
+			count_.assign(n, 0);
+			inbox_.assign(threads_, {});
+			outbox_.assign(threads_, std::vector<std::vector<envelope>>(threads_));
+			reset_aggregators();
+
+			auto result = pregel_result{0, 0, false};
+			auto active = std::vector<std::size_t>(threads_);
+			auto sent = std::vector<std::uint64_t>(threads_);
+			for (superstep_ = 0; superstep_ < options.max_supersteps; ++superstep_) {
+				for (auto const& slot : aggregators_) {
+					slot->start(threads_);
+				}
+				detail::parallel_for(n, threads_, [&](std::size_t begin, std::size_t end, auto t) {
+					auto current = vertex(this, t);
+					active[t] = 0;
+					for (auto v = begin; v < end; ++v) {
+						auto const messages = inbox(static_cast<node_id>(v));
+						if (halted_[v] && messages.empty()) {
+							continue;
+						}
+						halted_[v] = 0;
+						current.id_ = static_cast<node_id>(v);
+						compute(current, messages);
+						active[t] += halted_[v] == 0 ? 1U : 0U;
+					}
+					sent[t] = current.sent_;
+				});
+				for (auto const& slot : aggregators_) {
+					slot->finish();
+				}
+
+				auto in_flight = std::uint64_t{0};
+				auto still_active = std::size_t{0};
+				for (auto t = std::size_t{0}; t < threads_; ++t) {
+					in_flight += sent[t];
+					still_active += active[t];
+				}
+				result.messages += in_flight;
+				deliver();
+				if (in_flight == 0 && still_active == 0) {
+					++superstep_;
+					result.halted = true;
+					break;
+				}
+			}
+			result.supersteps = superstep_;
+			return result;
+		}
+
+		[[nodiscard]] auto values() const noexcept -> std::vector<Value> const& {
+			return values_;
+		}
+
+		[[nodiscard]] auto value(N const& node) const -> Value const& {
+			auto const id = graph_.find(node);
+			if (!id) {
+				throw std::runtime_error("Cannot call gdwg::pregel<N, E, Value, Message>::value if the "
+				                         "node doesn't exist in the graph");
+			}
+			return values_[*id];
+		}
+
+		// the aggregator's result over the last superstep run
+		template<typename T>
+		[[nodiscard]] auto aggregated(aggregator<T> const& from) const noexcept -> T const& {
+			return from.slot_->current();
+		}
+
+		[[nodiscard]] auto frozen() const noexcept -> frozen_graph<N, E> const& {
+			return graph_;
+		}
+
+	private:
+		using envelope = std::pair<node_id, Message>;
+
+		frozen_graph<N, E> graph_;
+		std::vector<Value> values_;
+		std::function<Message(Message const&, Message const&)> combiner_;
+		std::vector<std::unique_ptr<detail::aggregator_slot_base>> aggregators_;
+
+		std::size_t threads_ = 1;
+		std::size_t superstep_ = 0;
+		// bytes rather than bits, threads write their own nodes' flags concurrently
+		std::vector<std::uint8_t> halted_;
+		// outbox_[sender][owner of the target]
+		std::vector<std::vector<std::vector<envelope>>> outbox_;
+		// messages for each range's nodes, node v's being count_[v] from first_[v]
+		std::vector<std::vector<Message>> inbox_;
+		std::vector<std::size_t> first_;
+		std::vector<std::size_t> count_;
+
+		// the range parallel_for gives v to, those start at floor(n * t / threads)
+		auto owner(node_id v) const noexcept -> std::size_t {
+			auto const n = static_cast<std::uint64_t>(graph_.num_nodes());
+			return static_cast<std::size_t>(((std::uint64_t{v} + 1) * threads_ + n - 1) / n - 1);
+		}
+
+		auto inbox(node_id v) const noexcept -> std::span<Message const> {
+			auto const& mine = inbox_[owner(v)];
+			return std::span<Message const>(mine.data() + first_[v], count_[v]);
+		}
+
+		auto deliver() -> void {
+			auto const n = graph_.num_nodes();
+			detail::parallel_for(n, threads_, [&](std::size_t begin, std::size_t end, std::size_t t) {
+				auto& mine = inbox_[t];
+				mine.clear();
+				// a node that hears nothing must not keep an offset into last superstep's inbox
+				for (auto v = begin; v < end; ++v) {
+					first_[v] = 0;
+					count_[v] = 0;
+				}
+
+				if (combiner_) {
+					// one slot per node that hears anything, in order of first message
+					for (auto& from : outbox_) {
+						for (auto& [target, message] : from[t]) {
+							if (count_[target] == 0) {
+								first_[target] = mine.size();
+								count_[target] = 1;
+								mine.push_back(std::move(message));
+							}
+							else {
+								auto& folded = mine[first_[target]];
+								folded = combiner_(folded, message);
+							}
+						}
+						from[t].clear();
+					}
+					return;
+				}
+
+				// counting sort by target, in order of sending thread
+				for (auto const& from : outbox_) {
+					for (auto const& [target, message] : from[t]) {
+						++count_[target];
+					}
+				}
+				auto position = std::size_t{0};
+				for (auto v = begin; v < end; ++v) {
+					first_[v] = position;
+					position += count_[v];
+					count_[v] = 0;
+				}
+				mine.resize(position);
+				for (auto& from : outbox_) {
+					for (auto& [target, message] : from[t]) {
+						mine[first_[target] + count_[target]++] = std::move(message);
+					}
+					from[t].clear();
+				}
+			});
+		}
+
+		auto reset_aggregators() -> void {
+			for (auto const& slot : aggregators_) {
+				slot->start(threads_);
+				slot->finish();
+			}
+		}
+	};
+} // namespace gdwg
+
+#endif // GDWG_PREGEL_HPP
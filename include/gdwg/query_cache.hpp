@@ -0,0 +1,227 @@
+#ifndef GDWG_QUERY_CACHE_HPP
+#define GDWG_QUERY_CACHE_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <map>
+#include <stdexcept>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "gdwg/detail/attached_observer.hpp"
+#include "gdwg/graph.hpp"
+
+// Bounded least recently used cache for the results of queries against one graph. A plain entry
+// remembers the graph's version() it was computed at and is thrown away on the first lookup after
+// any change. A tracked entry also records which nodes the query read, and only a change to one
+// of those nodes throws it away, so answers about an untouched part of the graph survive
+// unrelated writes. Lookups and inserts are O(1) on average apart from the query itself.
+
+namespace gdwg {
+	template<typename N, typename E, typename Key, typename Value, typename Hash = std::hash<Key>>
+	class query_cache : private detail::attached_observer<N, E> {
+	public:
+		// nodes a tracked query read the outgoing edges of. Inserting or erasing one of their
+		// edges, erasing or renaming one of them, or renaming one of their destinations
+		// invalidates the result
+		class dependencies {
+		public:
+			auto add(N const& node) -> void {
+				nodes_.push_back(node);
+			}
+
+		private:
+			friend class query_cache;
+			std::vector<N> nodes_;
+		};
+
+		query_cache(graph<N, E>& g, std::size_t capacity)
+		: detail::attached_observer<N, E>(g)
+		, capacity_(capacity) {
+			if (capacity_ == 0) {
+				throw std::runtime_error("Cannot create gdwg::query_cache with a capacity of 0");
+			}
+			this->subscribe();
+		}
+
+		// cached result for key, or compute() stored under key. The reference lasts until the next
+		// call that modifies the cache
+		template<typename Compute>
+		auto get(Key const& key, Compute&& compute) -> Value const& {
+			if (auto const* cached = find(key)) {
+				return *cached;
+			}
+			return store(key, std::forward<Compute>(compute)(), {}, false);
+		}
+
+		// as get(), with compute(dependencies&) recording which nodes the result depends on
+		template<typename Compute>
+		auto get_tracked(Key const& key, Compute&& compute) -> Value const& {
+			if (auto const* cached = find(key)) {
+				return *cached;
+			}
+			auto depends_on = dependencies();
+			auto value = std::forward<Compute>(compute)(depends_on);
+			return store(key, std::move(value), std::move(depends_on.nodes_), true);
+		}
+
+		// nullptr when key isn't cached or its result is out of date
+		[[nodiscard]] auto find(Key const& key) -> Value const* {
+			auto found = index_.find(key);
+			if (found == index_.end()) {
+				++misses_;
+				return nullptr;
+			}
+			auto const& cached = *found->second;
+			auto const current = this->graph_ != nullptr && this->graph_->version() == cached.version;
+			if (!cached.tracked && !current) {
+				remove(found->second);
+				++misses_;
+				return nullptr;
+			}
+			lru_.splice(lru_.begin(), lru_, found->second);
+			++hits_;
+			return &cached.value;
+		}
+
+		auto erase(Key const& key) -> bool {
+			auto found = index_.find(key);
+			if (found == index_.end()) {
+				return false;
+			}
+			remove(found->second);
+			return true;
+		}
+
+		auto clear() noexcept -> void {
+			lru_.clear();
+			index_.clear();
+			dependents_.clear();
+		}
+
+		[[nodiscard]] auto size() const noexcept -> std::size_t {
+			return lru_.size();
+		}
+
+		[[nodiscard]] auto capacity() const noexcept -> std::size_t {
+			return capacity_;
+		}
+
+		[[nodiscard]] auto hits() const noexcept -> std::uint64_t {
+			return hits_;
+		}
+
+		[[nodiscard]] auto misses() const noexcept -> std::uint64_t {
+			return misses_;
+		}
+
+	private:
+		struct entry {
+			Key key;
+			Value value;
+			std::uint64_t version;
+			bool tracked;
+			std::vector<N> depends_on;
+		};
+
+		using entry_list = std::list<entry>;
+
+		std::size_t capacity_;
+		// most recently used first
+		entry_list lru_;
+		std::unordered_map<Key, typename entry_list::iterator, Hash> index_;
+		// node to the tracked entries that read it
+		std::map<N, std::vector<Key>> dependents_;
+		std::uint64_t hits_ = 0;
+		std::uint64_t misses_ = 0;
+
+		auto store(Key const& key, Value value, std::vector<N> depends_on, bool tracked)
+		   -> Value const& {
+			auto const version = this->graph_ != nullptr ? this->graph_->version() : 0;
+			std::sort(depends_on.begin(), depends_on.end());
+			depends_on.erase(std::unique(depends_on.begin(), depends_on.end()), depends_on.end());
+			if (auto found = index_.find(key); found != index_.end()) {
+				remove(found->second);
+			}
+			while (lru_.size() >= capacity_) {
+				remove(std::prev(lru_.end()));
+			}
+
+			lru_.push_front(entry{key, std::move(value), version, tracked, std::move(depends_on)});
+			index_.emplace(key, lru_.begin());
+			for (auto const& node : lru_.front().depends_on) {
+				dependents_[node].push_back(key);
+			}
+			return lru_.front().value;
+		}
+
+		auto remove(typename entry_list::iterator at) -> void {
+			for (auto const& node : at->depends_on) {
+				auto found = dependents_.find(node);
+				if (found == dependents_.end()) {
+					continue;
+				}
+				std::erase(found->second, at->key);
+				if (found->second.empty()) {
+					dependents_.erase(found);
+				}
+			}
+			index_.erase(at->key);
+			lru_.erase(at);
+		}
+
+		auto invalidate(N const& node) -> void {
+			auto found = dependents_.find(node);
+			if (found == dependents_.end()) {
+				return;
+			}
+			auto const keys = std::move(found->second);
+			dependents_.erase(found);
+			for (auto const& key : keys) {
+				if (auto cached = index_.find(key); cached != index_.end()) {
+					remove(cached->second);
+				}
+			}
+		}
+
+		// plain entries are checked against version() on lookup, these only handle tracked ones
+		auto node_erased(N const& value) -> void override {
+			invalidate(value);
+		}
+
+		// the graph reports no edge events for a rename, yet every source with an edge into the
+		// node now reads a different destination. The rename has already happened here
+		auto node_replaced(N const& old_data, N const& new_data) -> void override {
+			invalidate(old_data);
+			invalidate(new_data);
+			for (auto const& [src, dsts] : detail::graph_access::edges(*this->graph_)) {
+				if (dsts.find(new_data) != dsts.end()) {
+					invalidate(*src);
+				}
+			}
+		}
+
+		auto edge_inserted(N const& src, N const& /*dst*/, E const& /*weight*/) -> void override {
+			invalidate(src);
+		}
+
+		auto edge_erased(N const& src, N const& /*dst*/, E const& /*weight*/) -> void override {
+			invalidate(src);
+		}
+
+		auto reloaded() -> void override {
+			clear();
+		}
+
+		auto detached() -> void override {
+			detail::attached_observer<N, E>::detached();
+			clear();
+		}
+	};
+} // namespace gdwg
+
+#endif // GDWG_QUERY_CACHE_HPP
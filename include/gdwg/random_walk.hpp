@@ -0,0 +1,251 @@
+#ifndef GDWG_RANDOM_WALK_HPP
+#define GDWG_RANDOM_WALK_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "gdwg/detail/parallel.hpp"
+#include "gdwg/frozen_graph.hpp"
+#include "gdwg/trace.hpp"
+
+// Weighted random walks over a frozen_graph, the sampling step behind DeepWalk and node2vec
+// embeddings. Each step leaves a node along one of its edges with probability proportional to
+// the edge's weight. Every node's choice is an alias table built once up front, so a step costs
+// two random numbers and one table lookup however many edges the node has.
+//
+// node2vec walks weight the edge to x from the current node v, having come from t, by 1/p if x
+// is t, 1 if t has an edge to x, and 1/q otherwise. Rather than an alias table for every (t, v)
+// pair, which takes memory quadratic in the degrees, a step draws from v's first order table and
+// keeps the draw with probability bias / max bias, retrying otherwise. Whether t has an edge to x
+// is a binary search of t's sorted row.
+//
+// generate() splits walks across threads and hands each to a sink as soon as it is finished, so
+// nothing is kept beyond one walk per thread. Every walk draws from its own generator seeded from
+// the walk's index, so the walks are the same whatever the thread count.
+
+namespace gdwg {
+	struct walk_options {
+		// nodes in each walk, counting the start. A walk ends early at a node with no way out
+		std::size_t length = 80;
+		std::size_t walks_per_node = 10;
+		// node2vec return and in-out parameters, 1 and 1 is a plain weighted walk
+		double p = 1;
+		double q = 1;
+		std::uint64_t seed = 0x5eed;
+		// 0 means one per hardware thread
+		std::size_t threads = 0;
+	};
+
+	namespace detail {
+		// splitmix64, one 64 bit word of state so reseeding it for every walk is free
+		class walk_rng {
+		public:
+			explicit walk_rng(std::uint64_t seed) noexcept
+			: state_(seed) {}
+
+			auto operator()() noexcept -> std::uint64_t {
+				auto x = state_ += 0x9e3779b97f4a7c15U;
+				x = (x ^ (x >> 30U)) * 0xbf58476d1ce4e5b9U;
+				x = (x ^ (x >> 27U)) * 0x94d049bb133111ebU;
+				return x ^ (x >> 31U);
+			}
+
+			// in [0, 1)
+			auto uniform() noexcept -> double {
+				return static_cast<double>((*this)() >> 11U) * 0x1.0p-53;
+			}
+
+			// in [0, n) for n below 2^32, by multiplying rather than dividing
+			auto below(std::size_t n) noexcept -> std::size_t {
+				return static_cast<std::size_t>((((*this)() >> 32U) * n) >> 32U);
+			}
+
+		private:
+			std::uint64_t state_;
+		};
+	} // namespace detail
+
+	template<typename N, typename E>
+	class random_walker {
+	public:
+		using node_id = std::uint32_t;
+
+		explicit random_walker(frozen_graph<N, E> g)
+		: graph_(std::move(g)) {
+			[[maybe_unused]] auto const span = trace::span("gdwg::random_walker::build");
+			build_alias_tables();
+		}
+
+		explicit random_walker(graph<N, E> const& g)
+		: random_walker(frozen_graph<N, E>(g)) {}
+
+		// writes one walk from start into out, at most length nodes long
+		auto walk(node_id start, std::vector<node_id>& out, walk_options const& options) const
+		   -> void {
+			check(options, "walk");
+			if (start >= graph_.num_nodes()) {
+				throw std::runtime_error("Cannot call gdwg::random_walker<N, E>::walk if start doesn't "
+				                         "exist in the graph");
+			}
+			auto rng = detail::walk_rng(options.seed ^ start);
+			walk(start, out, options, rng);
+		}
+
+		// walks_per_node walks from every node, each passed to sink(std::span<node_id const>,
+		// std::size_t thread) as soon as it is done. Sinks run on several threads at once unless
+		// options.threads is 1, the thread index is there for keeping per thread buffers. Returns
+		// how many walks were made
+		template<typename Sink>
+		auto generate(Sink&& sink, walk_options const& options = {}) const -> std::uint64_t {
+			[[maybe_unused]] auto const span = trace::span("gdwg::random_walker::generate");
+			check(options, "generate");
+			auto const n = graph_.num_nodes();
+			auto const total = n * options.walks_per_node;
+			auto const run = [&](std::size_t begin, std::size_t end, std::size_t t) {
+				auto path = std::vector<node_id>();
+				path.reserve(options.length);
+				for (auto i = begin; i < end; ++i) {
+					// round i / n of walks, so each round starts from every node once
+					auto rng = detail::walk_rng(options.seed ^ (0x5851f42d4c957f2dU * (i + 1)));
+					walk(static_cast<node_id>(i % n), path, options, rng);
+					sink(std::span<node_id const>(path), t);
+				}
+			};
+			detail::parallel_for(total, options.threads, run);
+			return total;
+		}
+
+		[[nodiscard]] auto frozen() const noexcept -> frozen_graph<N, E> const& {
+			return graph_;
+		}
+
+	private:
+		frozen_graph<N, E> graph_;
+		// per edge, in out_targets() order: the chance of keeping the slot, and where to go if not
+		std::vector<double> keep_;
+		std::vector<std::uint32_t> alias_;
+		// whether a node has any positive weight out of it
+		std::vector<std::uint8_t> live_;
+
+		static auto check(walk_options const& options, char const* caller) -> void {
+			if (!(options.p > 0) || !(options.q > 0)) {
+				throw std::runtime_error(std::string("Cannot call gdwg::random_walker<N, E>::") + caller
+				                         + " without positive p and q");
+			}
+		}
+
+		// Vose's method, one table per row
+		auto build_alias_tables() -> void {
+			auto const n = graph_.num_nodes();
+			auto const& offsets = graph_.out_offsets();
+			keep_.assign(offsets[n], 0);
+			alias_.assign(offsets[n], 0);
+			live_.assign(n, 0);
+			auto small = std::vector<std::uint32_t>();
+			auto large = std::vector<std::uint32_t>();
+			for (auto v = node_id{0}; v < n; ++v) {
+				auto const weights = graph_.out_weights(v);
+				auto total = 0.0;
+				for (auto const& weight : weights) {
+					if (static_cast<double>(weight) < 0) {
+						throw std::runtime_error("Cannot create gdwg::random_walker<N, E> with a "
+						                         "negative edge weight");
+					}
+					total += static_cast<double>(weight);
+				}
+				if (!(total > 0)) {
+					continue;
+				}
+				live_[v] = 1;
+
+				auto* keep = keep_.data() + offsets[v];
+				auto* alias = alias_.data() + offsets[v];
+				auto const degree = static_cast<std::uint32_t>(weights.size());
+				small.clear();
+				large.clear();
+				for (auto i = std::uint32_t{0}; i < degree; ++i) {
+					keep[i] = static_cast<double>(weights[i]) * degree / total;
+					alias[i] = i;
+					(keep[i] < 1 ? small : large).push_back(i);
+				}
+				while (!small.empty() && !large.empty()) {
+					auto const less = small.back();
+					auto const more = large.back();
+					small.pop_back();
+					alias[less] = more;
+					keep[more] -= 1 - keep[less];
+					if (keep[more] < 1) {
+						large.pop_back();
+						small.push_back(more);
+					}
+				}
+				// whatever is left is 1 up to rounding
+				for (auto i : large) {
+					keep[i] = 1;
+				}
+				for (auto i : small) {
+					keep[i] = 1;
+				}
+			}
+		}
+
+		auto pick(std::size_t begin, std::size_t degree, detail::walk_rng& rng) const noexcept
+		   -> std::size_t {
+			auto const slot = rng.below(degree);
+			return rng.uniform() < keep_[begin + slot] ? slot : alias_[begin + slot];
+		}
+
+		// whether t has an edge to x
+		auto linked(node_id t, node_id x) const noexcept -> bool {
+			auto const row = graph_.out_neighbors(t);
+			return std::binary_search(row.begin(), row.end(), x);
+		}
+
+		auto walk(node_id start,
+		          std::vector<node_id>& out,
+		          walk_options const& options,
+		          detail::walk_rng& rng) const -> void {
+			out.clear();
+			if (options.length == 0) {
+				return;
+			}
+			out.push_back(start);
+			auto const biased = options.p != 1 || options.q != 1;
+			auto const to_back = 1 / options.p;
+			auto const to_far = 1 / options.q;
+			auto const most = std::max({to_back, 1.0, to_far});
+			auto const& offsets = graph_.out_offsets();
+			auto const& targets = graph_.out_targets();
+
+			while (out.size() < options.length) {
+				auto const v = out.back();
+				auto const begin = offsets[v];
+				auto const degree = offsets[v + 1] - begin;
+				if (degree == 0 || !live_[v]) {
+					return;
+				}
+				if (!biased || out.size() == 1) {
+					out.push_back(targets[begin + pick(begin, degree, rng)]);
+					continue;
+				}
+				auto const t = out[out.size() - 2];
+				for (;;) {
+					auto const x = targets[begin + pick(begin, degree, rng)];
+					auto const bias = x == t ? to_back : linked(t, x) ? 1.0 : to_far;
+					if (rng.uniform() * most < bias) {
+						out.push_back(x);
+						break;
+					}
+				}
+			}
+		}
+	};
+} // namespace gdwg
+
+#endif // GDWG_RANDOM_WALK_HPP
@@ -0,0 +1,297 @@
+#ifndef GDWG_REACHABILITY_HPP
+#define GDWG_REACHABILITY_HPP
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <span>
+#include <stdexcept>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include "gdwg/components.hpp"
+#include "gdwg/frozen_graph.hpp"
+#include "gdwg/graph.hpp"
+#include "gdwg/trace.hpp"
+
+// Precomputed answers to "is there a path from src to dst". Strongly connected components are
+// collapsed into a DAG first, since every node of a component reaches the same set. Small DAGs
+// keep the full transitive closure as one bit row per component. Larger ones keep a few GRAIL
+// interval labels per component, from randomised depth first traversals: if u reaches v then v's
+// interval sits inside u's in every traversal, so most negative queries fail that test straight
+// away, and the rest fall back to a depth first search that skips every component whose labels
+// rule it out. The index is a snapshot, call rebuild() once the graph has changed.
+
+namespace gdwg {
+	template<typename N, typename E>
+	class reachability_index {
+	public:
+		// most components the transitive closure is kept for, it takes count^2 / 8 bytes
+		static constexpr std::size_t default_closure_limit = 8192;
+
+		reachability_index() = default;
+
+		explicit reachability_index(graph<N, E> const& g,
+		                            std::size_t closure_limit = default_closure_limit)
+		: closure_limit_(closure_limit) {
+			rebuild(g);
+		}
+
+		auto rebuild(graph<N, E> const& g) -> void {
+			[[maybe_unused]] auto const span = trace::span("gdwg::reachability_index::rebuild");
+			auto const frozen = frozen_graph<N, E>(g);
+			auto labels = strongly_connected_components(frozen);
+			version_ = g.version();
+			nodes_ = frozen.nodes();
+			component_ = std::move(labels.component);
+			build_dag(frozen, labels.count);
+			order_topologically();
+
+			closure_.clear();
+			intervals_.clear();
+			if (labels.count <= closure_limit_) {
+				build_closure();
+			}
+			else {
+				build_intervals();
+			}
+		}
+
+		// true if dst can be reached from src by following zero or more edges
+		[[nodiscard]] auto is_reachable(N const& src, N const& dst) const -> bool {
+			auto const u = component_of(src);
+			auto const v = component_of(dst);
+			if (u == v) {
+				return true;
+			}
+			if (!closure_.empty()) {
+				auto const bit = closure_[u * words_ + v / 64] >> (v % 64);
+				return (bit & 1U) != 0;
+			}
+			if (rank_[u] > rank_[v] || !may_reach(u, v)) {
+				return false;
+			}
+
+			auto seen = std::unordered_set<component_id>{u};
+			auto stack = std::vector<component_id>{u};
+			while (!stack.empty()) {
+				auto const x = stack.back();
+				stack.pop_back();
+				for (auto s : successors(x)) {
+					if (s == v) {
+						return true;
+					}
+					if (rank_[s] < rank_[v] && may_reach(s, v) && seen.insert(s).second) {
+						stack.push_back(s);
+					}
+				}
+			}
+			return false;
+		}
+
+		// strongly connected components, the nodes of the DAG
+		[[nodiscard]] auto num_components() const noexcept -> std::size_t {
+			return rank_.size();
+		}
+
+		// whether queries are answered from the transitive closure rather than the labels
+		[[nodiscard]] auto uses_closure() const noexcept -> bool {
+			return !closure_.empty();
+		}
+
+		// true once g has changed since the index was built from it
+		[[nodiscard]] auto is_stale(graph<N, E> const& g) const noexcept -> bool {
+			return g.version() != version_;
+		}
+
+	private:
+		using component_id = std::uint32_t;
+
+		// post order number of a component, and the smallest one among everything below it
+		struct interval {
+			component_id low;
+			component_id post;
+		};
+
+		static constexpr std::size_t traversals = 3;
+
+		std::size_t closure_limit_ = default_closure_limit;
+		std::uint64_t version_ = 0;
+		std::vector<N> nodes_;
+		std::vector<component_id> component_;
+		// condensation DAG, one sorted row of successors per component
+		std::vector<std::size_t> dag_offsets_{0};
+		std::vector<component_id> dag_targets_;
+		// position in a topological order, a component only reaches higher ranks
+		std::vector<component_id> rank_;
+		std::vector<component_id> topological_;
+		std::size_t words_ = 0;
+		std::vector<std::uint64_t> closure_;
+		std::vector<std::array<interval, traversals>> intervals_;
+
+		auto component_of(N const& value) const -> component_id {
+			auto found = std::lower_bound(nodes_.begin(), nodes_.end(), value);
+			if (found == nodes_.end() || value < *found) {
+				throw std::runtime_error("Cannot call gdwg::reachability_index<N, E>::is_reachable if "
+				                         "src or dst node don't exist in the graph");
+			}
+			return component_[static_cast<std::size_t>(found - nodes_.begin())];
+		}
+
+		auto successors(component_id c) const noexcept -> std::span<component_id const> {
+			return std::span<component_id const>(dag_targets_.data() + dag_offsets_[c],
+			                                      dag_offsets_[c + 1] - dag_offsets_[c]);
+		}
+
+		auto build_dag(frozen_graph<N, E> const& g, std::size_t count) -> void {
+			auto edges = std::vector<std::pair<component_id, component_id>>();
+			for (auto v = component_id{0}; v < g.num_nodes(); ++v) {
+				for (auto w : g.out_neighbors(v)) {
+					if (component_[v] != component_[w]) {
+						edges.emplace_back(component_[v], component_[w]);
+					}
+				}
+			}
+			std::sort(edges.begin(), edges.end());
+			edges.erase(std::unique(edges.begin(), edges.end()), edges.end());
+
+			dag_offsets_.assign(count + 1, 0);
+			dag_targets_.clear();
+			dag_targets_.reserve(edges.size());
+			for (auto const& [from, to] : edges) {
+				++dag_offsets_[from + 1];
+				dag_targets_.push_back(to);
+			}
+			for (auto c = std::size_t{1}; c <= count; ++c) {
+				dag_offsets_[c] += dag_offsets_[c - 1];
+			}
+		}
+
+		// Kahn's algorithm
+		auto order_topologically() -> void {
+			auto const count = dag_offsets_.size() - 1;
+			auto in_degree = std::vector<std::size_t>(count);
+			for (auto to : dag_targets_) {
+				++in_degree[to];
+			}
+			topological_.clear();
+			topological_.reserve(count);
+			for (auto c = component_id{0}; c < count; ++c) {
+				if (in_degree[c] == 0) {
+					topological_.push_back(c);
+				}
+			}
+			for (auto i = std::size_t{0}; i < topological_.size(); ++i) {
+				for (auto s : successors(topological_[i])) {
+					if (--in_degree[s] == 0) {
+						topological_.push_back(s);
+					}
+				}
+			}
+			rank_.assign(count, 0);
+			for (auto i = std::size_t{0}; i < count; ++i) {
+				rank_[topological_[i]] = static_cast<component_id>(i);
+			}
+		}
+
+		// each row is its own bit or'd with its successors' rows, filled sinks first
+		auto build_closure() -> void {
+			auto const count = rank_.size();
+			words_ = (count + 63) / 64;
+			closure_.assign(count * words_, 0);
+			for (auto c = topological_.rbegin(); c != topological_.rend(); ++c) {
+				auto* row = closure_.data() + *c * words_;
+				row[*c / 64] |= std::uint64_t{1} << (*c % 64);
+				for (auto s : successors(*c)) {
+					auto const* below = closure_.data() + s * words_;
+					for (auto w = std::size_t{0}; w < words_; ++w) {
+						row[w] |= below[w];
+					}
+				}
+			}
+		}
+
+		auto build_intervals() -> void {
+			auto const count = rank_.size();
+			intervals_.assign(count, {});
+			auto has_parent = std::vector<bool>(count);
+			for (auto to : dag_targets_) {
+				has_parent[to] = true;
+			}
+			auto roots = std::vector<component_id>();
+			for (auto c = component_id{0}; c < count; ++c) {
+				if (!has_parent[c]) {
+					roots.push_back(c);
+				}
+			}
+
+			auto rng = std::mt19937(0x9a11);
+			for (auto t = std::size_t{0}; t < traversals; ++t) {
+				std::shuffle(roots.begin(), roots.end(), rng);
+				label(t, roots, rng);
+			}
+		}
+
+		// one post order traversal from the roots in the order given, each component's children
+		// are visited from a random starting point
+		auto label(std::size_t traversal, std::vector<component_id> const& roots, std::mt19937& rng)
+		   -> void {
+			auto const count = rank_.size();
+
+			struct frame {
+				component_id c;
+				std::size_t next;
+				std::size_t start;
+			};
+			auto visited = std::vector<bool>(count);
+			auto stack = std::vector<frame>();
+			auto post = component_id{0};
+			auto enter = [&](component_id c) {
+				visited[c] = true;
+				auto const degree = successors(c).size();
+				auto pick = std::uniform_int_distribution<std::size_t>(0, degree == 0 ? 0 : degree - 1);
+				stack.push_back({c, 0, pick(rng)});
+			};
+
+			for (auto root : roots) {
+				enter(root);
+				while (!stack.empty()) {
+					auto& top = stack.back();
+					auto const children = successors(top.c);
+					if (top.next < children.size()) {
+						auto const child = children[(top.start + top.next++) % children.size()];
+						if (!visited[child]) {
+							enter(child);
+						}
+						continue;
+					}
+
+					auto& mine = intervals_[top.c][traversal];
+					mine.post = post++;
+					mine.low = mine.post;
+					for (auto child : children) {
+						mine.low = std::min(mine.low, intervals_[child][traversal].low);
+					}
+					stack.pop_back();
+				}
+			}
+		}
+
+		// false only if no path from u to v can exist
+		auto may_reach(component_id u, component_id v) const noexcept -> bool {
+			for (auto t = std::size_t{0}; t < traversals; ++t) {
+				auto const& outer = intervals_[u][t];
+				auto const& inner = intervals_[v][t];
+				if (inner.low < outer.low || outer.post < inner.post) {
+					return false;
+				}
+			}
+			return true;
+		}
+	};
+} // namespace gdwg
+
+#endif // GDWG_REACHABILITY_HPP
@@ -0,0 +1,116 @@
+#ifndef GDWG_SERIALIZER_HPP
+#define GDWG_SERIALIZER_HPP
+
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "gdwg/detail/varint.hpp"
+
+// How nodes and weights are written to bytes and read back, for anything that stores a graph.
+// Integers are varints, zigzagged when signed, floating point values are copied as they are and
+// strings are a varint length then their characters. Other types need a specialisation of
+// gdwg::serializer<T> with the same two static members.
+
+namespace gdwg {
+	// reads back what was written with detail::put_varint and serializer<T>::put, checking every
+	// read stays inside the buffer
+	class byte_reader {
+	public:
+		explicit byte_reader(std::span<std::uint8_t const> bytes) noexcept
+		: at_(bytes.data())
+		, end_(bytes.data() + bytes.size()) {}
+
+		auto varint() -> std::uint64_t {
+			auto value = std::uint64_t{0};
+			for (auto shift = 0U; shift < 64; shift += 7) {
+				auto const byte = take(1)[0];
+				value |= std::uint64_t{byte & 0x7fU} << shift;
+				if ((byte & 0x80U) == 0) {
+					return value;
+				}
+			}
+			throw std::runtime_error("Cannot read a varint longer than ten bytes");
+		}
+
+		auto bytes(std::size_t count) -> std::span<std::uint8_t const> {
+			return take(count);
+		}
+
+		[[nodiscard]] auto remaining() const noexcept -> std::size_t {
+			return static_cast<std::size_t>(end_ - at_);
+		}
+
+	private:
+		std::uint8_t const* at_;
+		std::uint8_t const* end_;
+
+		auto take(std::size_t count) -> std::span<std::uint8_t const> {
+			if (remaining() < count) {
+				throw std::runtime_error("Cannot read past the end of a gdwg::byte_reader");
+			}
+			auto const taken = std::span<std::uint8_t const>(at_, count);
+			at_ += count;
+			return taken;
+		}
+	};
+
+	template<typename T>
+	struct serializer;
+
+	template<std::integral T>
+	struct serializer<T> {
+		static auto put(std::vector<std::uint8_t>& out, T const& value) -> void {
+			if constexpr (std::is_signed_v<T>) {
+				detail::put_varint(out, detail::zigzag(static_cast<std::int64_t>(value)));
+			}
+			else {
+				detail::put_varint(out, static_cast<std::uint64_t>(value));
+			}
+		}
+
+		static auto get(byte_reader& in) -> T {
+			if constexpr (std::is_signed_v<T>) {
+				return static_cast<T>(detail::unzigzag(in.varint()));
+			}
+			else {
+				return static_cast<T>(in.varint());
+			}
+		}
+	};
+
+	template<std::floating_point T>
+	struct serializer<T> {
+		static auto put(std::vector<std::uint8_t>& out, T const& value) -> void {
+			auto const at = out.size();
+			out.resize(at + sizeof(T));
+			std::memcpy(out.data() + at, &value, sizeof(T));
+		}
+
+		static auto get(byte_reader& in) -> T {
+			auto value = T();
+			std::memcpy(&value, in.bytes(sizeof(T)).data(), sizeof(T));
+			return value;
+		}
+	};
+
+	template<>
+	struct serializer<std::string> {
+		static auto put(std::vector<std::uint8_t>& out, std::string const& value) -> void {
+			detail::put_varint(out, value.size());
+			out.insert(out.end(), value.begin(), value.end());
+		}
+
+		static auto get(byte_reader& in) -> std::string {
+			auto const characters = in.bytes(static_cast<std::size_t>(in.varint()));
+			return std::string(characters.begin(), characters.end());
+		}
+	};
+} // namespace gdwg
+
+#endif // GDWG_SERIALIZER_HPP
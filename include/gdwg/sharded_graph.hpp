@@ -0,0 +1,494 @@
+#ifndef GDWG_SHARDED_GRAPH_HPP
+#define GDWG_SHARDED_GRAPH_HPP
+
+#include <algorithm>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <limits>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "gdwg/detail/socket.hpp"
+#include "gdwg/frozen_graph.hpp"
+#include "gdwg/partition.hpp"
+#include "gdwg/trace.hpp"
+
+// A graph spread over worker processes on one Linux machine, one process per part of a
+// partitioning. Each worker owns its part's nodes and their outgoing edges, and keeps a ghost
+// entry, the id and owning part, for every node in another part that one of its edges reaches.
+// It also counts its mirrors, the (node, part) pairs where another part holds a ghost of one of
+// its nodes. The coordinator, the process that built the sharded_graph, keeps only the node
+// values and who owns them. Queries about one node go to its owner over a Unix domain socket,
+// and bulk algorithms such as hops() run in rounds, with every worker sending one batch of
+// messages per round to each other worker it has something for, over a full mesh of sockets.
+// Workers are forked from the coordinator, so build a sharded_graph before starting threads.
+
+namespace gdwg {
+	template<typename N, typename E>
+	class sharded_graph {
+		static_assert(std::is_trivially_copyable_v<E>,
+		              "gdwg::sharded_graph sends weights between processes as raw bytes");
+
+	public:
+		using node_id = std::uint32_t;
+		using part_id = std::uint32_t;
+
+		struct shard_stats {
+			// nodes the shard owns
+			std::size_t owned = 0;
+			// outgoing edges of those, one per weight
+			std::size_t edges = 0;
+			// nodes of other shards its edges reach
+			std::size_t ghosts = 0;
+			// (owned node, other shard) pairs where the other shard holds a ghost of the node
+			std::size_t mirrors = 0;
+		};
+
+		sharded_graph(frozen_graph<N, E> const& g,
+		              part_id parts,
+		              partition_options const& options = {})
+		: sharded_graph(g, partition(g, parts, options)) {}
+
+		// layout must come from g, workers are started one per part
+		sharded_graph(frozen_graph<N, E> const& g, partitioning layout)
+		: nodes_(g.nodes())
+		, sorted_(g.order() == node_order::sorted)
+		, layout_(std::move(layout)) {
+			[[maybe_unused]] auto const span = trace::span("gdwg::sharded_graph::build");
+			if (!sorted_) {
+				by_value_.resize(nodes_.size());
+				for (auto id = node_id{0}; id < nodes_.size(); ++id) {
+					by_value_[id] = id;
+				}
+				std::sort(by_value_.begin(), by_value_.end(), [&](node_id left, node_id right) {
+					return nodes_[left] < nodes_[right];
+				});
+			}
+			auto const out_of_range = [&](part_id p) { return p >= layout_.parts; };
+			auto const fits = layout_.part.size() == nodes_.size() && layout_.parts != 0
+			                  && std::none_of(layout_.part.begin(), layout_.part.end(), out_of_range);
+			if (!fits) {
+				throw std::runtime_error("Cannot create gdwg::sharded_graph<N, E> from a partitioning "
+				                         "of a different graph");
+			}
+			auto const parts = layout_.parts;
+
+			auto control = socket_pairs();
+			// mesh[p][q] is p's end of the socket between p and q
+			auto mesh = std::vector<std::vector<detail::socket_fd>>(parts);
+			for (auto p = part_id{0}; p < parts; ++p) {
+				control.push_back(detail::make_socket_pair());
+				mesh[p].resize(parts);
+			}
+			for (auto p = part_id{0}; p < parts; ++p) {
+				for (auto q = p + 1; q < parts; ++q) {
+					std::tie(mesh[p][q], mesh[q][p]) = detail::make_socket_pair();
+				}
+			}
+
+			try {
+				for (auto p = part_id{0}; p < parts; ++p) {
+					auto const pid = ::fork();
+					if (pid < 0) {
+						throw std::runtime_error("Cannot create gdwg::sharded_graph<N, E>, fork() "
+						                         "failed");
+					}
+					if (pid == 0) {
+						run_worker(g, p, control, mesh);
+					}
+					pids_.push_back(pid);
+					workers_.push_back(std::move(control[p].first));
+				}
+			} catch (...) {
+				// workers already started see their control socket close and exit
+				workers_.clear();
+				for (auto pid : pids_) {
+					::waitpid(pid, nullptr, 0);
+				}
+				throw;
+			}
+		}
+
+		sharded_graph(graph<N, E> const& g, part_id parts, partition_options const& options = {})
+		: sharded_graph(frozen_graph<N, E>(g), parts, options) {}
+
+		sharded_graph(graph<N, E> const& g, partitioning layout)
+		: sharded_graph(frozen_graph<N, E>(g), std::move(layout)) {}
+
+		sharded_graph(sharded_graph const&) = delete;
+		auto operator=(sharded_graph const&) -> sharded_graph& = delete;
+
+		// stops and waits for every worker
+		~sharded_graph() {
+			for (auto p = part_id{0}; p < workers_.size(); ++p) {
+				try {
+					detail::send_frame(workers_[p].get(), detail::frame().put(command::shutdown));
+				} catch (...) {
+					// the worker has gone already, closing its socket below is enough
+				}
+				workers_[p].close();
+			}
+			for (auto pid : pids_) {
+				auto status = 0;
+				while (::waitpid(pid, &status, 0) < 0 && errno == EINTR) {
+				}
+			}
+		}
+
+		[[nodiscard]] auto num_nodes() const noexcept -> std::size_t {
+			return nodes_.size();
+		}
+
+		[[nodiscard]] auto num_shards() const noexcept -> std::size_t {
+			return workers_.size();
+		}
+
+		[[nodiscard]] auto layout() const noexcept -> partitioning const& {
+			return layout_;
+		}
+
+		[[nodiscard]] auto owner(N const& value) const -> part_id {
+			return layout_.part[id_of(value, "owner")];
+		}
+
+		// same contract as graph::connections, answered by src's owner
+		[[nodiscard]] auto connections(N const& src) const -> std::vector<N> {
+			auto const id = id_of(src, "connections");
+			auto reply = request(layout_.part[id], detail::frame().put(command::connections).put(id));
+			auto res_vector = std::vector<N>();
+			for (auto target : reply.template get_all<node_id>()) {
+				res_vector.push_back(nodes_[target]);
+			}
+			if (!sorted_) {
+				std::sort(res_vector.begin(), res_vector.end());
+			}
+			return res_vector;
+		}
+
+		// same contract as graph::weights, answered by src's owner
+		[[nodiscard]] auto weights(N const& src, N const& dst) const -> std::vector<E> {
+			auto const from = find(src);
+			auto const to = find(dst);
+			if (!from || !to) {
+				throw std::runtime_error("Cannot call gdwg::sharded_graph<N, E>::weights if src or dst "
+				                         "node don't exist in the graph");
+			}
+			auto message = detail::frame().put(command::weights).put(*from).put(*to);
+			return request(layout_.part[*from], message).template get_all<E>();
+		}
+
+		// fewest edges from src to every node, by id, or nullopt where src can't reach. A
+		// breadth first search in rounds: each worker expands its share of the frontier and
+		// batches the ghosts it reaches to their owners
+		[[nodiscard]] auto hops(N const& src) const -> std::vector<std::optional<std::size_t>> {
+			[[maybe_unused]] auto const span = trace::span("gdwg::sharded_graph::hops");
+			auto const source = id_of(src, "hops");
+			broadcast(detail::frame().put(command::hops_start).put(source));
+			for (auto level = std::uint64_t{0};; ++level) {
+				auto reached = std::uint64_t{0};
+				for (auto& reply : broadcast(detail::frame().put(command::hops_step).put(level))) {
+					reached += reply.template get<std::uint64_t>();
+				}
+				if (reached == 0) {
+					break;
+				}
+			}
+
+			auto res = std::vector<std::optional<std::size_t>>(nodes_.size());
+			for (auto& reply : broadcast(detail::frame().put(command::hops_collect))) {
+				auto const ids = reply.template get_all<node_id>();
+				auto const distances = reply.template get_all<std::uint64_t>();
+				for (auto i = std::size_t{0}; i < ids.size(); ++i) {
+					if (distances[i] != unreached) {
+						res[ids[i]] = static_cast<std::size_t>(distances[i]);
+					}
+				}
+			}
+			return res;
+		}
+
+		[[nodiscard]] auto stats() const -> std::vector<shard_stats> {
+			auto res = std::vector<shard_stats>();
+			for (auto& reply : broadcast(detail::frame().put(command::stats))) {
+				res.push_back(reply.template get<shard_stats>());
+			}
+			return res;
+		}
+
+	private:
+		enum class command : std::uint8_t {
+			connections,
+			weights,
+			stats,
+			hops_start,
+			hops_step,
+			hops_collect,
+			shutdown,
+		};
+
+		static constexpr auto unreached = std::numeric_limits<std::uint64_t>::max();
+
+		// one part's nodes and edges, living in its worker process
+		class shard {
+		public:
+			shard(frozen_graph<N, E> const& g, partitioning const& layout, part_id me)
+			: me_(me) {
+				auto const n = g.num_nodes();
+				offsets_.push_back(0);
+				for (auto v = node_id{0}; v < n; ++v) {
+					if (layout.part[v] == me_) {
+						owned_.push_back(v);
+						auto const targets = g.out_neighbors(v);
+						auto const weights = g.out_weights(v);
+						targets_.insert(targets_.end(), targets.begin(), targets.end());
+						weights_.insert(weights_.end(), weights.begin(), weights.end());
+						offsets_.push_back(targets_.size());
+						for (auto w : targets) {
+							if (layout.part[w] != me_) {
+								ghosts_.push_back(w);
+							}
+						}
+						// other parts reaching v each keep one ghost of it
+						auto seen = std::vector<part_id>();
+						for (auto u : g.in_neighbors(v)) {
+							if (layout.part[u] != me_) {
+								seen.push_back(layout.part[u]);
+							}
+						}
+						std::sort(seen.begin(), seen.end());
+						mirrors_ += static_cast<std::size_t>(std::unique(seen.begin(), seen.end())
+						                                     - seen.begin());
+					}
+				}
+				std::sort(ghosts_.begin(), ghosts_.end());
+				ghosts_.erase(std::unique(ghosts_.begin(), ghosts_.end()), ghosts_.end());
+				ghost_owner_.reserve(ghosts_.size());
+				for (auto w : ghosts_) {
+					ghost_owner_.push_back(layout.part[w]);
+				}
+			}
+
+			// answers commands until told to stop or the coordinator goes away
+			auto serve(int control, std::vector<int> const& peers) -> void {
+				for (;;) {
+					auto message = detail::receive_frame(control);
+					auto reply = detail::frame();
+					switch (message.get<command>()) {
+					case command::connections: {
+						auto const row = local(message.get<node_id>());
+						auto const first = targets_.begin() + static_cast<std::ptrdiff_t>(row.first);
+						auto const last = targets_.begin() + static_cast<std::ptrdiff_t>(row.second);
+						auto targets = std::vector<node_id>(first, last);
+						targets.erase(std::unique(targets.begin(), targets.end()), targets.end());
+						reply.put_all(targets);
+						break;
+					}
+					case command::weights: {
+						auto const row = local(message.get<node_id>());
+						auto const dst = message.get<node_id>();
+						auto res = std::vector<E>();
+						for (auto e = row.first; e < row.second; ++e) {
+							if (targets_[e] == dst) {
+								res.push_back(weights_[e]);
+							}
+						}
+						reply.put_all(res);
+						break;
+					}
+					case command::stats:
+						reply.put(shard_stats{owned_.size(), targets_.size(), ghosts_.size(), mirrors_});
+						break;
+					case command::hops_start: start_hops(message.get<node_id>()); break;
+					case command::hops_step:
+						reply.put(step_hops(message.get<std::uint64_t>(), peers));
+						break;
+					case command::hops_collect: reply.put_all(owned_).put_all(distance_); break;
+					case command::shutdown: return;
+					}
+					detail::send_frame(control, reply);
+				}
+			}
+
+		private:
+			part_id me_;
+			// owned global ids, ascending, and their rows
+			std::vector<node_id> owned_;
+			std::vector<std::size_t> offsets_;
+			std::vector<node_id> targets_;
+			std::vector<E> weights_;
+			// ghost global ids, ascending, and the part owning each
+			std::vector<node_id> ghosts_;
+			std::vector<part_id> ghost_owner_;
+			std::size_t mirrors_ = 0;
+
+			std::vector<std::uint64_t> distance_;
+			std::vector<std::uint8_t> ghost_sent_;
+			std::vector<std::size_t> frontier_;
+
+			auto local_index(node_id id) const -> std::size_t {
+				return static_cast<std::size_t>(std::lower_bound(owned_.begin(), owned_.end(), id)
+				                                - owned_.begin());
+			}
+
+			auto local(node_id id) const -> std::pair<std::size_t, std::size_t> {
+				auto const i = local_index(id);
+				return {offsets_[i], offsets_[i + 1]};
+			}
+
+			auto start_hops(node_id source) -> void {
+				distance_.assign(owned_.size(), unreached);
+				ghost_sent_.assign(ghosts_.size(), 0);
+				frontier_.clear();
+				auto const i = local_index(source);
+				if (i < owned_.size() && owned_[i] == source) {
+					distance_[i] = 0;
+					frontier_.push_back(i);
+				}
+			}
+
+			// expands the frontier at level, swaps ghost batches with every peer, and returns
+			// how many owned nodes were reached for the first time
+			auto step_hops(std::uint64_t level, std::vector<int> const& peers) -> std::uint64_t {
+				auto batches = std::vector<std::vector<node_id>>(peers.size() + 1);
+				auto next = std::vector<std::size_t>();
+				auto reached = std::uint64_t{0};
+				auto visit = [&](std::size_t i) {
+					if (distance_[i] == unreached) {
+						distance_[i] = level + 1;
+						next.push_back(i);
+						++reached;
+					}
+				};
+
+				for (auto i : frontier_) {
+					for (auto e = offsets_[i]; e < offsets_[i + 1]; ++e) {
+						auto const w = targets_[e];
+						auto const g = std::lower_bound(ghosts_.begin(), ghosts_.end(), w);
+						if (g == ghosts_.end() || *g != w) {
+							visit(local_index(w));
+							continue;
+						}
+						auto const ghost = static_cast<std::size_t>(g - ghosts_.begin());
+						if (ghost_sent_[ghost] == 0) {
+							ghost_sent_[ghost] = 1;
+							batches[ghost_owner_[ghost]].push_back(w);
+						}
+					}
+				}
+
+				// peers are indexed by part with this shard left out
+				auto outgoing = std::vector<detail::frame>();
+				for (auto p = part_id{0}; p <= peers.size(); ++p) {
+					if (p != me_) {
+						outgoing.push_back(detail::frame().put_all(batches[p]));
+					}
+				}
+				for (auto& incoming : detail::exchange_frames(peers, outgoing)) {
+					for (auto w : incoming.get_all<node_id>()) {
+						visit(local_index(w));
+					}
+				}
+				frontier_ = std::move(next);
+				return reached;
+			}
+		};
+
+		std::vector<N> nodes_;
+		bool sorted_ = true;
+		// ids in ascending N order when they aren't already
+		std::vector<node_id> by_value_;
+		partitioning layout_;
+		std::vector<detail::socket_fd> workers_;
+		std::vector<pid_t> pids_;
+
+		using socket_pairs = std::vector<std::pair<detail::socket_fd, detail::socket_fd>>;
+
+		// the body of worker p's process, which never returns to the caller
+		[[noreturn]] auto run_worker(frozen_graph<N, E> const& g,
+		                             part_id p,
+		                             socket_pairs& control,
+		                             std::vector<std::vector<detail::socket_fd>>& mesh) -> void {
+			auto peers = std::vector<int>();
+			for (auto q = part_id{0}; q < control.size(); ++q) {
+				control[q].first.close();
+				if (q != p) {
+					control[q].second.close();
+					for (auto& end : mesh[q]) {
+						end.close();
+					}
+					peers.push_back(mesh[p][q].get());
+				}
+			}
+			for (auto& worker : workers_) {
+				worker.close();
+			}
+
+			auto code = EXIT_SUCCESS;
+			try {
+				auto mine = shard(g, layout_, p);
+				mine.serve(control[p].second.get(), peers);
+			} catch (...) {
+				code = EXIT_FAILURE;
+			}
+			// skips destructors and atexit handlers that belong to the coordinator
+			::_exit(code);
+		}
+
+		auto find(N const& value) const -> std::optional<node_id> {
+			if (sorted_) {
+				auto found = std::lower_bound(nodes_.begin(), nodes_.end(), value);
+				if (found == nodes_.end() || value < *found) {
+					return std::nullopt;
+				}
+				return static_cast<node_id>(found - nodes_.begin());
+			}
+			auto found = std::lower_bound(by_value_.begin(),
+			                              by_value_.end(),
+			                              value,
+			                              [&](node_id id, N const& v) { return nodes_[id] < v; });
+			if (found == by_value_.end() || value < nodes_[*found]) {
+				return std::nullopt;
+			}
+			return *found;
+		}
+
+		auto id_of(N const& value, char const* caller) const -> node_id {
+			auto const id = find(value);
+			if (!id) {
+				throw std::runtime_error(std::string("Cannot call gdwg::sharded_graph<N, E>::") + caller
+				                         + " if src doesn't exist in the graph");
+			}
+			return *id;
+		}
+
+		auto request(part_id p, detail::frame const& message) const -> detail::frame {
+			detail::send_frame(workers_[p].get(), message);
+			return detail::receive_frame(workers_[p].get());
+		}
+
+		// sends message to every worker before waiting on any, since they may need each other
+		auto broadcast(detail::frame const& message) const -> std::vector<detail::frame> {
+			for (auto const& worker : workers_) {
+				detail::send_frame(worker.get(), message);
+			}
+			auto replies = std::vector<detail::frame>();
+			for (auto const& worker : workers_) {
+				replies.push_back(detail::receive_frame(worker.get()));
+			}
+			return replies;
+		}
+	};
+} // namespace gdwg
+
+#endif // GDWG_SHARDED_GRAPH_HPP
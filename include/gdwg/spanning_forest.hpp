@@ -0,0 +1,266 @@
+#ifndef GDWG_SPANNING_FOREST_HPP
+#define GDWG_SPANNING_FOREST_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <numeric>
+#include <utility>
+#include <vector>
+
+#include "gdwg/components.hpp"
+#include "gdwg/detail/parallel.hpp"
+#include "gdwg/frozen_graph.hpp"
+#include "gdwg/trace.hpp"
+
+// Minimum spanning forests, taking the graph as undirected: two nodes are joined by the lightest
+// weight on any edge between them, either way round, and self loops are left out. Ties are
+// broken by the endpoints' ids, so every edge has a distinct rank, the forest is unique, and
+// both algorithms return exactly the same edges.
+//
+// Boruvka works in rounds over a flat edge list. Every round each edge offers itself to both
+// its endpoints' trees with a compare and swap, each tree keeps the lightest edge offered, those
+// edges join trees through the lock free union-find the components share, and edges now inside
+// one tree are filtered out. Trees at least halve every round, and every step is split across
+// threads. Kruskal sorts the edge list in parallel and adds edges lightest first on one thread,
+// which is there mostly to check Boruvka against.
+
+namespace gdwg {
+	enum class spanning_algorithm {
+		boruvka,
+		kruskal,
+	};
+
+	struct spanning_forest_options {
+		spanning_algorithm algorithm = spanning_algorithm::boruvka;
+		// 0 means one per hardware thread
+		std::size_t threads = 0;
+	};
+
+	// an edge of the forest between node ids u < v
+	template<typename E>
+	struct spanning_edge {
+		std::uint32_t u;
+		std::uint32_t v;
+		E weight;
+
+		friend auto operator==(spanning_edge const&, spanning_edge const&) -> bool = default;
+	};
+
+	namespace detail {
+		// lighter weight first, then lower ids, a total order over distinct pairs
+		template<typename E>
+		auto lighter(spanning_edge<E> const& left, spanning_edge<E> const& right) -> bool {
+			if (left.weight < right.weight) {
+				return true;
+			}
+			if (right.weight < left.weight) {
+				return false;
+			}
+			return std::pair(left.u, left.v) < std::pair(right.u, right.v);
+		}
+
+		// one edge per pair of distinct nodes, with the lightest weight between them
+		template<typename N, typename E>
+		auto undirected_edges(frozen_graph<N, E> const& g, std::size_t threads)
+		   -> std::vector<spanning_edge<E>> {
+			auto edges = std::vector<spanning_edge<E>>();
+			edges.reserve(g.num_edges());
+			for (auto u = std::uint32_t{0}; u < g.num_nodes(); ++u) {
+				// rows are sorted by target then weight, so the first of each run is the lightest
+				auto const targets = g.out_neighbors(u);
+				auto const weights = g.out_weights(u);
+				for (auto i = std::size_t{0}; i < targets.size(); ++i) {
+					auto const v = targets[i];
+					if (v != u && (i == 0 || v != targets[i - 1])) {
+						edges.push_back({std::min(u, v), std::max(u, v), weights[i]});
+					}
+				}
+			}
+			// each pair can still appear once from either end
+			auto const by_pair = [](spanning_edge<E> const& left, spanning_edge<E> const& right) {
+				if (left.u != right.u || left.v != right.v) {
+					return std::pair(left.u, left.v) < std::pair(right.u, right.v);
+				}
+				return left.weight < right.weight;
+			};
+			parallel_sort(edges.begin(), edges.end(), by_pair, threads);
+			auto const same_pair = [](spanning_edge<E> const& left, spanning_edge<E> const& right) {
+				return left.u == right.u && left.v == right.v;
+			};
+			edges.erase(std::unique(edges.begin(), edges.end(), same_pair), edges.end());
+			return edges;
+		}
+
+		template<typename E>
+		auto kruskal(std::size_t n, std::vector<spanning_edge<E>> edges, std::size_t threads)
+		   -> std::vector<spanning_edge<E>> {
+			parallel_sort(edges.begin(), edges.end(), lighter<E>, threads);
+			auto parent = std::vector<std::uint32_t>(n);
+			std::iota(parent.begin(), parent.end(), std::uint32_t{0});
+			// path halving
+			auto const root = [&](std::uint32_t v) {
+				while (parent[v] != v) {
+					parent[v] = parent[parent[v]];
+					v = parent[v];
+				}
+				return v;
+			};
+
+			auto forest = std::vector<spanning_edge<E>>();
+			for (auto const& e : edges) {
+				if (forest.size() + 1 >= n) {
+					break;
+				}
+				auto const a = root(e.u);
+				auto const b = root(e.v);
+				if (a != b) {
+					parent[std::max(a, b)] = std::min(a, b);
+					forest.push_back(e);
+				}
+			}
+			return forest;
+		}
+
+		template<typename E>
+		auto boruvka(std::size_t n, std::vector<spanning_edge<E>> edges, std::size_t threads)
+		   -> std::vector<spanning_edge<E>> {
+			constexpr auto none = std::numeric_limits<std::size_t>::max();
+			auto const workers = resolve_threads(threads);
+			auto parent = atomic_labels(n);
+			auto best = std::vector<std::atomic<std::size_t>>(n);
+			parallel_for(n, workers, [&](std::size_t begin, std::size_t end, std::size_t) {
+				for (auto v = begin; v < end; ++v) {
+					parent[v].store(static_cast<component_id>(v), std::memory_order_relaxed);
+				}
+			});
+			auto const tree = [&](std::uint32_t v) {
+				return parent[v].load(std::memory_order_relaxed);
+			};
+			// keeps the lightest edge offered to a tree
+			auto const offer = [&](component_id t, std::size_t e) {
+				auto current = best[t].load(std::memory_order_relaxed);
+				while (current == none || lighter(edges[e], edges[current])) {
+					if (best[t].compare_exchange_weak(current, e, std::memory_order_relaxed)) {
+						return;
+					}
+				}
+			};
+
+			auto forest = std::vector<spanning_edge<E>>();
+			auto chosen = std::vector<std::vector<spanning_edge<E>>>(workers);
+			auto kept = std::vector<std::size_t>(workers);
+			auto next = std::vector<spanning_edge<E>>();
+			while (!edges.empty()) {
+				parallel_for(n, workers, [&](std::size_t begin, std::size_t end, std::size_t) {
+					for (auto v = begin; v < end; ++v) {
+						best[v].store(none, std::memory_order_relaxed);
+					}
+				});
+				auto const m = edges.size();
+				parallel_for(m, workers, [&](std::size_t begin, std::size_t end, std::size_t) {
+					for (auto e = begin; e < end; ++e) {
+						offer(tree(edges[e].u), e);
+						offer(tree(edges[e].v), e);
+					}
+				});
+
+				// two trees that picked the same edge only add it once, from the lower tree
+				parallel_for(n, workers, [&](std::size_t begin, std::size_t end, std::size_t t) {
+					for (auto v = begin; v < end; ++v) {
+						auto const e = best[v].load(std::memory_order_relaxed);
+						if (tree(static_cast<std::uint32_t>(v)) != v || e == none) {
+							continue;
+						}
+						auto const& edge = edges[e];
+						auto const other = tree(edge.u) == v ? tree(edge.v) : tree(edge.u);
+						if (other < v && best[other].load(std::memory_order_relaxed) == e) {
+							continue;
+						}
+						chosen[t].push_back(edge);
+					}
+				});
+				auto const added = forest.size();
+				for (auto& mine : chosen) {
+					forest.insert(forest.end(), mine.begin(), mine.end());
+					mine.clear();
+				}
+				auto const joined = forest.size() - added;
+				parallel_for(joined, workers, [&](std::size_t begin, std::size_t end, std::size_t) {
+					for (auto i = added + begin; i < added + end; ++i) {
+						link(parent, forest[i].u, forest[i].v);
+					}
+				});
+				compress(parent, workers);
+
+				// drop edges inside one tree, counting per chunk first so chunks can copy at once
+				auto const chunks = std::min(workers, std::max<std::size_t>(m, 1));
+				auto const outside = [&](spanning_edge<E> const& edge) {
+					return tree(edge.u) != tree(edge.v);
+				};
+				parallel_for(m, chunks, [&](std::size_t begin, std::size_t end, std::size_t t) {
+					kept[t] = static_cast<std::size_t>(
+					   std::count_if(edges.begin() + static_cast<std::ptrdiff_t>(begin),
+					                 edges.begin() + static_cast<std::ptrdiff_t>(end),
+					                 outside));
+				});
+				auto starts = std::vector<std::size_t>(chunks + 1);
+				auto const counted = kept.begin() + static_cast<std::ptrdiff_t>(chunks);
+				std::partial_sum(kept.begin(), counted, starts.begin() + 1);
+				next.resize(starts[chunks]);
+				parallel_for(m, chunks, [&](std::size_t begin, std::size_t end, std::size_t t) {
+					std::copy_if(edges.begin() + static_cast<std::ptrdiff_t>(begin),
+					             edges.begin() + static_cast<std::ptrdiff_t>(end),
+					             next.begin() + static_cast<std::ptrdiff_t>(starts[t]),
+					             outside);
+				});
+				edges.swap(next);
+			}
+			return forest;
+		}
+	} // namespace detail
+
+	// the forest's edges, lightest first
+	template<typename N, typename E>
+	auto minimum_spanning_edges(frozen_graph<N, E> const& g,
+	                            spanning_forest_options const& options = {})
+	   -> std::vector<spanning_edge<E>> {
+		[[maybe_unused]] auto const span = trace::span("gdwg::minimum_spanning_edges");
+		auto edges = detail::undirected_edges(g, options.threads);
+		auto const n = g.num_nodes();
+		auto forest = options.algorithm == spanning_algorithm::kruskal
+		                 ? detail::kruskal(n, std::move(edges), options.threads)
+		                 : detail::boruvka(n, std::move(edges), options.threads);
+		detail::parallel_sort(forest.begin(), forest.end(), detail::lighter<E>, options.threads);
+		return forest;
+	}
+
+	// ids line up with g.nodes()
+	template<typename N, typename E>
+	auto minimum_spanning_edges(graph<N, E> const& g, spanning_forest_options const& options = {})
+	   -> std::vector<spanning_edge<E>> {
+		return minimum_spanning_edges(frozen_graph<N, E>(g), options);
+	}
+
+	// every node of g, joined by the forest's edges, each from its lower node to its higher one
+	template<typename N, typename E>
+	auto minimum_spanning_forest(graph<N, E> const& g, spanning_forest_options const& options = {})
+	   -> graph<N, E> {
+		auto const frozen = frozen_graph<N, E>(g);
+		auto const forest = minimum_spanning_edges(frozen, options);
+		[[maybe_unused]] auto const span = trace::span("gdwg::minimum_spanning_forest");
+		auto result = graph<N, E>(frozen.nodes().begin(), frozen.nodes().end());
+		auto batch = typename graph<N, E>::batch();
+		batch.reserve(forest.size());
+		for (auto const& [u, v, weight] : forest) {
+			batch.push_back(
+			   {graph<N, E>::edge_operation::kind::insert, frozen.node(u), frozen.node(v), weight});
+		}
+		result.apply(batch);
+		return result;
+	}
+} // namespace gdwg
+
+#endif // GDWG_SPANNING_FOREST_HPP
@@ -0,0 +1,284 @@
+#ifndef GDWG_TEMPORAL_GRAPH_HPP
+#define GDWG_TEMPORAL_GRAPH_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include "gdwg/graph.hpp"
+#include "gdwg/trace.hpp"
+
+// A graph of timestamped edge events that only remembers a sliding window of time, for streams
+// where an edge matters for the last few minutes. Time is cut into panes of pane_width, and the
+// window is the pane holding the newest timestamp seen plus the panes - 1 before it. Each event
+// is appended to its pane's list along with iterators to the adjacency entries it counts towards,
+// so when time moves past a pane the whole pane is evicted in one batch at constant cost per event
+// and no searching. Queries only ever see the window, and memory is bounded by what arrives in
+// one window however long the stream runs.
+//
+// The same edge arriving several times in the window is one edge with a count. Nodes exist only
+// while an edge in the window touches them, so a node whose edges have expired is simply gone.
+
+namespace gdwg {
+	template<typename N, typename E>
+	class temporal_graph {
+	public:
+		using timestamp = std::int64_t;
+		using value_type = typename graph<N, E>::value_type;
+
+		temporal_graph(timestamp pane_width, std::size_t panes)
+		: pane_width_(pane_width)
+		, panes_(panes) {
+			if (pane_width <= 0 || panes == 0) {
+				throw std::runtime_error("Cannot create a gdwg::temporal_graph<N, E> with an empty "
+				                         "window");
+			}
+		}
+
+		// records an edge at time at, sliding the window forward if at is past it. Returns false,
+		// and drops the edge, if at is already older than the window
+		auto insert_edge(N const& src, N const& dst, E const& weight, timestamp at) -> bool {
+			auto const index = pane_of(at);
+			advance_to(index);
+			if (window_.empty() || index < window_.front().index) {
+				return false;
+			}
+
+			auto const src_node = touch(src);
+			auto const dst_node = touch(dst);
+			auto const row = edges_.try_emplace(src).first;
+			auto const link = row->second.try_emplace(dst).first;
+			auto const [count, added] = link->second.try_emplace(weight, 0);
+			++count->second;
+			edge_count_ += added ? 1 : 0;
+			window_[static_cast<std::size_t>(index - window_.front().index)].events.push_back(
+			   {src_node, dst_node, row, link, count});
+			++event_count_;
+			return true;
+		}
+
+		// slides the window forward to now without inserting anything, evicting expired panes
+		auto advance(timestamp now) -> void {
+			advance_to(pane_of(now));
+		}
+
+		// drops every event, keeping the window where it is
+		auto clear() noexcept -> void {
+			for (auto& pane : window_) {
+				pane.events.clear();
+			}
+			edges_.clear();
+			nodes_.clear();
+			edge_count_ = 0;
+			event_count_ = 0;
+		}
+
+		// ----------   queries, all over the current window -----------
+
+		[[nodiscard]] auto is_node(N const& value) const -> bool {
+			return nodes_.contains(value);
+		}
+
+		[[nodiscard]] auto is_connected(N const& src, N const& dst) const -> bool {
+			auto const row = edges_.find(src);
+			return row != edges_.end() && row->second.contains(dst);
+		}
+
+		// how many times the edge arrived in the window
+		[[nodiscard]] auto count(N const& src, N const& dst, E const& weight) const -> std::size_t {
+			auto const row = edges_.find(src);
+			if (row == edges_.end()) {
+				return 0;
+			}
+			auto const link = row->second.find(dst);
+			if (link == row->second.end()) {
+				return 0;
+			}
+			auto const found = link->second.find(weight);
+			return found == link->second.end() ? 0 : found->second;
+		}
+
+		// sorted, the same way graph<N, E>::nodes() is
+		[[nodiscard]] auto nodes() const -> std::vector<N> {
+			auto values = std::vector<N>();
+			values.reserve(nodes_.size());
+			for (auto const& [value, refs] : nodes_) {
+				values.push_back(value);
+			}
+			return values;
+		}
+
+		[[nodiscard]] auto connections(N const& src) const -> std::vector<N> {
+			auto values = std::vector<N>();
+			if (auto const row = edges_.find(src); row != edges_.end()) {
+				values.reserve(row->second.size());
+				for (auto const& [dst, weights] : row->second) {
+					values.push_back(dst);
+				}
+			}
+			return values;
+		}
+
+		[[nodiscard]] auto weights(N const& src, N const& dst) const -> std::vector<E> {
+			auto values = std::vector<E>();
+			if (auto const row = edges_.find(src); row != edges_.end()) {
+				if (auto const link = row->second.find(dst); link != row->second.end()) {
+					values.reserve(link->second.size());
+					for (auto const& [weight, times] : link->second) {
+						values.push_back(weight);
+					}
+				}
+			}
+			return values;
+		}
+
+		// every distinct edge in the window, ordered as graph<N, E>'s iterator orders them
+		[[nodiscard]] auto edges() const -> std::vector<value_type> {
+			auto values = std::vector<value_type>();
+			values.reserve(edge_count_);
+			for (auto const& [src, row] : edges_) {
+				for (auto const& [dst, weights] : row) {
+					for (auto const& [weight, times] : weights) {
+						values.push_back({src, dst, weight});
+					}
+				}
+			}
+			return values;
+		}
+
+		// the window as an ordinary graph, to run anything else in the library over
+		[[nodiscard]] auto to_graph() const -> graph<N, E> {
+			[[maybe_unused]] auto const span = trace::span("gdwg::temporal_graph::to_graph");
+			auto g = graph<N, E>();
+			for (auto const& [value, refs] : nodes_) {
+				g.insert_node(value);
+			}
+			auto batch = typename graph<N, E>::batch();
+			batch.reserve(edge_count_);
+			for (auto const& [src, dst, weight] : edges()) {
+				batch.push_back({graph<N, E>::edge_operation::kind::insert, src, dst, weight});
+			}
+			g.apply(batch);
+			return g;
+		}
+
+		[[nodiscard]] auto num_nodes() const noexcept -> std::size_t {
+			return nodes_.size();
+		}
+
+		// distinct edges, however many times each arrived
+		[[nodiscard]] auto num_edges() const noexcept -> std::size_t {
+			return edge_count_;
+		}
+
+		[[nodiscard]] auto num_events() const noexcept -> std::size_t {
+			return event_count_;
+		}
+
+		// the oldest timestamp still in the window, nothing before the first insert or advance
+		[[nodiscard]] auto window_start() const noexcept -> timestamp {
+			return window_.empty() ? 0 : window_.front().index * pane_width_;
+		}
+
+		// one past the newest timestamp the window holds
+		[[nodiscard]] auto window_end() const noexcept -> timestamp {
+			return window_.empty() ? 0 : (window_.back().index + 1) * pane_width_;
+		}
+
+	private:
+		// how many events mention each node
+		using node_map = std::map<N, std::size_t>;
+		using weight_map = std::map<E, std::size_t>;
+		using dst_map = std::map<N, weight_map>;
+		using src_map = std::map<N, dst_map>;
+
+		// everything an event counts towards, so evicting it needs no lookups
+		struct event {
+			typename node_map::iterator src;
+			typename node_map::iterator dst;
+			typename src_map::iterator row;
+			typename dst_map::iterator link;
+			typename weight_map::iterator count;
+		};
+
+		struct pane {
+			timestamp index = 0;
+			std::vector<event> events;
+		};
+
+		timestamp pane_width_;
+		std::size_t panes_;
+		node_map nodes_;
+		src_map edges_;
+		// oldest pane first, one per pane_width from the front's index on
+		std::deque<pane> window_;
+		std::size_t edge_count_ = 0;
+		std::size_t event_count_ = 0;
+
+		// rounds towards negative infinity, so panes are the same width either side of zero
+		auto pane_of(timestamp at) const noexcept -> timestamp {
+			auto const index = at / pane_width_;
+			return at % pane_width_ < 0 ? index - 1 : index;
+		}
+
+		auto touch(N const& value) -> typename node_map::iterator {
+			auto const node = nodes_.try_emplace(value, 0).first;
+			++node->second;
+			return node;
+		}
+
+		auto release(typename node_map::iterator node) noexcept -> void {
+			if (--node->second == 0) {
+				nodes_.erase(node);
+			}
+		}
+
+		auto advance_to(timestamp index) -> void {
+			if (!window_.empty() && index <= window_.back().index) {
+				return;
+			}
+			auto const oldest = index - static_cast<timestamp>(panes_) + 1;
+			auto spare = std::vector<event>();
+			while (!window_.empty() && window_.front().index < oldest) {
+				evict(window_.front());
+				// keep one pane's storage for the pane about to open
+				spare = std::move(window_.front().events);
+				window_.pop_front();
+			}
+			auto next = window_.empty() ? oldest : window_.back().index + 1;
+			for (; next <= index; ++next) {
+				window_.push_back({next, {}});
+			}
+			window_.back().events = std::move(spare);
+		}
+
+		auto evict(pane& expired) noexcept -> void {
+			if (expired.events.empty()) {
+				return;
+			}
+			[[maybe_unused]] auto const span = trace::span("gdwg::temporal_graph::evict");
+			for (auto const& e : expired.events) {
+				if (--e.count->second == 0) {
+					e.link->second.erase(e.count);
+					--edge_count_;
+					if (e.link->second.empty()) {
+						e.row->second.erase(e.link);
+						if (e.row->second.empty()) {
+							edges_.erase(e.row);
+						}
+					}
+				}
+				release(e.src);
+				release(e.dst);
+			}
+			event_count_ -= expired.events.size();
+			expired.events.clear();
+		}
+	};
+} // namespace gdwg
+
+#endif // GDWG_TEMPORAL_GRAPH_HPP
@@ -0,0 +1,190 @@
+#ifndef GDWG_TRACE_HPP
+#define GDWG_TRACE_HPP
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <type_traits>
+
+// Timeline spans for the expensive gdwg operations, dumped as Chrome trace JSON so they can be
+// opened in Perfetto or chrome://tracing.
+// Off by default, build with -DGDWG_TRACE=1 to record. When off a span is an empty object.
+// Each thread writes completed spans into its own fixed size ring buffer without locking, older
+// spans are overwritten once the ring is full.
+
+#ifndef GDWG_TRACE
+#define GDWG_TRACE 0
+#endif
+
+#ifndef GDWG_TRACE_RING_CAPACITY
+#define GDWG_TRACE_RING_CAPACITY 4096
+#endif
+
+namespace gdwg::trace {
+	inline constexpr std::size_t ring_capacity = GDWG_TRACE_RING_CAPACITY;
+
+	namespace detail {
+		inline auto now_ns() noexcept -> std::int64_t {
+			return std::chrono::duration_cast<std::chrono::nanoseconds>(
+			          std::chrono::steady_clock::now().time_since_epoch())
+			   .count();
+		}
+
+		// one completed span, fields are atomics so a dump can run while the owner keeps writing
+		struct slot {
+			// odd while the owning thread is rewriting the slot
+			std::atomic<std::uint64_t> sequence{0};
+			std::atomic<char const*> name{nullptr};
+			std::atomic<std::uint32_t> thread{0};
+			std::atomic<std::int64_t> start_ns{0};
+			std::atomic<std::int64_t> duration_ns{0};
+		};
+
+		// single writer ring, readers validate each slot with its sequence number
+		struct ring {
+			std::array<slot, ring_capacity> slots{};
+			std::atomic<std::uint64_t> head{0};
+			std::atomic<bool> in_use{true};
+			ring* next = nullptr;
+
+			auto push(char const* name,
+			          std::uint32_t thread,
+			          std::int64_t start,
+			          std::int64_t end) noexcept -> void {
+				auto const h = head.load(std::memory_order_relaxed);
+				auto& s = slots[h % ring_capacity];
+				auto const seq = s.sequence.load(std::memory_order_relaxed);
+				s.sequence.store(seq + 1, std::memory_order_relaxed);
+				std::atomic_thread_fence(std::memory_order_release);
+				s.name.store(name, std::memory_order_relaxed);
+				s.thread.store(thread, std::memory_order_relaxed);
+				s.start_ns.store(start, std::memory_order_relaxed);
+				s.duration_ns.store(end - start, std::memory_order_relaxed);
+				s.sequence.store(seq + 2, std::memory_order_release);
+				head.store(h + 1, std::memory_order_release);
+			}
+		};
+
+		// rings are never freed, a ring whose thread exited is handed to the next new thread
+		inline std::atomic<ring*> rings{nullptr};
+		inline std::atomic<std::uint32_t> next_thread{1};
+
+		inline auto acquire_ring() -> ring* {
+			for (auto* r = rings.load(std::memory_order_acquire); r != nullptr; r = r->next) {
+				auto free = false;
+				if (r->in_use.compare_exchange_strong(free, true, std::memory_order_acq_rel)) {
+					return r;
+				}
+			}
+			auto* r = new ring{};
+			r->next = rings.load(std::memory_order_relaxed);
+			while (!rings.compare_exchange_weak(r->next, r, std::memory_order_release)) {
+			}
+			return r;
+		}
+
+		struct thread_ring {
+			ring* buffer = acquire_ring();
+			std::uint32_t thread = next_thread.fetch_add(1, std::memory_order_relaxed);
+
+			thread_ring() = default;
+			thread_ring(thread_ring const&) = delete;
+			auto operator=(thread_ring const&) -> thread_ring& = delete;
+
+			~thread_ring() {
+				buffer->in_use.store(false, std::memory_order_release);
+			}
+		};
+
+		inline auto local_ring() -> thread_ring& {
+			thread_local auto local = thread_ring{};
+			return local;
+		}
+
+		inline auto write_json_string(std::ostream& os, char const* text) -> void {
+			os << '"';
+			for (; *text != '\0'; ++text) {
+				if (*text == '"' || *text == '\\') {
+					os << '\\';
+				}
+				os << *text;
+			}
+			os << '"';
+		}
+	} // namespace detail
+
+	// records nothing
+	class null_span {
+	public:
+		explicit null_span(char const* /*name*/) noexcept {}
+	};
+
+	// records [construction, destruction) under a name with static storage duration
+	class recording_span {
+	public:
+		explicit recording_span(char const* name) noexcept
+		: name_(name)
+		, start_(detail::now_ns()) {}
+
+		recording_span(recording_span const&) = delete;
+		auto operator=(recording_span const&) -> recording_span& = delete;
+
+		~recording_span() {
+			auto& local = detail::local_ring();
+			local.buffer->push(name_, local.thread, start_, detail::now_ns());
+		}
+
+	private:
+		char const* name_;
+		std::int64_t start_;
+	};
+
+	using span = std::conditional_t<GDWG_TRACE != 0, recording_span, null_span>;
+
+	// every span still held in a ring, as a Chrome trace event file. Timestamps are steady_clock
+	// microseconds
+	inline auto write_chrome_json(std::ostream& os) -> void {
+		os << "{\"traceEvents\":[";
+		auto first = true;
+		for (auto* r = detail::rings.load(std::memory_order_acquire); r != nullptr; r = r->next) {
+			auto const head = r->head.load(std::memory_order_acquire);
+			auto const tail = head > ring_capacity ? head - ring_capacity : 0;
+			for (auto i = tail; i < head; ++i) {
+				auto const& s = r->slots[i % ring_capacity];
+				auto const before = s.sequence.load(std::memory_order_acquire);
+				auto const* name = s.name.load(std::memory_order_relaxed);
+				auto const thread = s.thread.load(std::memory_order_relaxed);
+				auto const start = s.start_ns.load(std::memory_order_relaxed);
+				auto const duration = s.duration_ns.load(std::memory_order_relaxed);
+				std::atomic_thread_fence(std::memory_order_acquire);
+				// skip slots rewritten while we were reading them
+				if (before % 2 != 0 || before != s.sequence.load(std::memory_order_relaxed)
+				    || name == nullptr)
+				{
+					continue;
+				}
+
+				os << (first ? "\n" : ",\n") << "{\"name\":";
+				detail::write_json_string(os, name);
+				os << ",\"cat\":\"gdwg\",\"ph\":\"X\",\"pid\":1,\"tid\":" << thread
+				   << ",\"ts\":" << start / 1000 << '.' << (start % 1000) / 100 << (start % 100) / 10
+				   << start % 10 << ",\"dur\":" << duration / 1000 << '.' << (duration % 1000) / 100
+				   << (duration % 100) / 10 << duration % 10 << '}';
+				first = false;
+			}
+		}
+		os << "\n]}\n";
+	}
+
+	// drops every recorded span, only call while no thread is inside a span
+	inline auto clear() noexcept -> void {
+		for (auto* r = detail::rings.load(std::memory_order_acquire); r != nullptr; r = r->next) {
+			r->head.store(0, std::memory_order_release);
+		}
+	}
+} // namespace gdwg::trace
+
+#endif // GDWG_TRACE_HPP
@@ -0,0 +1,132 @@
+#ifndef GDWG_TRAVERSAL_HPP
+#define GDWG_TRAVERSAL_HPP
+
+#include <cstddef>
+#include <deque>
+#include <set>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include "gdwg/detail/generator.hpp"
+#include "gdwg/graph.hpp"
+
+// Lazy traversals of a gdwg::graph as coroutine generators. Each one walks the graph's own maps a
+// step at a time as the consumer advances, so breaking out of the loop, or taking the first few
+// with std::views::take, never pays for the rest of the traversal and never builds the
+// connections() vectors. The graph must outlive the generator and must not be modified while it
+// is being walked. src is checked when the traversal is made, not when it is first advanced.
+
+namespace gdwg {
+	namespace detail {
+		// orders node pointers by the nodes they point at, the graph keeps a separate copy of a
+		// node for every edge it appears in
+		template<typename N>
+		struct pointee_less {
+			auto operator()(N const* left, N const* right) const -> bool {
+				return *left < *right;
+			}
+		};
+
+		template<typename N, typename E>
+		auto edges_from_impl(graph<N, E> const& g, N src)
+		   -> generator<typename graph<N, E>::value_type> {
+			using value_type = typename graph<N, E>::value_type;
+			auto const& edges = graph_access::edges(g);
+			auto const row = edges.find(src);
+			if (row == edges.end()) {
+				co_return;
+			}
+			for (auto const& [dst, weights] : row->second) {
+				for (auto const& weight : weights) {
+					// named, gcc 12 destroys an aggregate temporary in a co_yield twice
+					auto const edge = value_type{*row->first, *dst, *weight};
+					co_yield edge;
+				}
+			}
+		}
+
+		template<typename N, typename E>
+		auto bfs_impl(graph<N, E> const& g, N src) -> generator<N> {
+			auto const& edges = graph_access::edges(g);
+			auto const& start = *graph_access::nodes(g).find(src)->first;
+			auto seen = std::set<N const*, pointee_less<N>>{&start};
+			auto queue = std::deque<N const*>{&start};
+			while (!queue.empty()) {
+				auto const* current = queue.front();
+				queue.pop_front();
+				co_yield *current;
+				auto const row = edges.find(*current);
+				if (row == edges.end()) {
+					continue;
+				}
+				for (auto const& [dst, weights] : row->second) {
+					if (seen.insert(dst.get()).second) {
+						queue.push_back(dst.get());
+					}
+				}
+			}
+		}
+
+		template<typename N, typename E>
+		auto dfs_impl(graph<N, E> const& g, N src) -> generator<N> {
+			auto const& edges = graph_access::edges(g);
+			using dst_iterator = decltype(edges.begin()->second.begin());
+			// the rest of each row on the current path, as recursion would have kept it
+			auto stack = std::vector<std::pair<dst_iterator, dst_iterator>>();
+			auto const descend = [&](N const& node) {
+				auto const row = edges.find(node);
+				if (row != edges.end()) {
+					stack.emplace_back(row->second.begin(), row->second.end());
+				}
+			};
+
+			auto const& start = *graph_access::nodes(g).find(src)->first;
+			auto seen = std::set<N const*, pointee_less<N>>{&start};
+			co_yield start;
+			descend(start);
+			while (!stack.empty()) {
+				auto& [next, end] = stack.back();
+				if (next == end) {
+					stack.pop_back();
+					continue;
+				}
+				auto const& dst = *(next++)->first;
+				if (seen.insert(&dst).second) {
+					co_yield dst;
+					descend(dst);
+				}
+			}
+		}
+	} // namespace detail
+
+	// every edge out of src, ordered by dst then weight as the graph's iterator has them
+	template<typename N, typename E>
+	[[nodiscard]] auto edges_from(graph<N, E> const& g, N const& src)
+	   -> detail::generator<typename graph<N, E>::value_type> {
+		if (!g.is_node(src)) {
+			throw std::runtime_error("Cannot call gdwg::edges_from if src doesn't exist in the graph");
+		}
+		return detail::edges_from_impl(g, src);
+	}
+
+	// nodes reachable from src in breadth first order, src first and ties in node order
+	template<typename N, typename E>
+	[[nodiscard]] auto bfs(graph<N, E> const& g, N const& src) -> detail::generator<N> {
+		if (!g.is_node(src)) {
+			throw std::runtime_error("Cannot call gdwg::bfs if src doesn't exist in the graph");
+		}
+		return detail::bfs_impl(g, src);
+	}
+
+	// nodes reachable from src in depth first preorder, visiting neighbours in node order
+	template<typename N, typename E>
+	[[nodiscard]] auto dfs(graph<N, E> const& g, N const& src) -> detail::generator<N> {
+		if (!g.is_node(src)) {
+			throw std::runtime_error("Cannot call gdwg::dfs if src doesn't exist in the graph");
+		}
+		return detail::dfs_impl(g, src);
+	}
+} // namespace gdwg
+
+#endif // GDWG_TRAVERSAL_HPP
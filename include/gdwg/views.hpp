@@ -0,0 +1,426 @@
+#ifndef GDWG_VIEWS_HPP
+#define GDWG_VIEWS_HPP
+
+#include <algorithm>
+#include <iterator>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "gdwg/graph.hpp"
+
+// Lazy read only views over a gdwg::graph. A view keeps a pointer to the graph and answers every
+// query from the graph's own maps, nothing is copied. The graph must outlive the view, and
+// modifying the graph invalidates iterators into the view the same way it does for the graph.
+
+namespace gdwg {
+	namespace detail {
+		// shared read api for views that hide some nodes and edges of the graph. Derived supplies
+		// node_visible(n) and edge_visible(src, dst, weight)
+		template<typename Derived, typename N, typename E>
+		class restricted_view {
+			using src_iterator = typename graph_access::src_map<N, E>::const_iterator;
+			using dst_iterator = typename graph_access::dst_map<N, E>::const_iterator;
+			using weight_iterator = typename graph_access::weight_set<N, E>::const_iterator;
+
+		public:
+			using value_type = typename graph<N, E>::value_type;
+
+			class iterator {
+			public:
+				using value_type = restricted_view::value_type;
+				using reference = value_type;
+				using pointer = void;
+				using difference_type = std::ptrdiff_t;
+				using iterator_category = std::forward_iterator_tag;
+
+				iterator() = default;
+
+				auto operator*() const -> reference {
+					return {*src_->first, *dst_->first, **weight_};
+				}
+
+				auto operator++() -> iterator& {
+					++weight_;
+					settle();
+					return *this;
+				}
+
+				auto operator++(int) -> iterator {
+					auto temp_val = *this;
+					++*this;
+					return temp_val;
+				}
+
+				auto operator==(iterator const& other) const noexcept -> bool {
+					if (src_ != other.src_) {
+						return false;
+					}
+					return src_ == src_end_ || (dst_ == other.dst_ && weight_ == other.weight_);
+				}
+
+			private:
+				friend class restricted_view;
+
+				iterator(Derived const* view, src_iterator src, src_iterator src_end)
+				: view_(view)
+				, src_(src)
+				, src_end_(src_end) {
+					enter_src();
+					settle();
+				}
+
+				auto enter_src() -> void {
+					if (src_ != src_end_) {
+						dst_ = src_->second.begin();
+						enter_dst();
+					}
+				}
+
+				auto enter_dst() -> void {
+					if (dst_ != src_->second.end()) {
+						weight_ = dst_->second.begin();
+					}
+				}
+
+				// moves forward to the first visible edge at or after the current position
+				auto settle() -> void {
+					for (; src_ != src_end_; ++src_, enter_src()) {
+						if (!view_->node_visible(*src_->first)) {
+							continue;
+						}
+						for (; dst_ != src_->second.end(); ++dst_, enter_dst()) {
+							if (!view_->node_visible(*dst_->first)) {
+								continue;
+							}
+							for (; weight_ != dst_->second.end(); ++weight_) {
+								if (view_->edge_visible(*src_->first, *dst_->first, **weight_)) {
+									return;
+								}
+							}
+						}
+					}
+				}
+
+				Derived const* view_ = nullptr;
+				src_iterator src_{};
+				src_iterator src_end_{};
+				dst_iterator dst_{};
+				weight_iterator weight_{};
+			};
+
+			[[nodiscard]] auto underlying() const noexcept -> graph<N, E> const& {
+				return *graph_;
+			}
+
+			[[nodiscard]] auto is_node(N const& value) const -> bool {
+				return graph_->is_node(value) && self().node_visible(value);
+			}
+
+			[[nodiscard]] auto empty() const -> bool {
+				auto const& nodes = graph_access::nodes(*graph_);
+				return std::none_of(nodes.begin(), nodes.end(), [this](auto const& node) {
+					return self().node_visible(*node.first);
+				});
+			}
+
+			// visible nodes in ascending order
+			[[nodiscard]] auto nodes() const -> std::vector<N> {
+				auto res_vec = std::vector<N>();
+				for (auto const& node : graph_access::nodes(*graph_)) {
+					if (self().node_visible(*node.first)) {
+						res_vec.push_back(*node.first);
+					}
+				}
+				return res_vec;
+			}
+
+			[[nodiscard]] auto is_connected(N const& src, N const& dst) const -> bool {
+				require_nodes(src, dst, "is_connected");
+				auto const* weights = weights_between(src, dst);
+				return weights != nullptr
+				       && std::any_of(weights->begin(), weights->end(), [&](auto const& weight) {
+				             return self().edge_visible(src, dst, *weight);
+				          });
+			}
+
+			// visible weights from src to dst in ascending order
+			[[nodiscard]] auto weights(N const& src, N const& dst) const -> std::vector<E> {
+				require_nodes(src, dst, "weights");
+				auto res_vector = std::vector<E>();
+				if (auto const* weights = weights_between(src, dst); weights != nullptr) {
+					for (auto const& weight : *weights) {
+						if (self().edge_visible(src, dst, *weight)) {
+							res_vector.push_back(*weight);
+						}
+					}
+				}
+				return res_vector;
+			}
+
+			// nodes reachable from src over one visible edge, in ascending order
+			[[nodiscard]] auto connections(N const& src) const -> std::vector<N> {
+				if (!is_node(src)) {
+					throw std::runtime_error(Derived::error_prefix()
+					                         + "::connections if src doesn't exist in the view");
+				}
+				auto res_vector = std::vector<N>();
+				auto const& edges = graph_access::edges(*graph_);
+				auto outer_key = edges.find(src);
+				if (outer_key == edges.end()) {
+					return res_vector;
+				}
+				for (auto const& [dst, weights] : outer_key->second) {
+					if (!self().node_visible(*dst)) {
+						continue;
+					}
+					if (std::any_of(weights.begin(), weights.end(), [&](auto const& weight) {
+						    return self().edge_visible(src, *dst, *weight);
+					    }))
+					{
+						res_vector.push_back(*dst);
+					}
+				}
+				return res_vector;
+			}
+
+			[[nodiscard]] auto begin() const -> iterator {
+				auto const& edges = graph_access::edges(*graph_);
+				return iterator(&self(), edges.begin(), edges.end());
+			}
+
+			[[nodiscard]] auto end() const -> iterator {
+				auto const& edges = graph_access::edges(*graph_);
+				return iterator(&self(), edges.end(), edges.end());
+			}
+
+		protected:
+			explicit restricted_view(graph<N, E> const& g) noexcept
+			: graph_(&g) {}
+
+		private:
+			auto self() const noexcept -> Derived const& {
+				return static_cast<Derived const&>(*this);
+			}
+
+			auto require_nodes(N const& src, N const& dst, char const* caller) const -> void {
+				if (!is_node(src) || !is_node(dst)) {
+					throw std::runtime_error(Derived::error_prefix() + "::" + caller
+					                         + " if src or dst node don't exist in the view");
+				}
+			}
+
+			auto weights_between(N const& src, N const& dst) const
+			   -> graph_access::weight_set<N, E> const* {
+				auto const& edges = graph_access::edges(*graph_);
+				auto outer_key = edges.find(src);
+				if (outer_key == edges.end()) {
+					return nullptr;
+				}
+				auto inner_key = outer_key->second.find(dst);
+				return inner_key == outer_key->second.end() ? nullptr : &inner_key->second;
+			}
+
+			graph<N, E> const* graph_;
+		};
+	} // namespace detail
+
+	// the graph with only the edges pred(src, dst, weight) accepts, every node stays visible
+	template<typename N, typename E, typename Pred>
+	class filtered_view : public detail::restricted_view<filtered_view<N, E, Pred>, N, E> {
+	public:
+		filtered_view(graph<N, E> const& g, Pred pred)
+		: detail::restricted_view<filtered_view, N, E>(g)
+		, pred_(std::move(pred)) {}
+
+		[[nodiscard]] auto node_visible(N const& /*value*/) const noexcept -> bool {
+			return true;
+		}
+
+		[[nodiscard]] auto edge_visible(N const& src, N const& dst, E const& weight) const -> bool {
+			return pred_(src, dst, weight);
+		}
+
+		static auto error_prefix() -> std::string {
+			return "Cannot call gdwg::filtered_view<N, E>";
+		}
+
+	private:
+		Pred pred_;
+	};
+
+	// the graph restricted to a set of nodes and the edges between them. Members of the set that
+	// aren't nodes of the graph are ignored
+	template<typename N, typename E>
+	class induced_subgraph_view : public detail::restricted_view<induced_subgraph_view<N, E>, N, E> {
+	public:
+		induced_subgraph_view(graph<N, E> const& g, std::set<N> nodes)
+		: detail::restricted_view<induced_subgraph_view, N, E>(g)
+		, nodes_(std::move(nodes)) {}
+
+		[[nodiscard]] auto node_visible(N const& value) const -> bool {
+			return nodes_.find(value) != nodes_.end();
+		}
+
+		[[nodiscard]] auto
+		edge_visible(N const& /*src*/, N const& /*dst*/, E const& /*weight*/) const noexcept -> bool {
+			return true;
+		}
+
+		static auto error_prefix() -> std::string {
+			return "Cannot call gdwg::induced_subgraph_view<N, E>";
+		}
+
+	private:
+		std::set<N> nodes_;
+	};
+
+	// the graph with every edge reversed. Reverse lookups (connections, iteration) probe every
+	// source's adjacency map, so they cost O(sources * log(degree)) per node instead of a walk
+	template<typename N, typename E>
+	class transpose_view {
+		using node_map = detail::graph_access::node_map<N, E>;
+		using src_map = detail::graph_access::src_map<N, E>;
+		using weight_iterator = typename detail::graph_access::weight_set<N, E>::const_iterator;
+
+	public:
+		using value_type = typename graph<N, E>::value_type;
+
+		class iterator {
+		public:
+			using value_type = transpose_view::value_type;
+			using reference = value_type;
+			using pointer = void;
+			using difference_type = std::ptrdiff_t;
+			using iterator_category = std::forward_iterator_tag;
+
+			iterator() = default;
+
+			auto operator*() const -> reference {
+				return {*to_->first, *from_->first, **weight_};
+			}
+
+			auto operator++() -> iterator& {
+				if (++weight_ == weights_end_) {
+					++from_;
+					settle();
+				}
+				return *this;
+			}
+
+			auto operator++(int) -> iterator {
+				auto temp_val = *this;
+				++*this;
+				return temp_val;
+			}
+
+			auto operator==(iterator const& other) const noexcept -> bool {
+				if (to_ != other.to_) {
+					return false;
+				}
+				return to_ == nodes_->end() || (from_ == other.from_ && weight_ == other.weight_);
+			}
+
+		private:
+			friend class transpose_view;
+
+			iterator(node_map const& nodes, src_map const& edges, typename node_map::const_iterator to)
+			: nodes_(&nodes)
+			, edges_(&edges)
+			, to_(to)
+			, from_(edges.begin()) {
+				settle();
+			}
+
+			// finds the next original source with an edge into to_, moving on to later nodes as
+			// each one runs out
+			auto settle() -> void {
+				for (; to_ != nodes_->end(); ++to_, from_ = edges_->begin()) {
+					for (; from_ != edges_->end(); ++from_) {
+						auto inner_key = from_->second.find(*to_->first);
+						if (inner_key != from_->second.end()) {
+							weight_ = inner_key->second.begin();
+							weights_end_ = inner_key->second.end();
+							return;
+						}
+					}
+				}
+			}
+
+			node_map const* nodes_ = nullptr;
+			src_map const* edges_ = nullptr;
+			typename node_map::const_iterator to_{};
+			typename src_map::const_iterator from_{};
+			weight_iterator weight_{};
+			weight_iterator weights_end_{};
+		};
+
+		explicit transpose_view(graph<N, E> const& g) noexcept
+		: graph_(&g) {}
+
+		[[nodiscard]] auto underlying() const noexcept -> graph<N, E> const& {
+			return *graph_;
+		}
+
+		[[nodiscard]] auto is_node(N const& value) const -> bool {
+			return graph_->is_node(value);
+		}
+
+		[[nodiscard]] auto empty() const -> bool {
+			return graph_->empty();
+		}
+
+		[[nodiscard]] auto nodes() const -> std::vector<N> {
+			return graph_->nodes();
+		}
+
+		[[nodiscard]] auto is_connected(N const& src, N const& dst) const -> bool {
+			require_nodes(src, dst, "is_connected");
+			return graph_->is_connected(dst, src);
+		}
+
+		[[nodiscard]] auto weights(N const& src, N const& dst) const -> std::vector<E> {
+			require_nodes(src, dst, "weights");
+			return graph_->weights(dst, src);
+		}
+
+		// nodes with an edge into src in the underlying graph, in ascending order
+		[[nodiscard]] auto connections(N const& src) const -> std::vector<N> {
+			if (!is_node(src)) {
+				throw std::runtime_error("Cannot call gdwg::transpose_view<N, E>::connections if src "
+				                         "doesn't exist in the view");
+			}
+			auto res_vector = std::vector<N>();
+			for (auto const& [from, dsts] : detail::graph_access::edges(*graph_)) {
+				if (dsts.find(src) != dsts.end()) {
+					res_vector.push_back(*from);
+				}
+			}
+			return res_vector;
+		}
+
+		[[nodiscard]] auto begin() const -> iterator {
+			auto const& nodes = detail::graph_access::nodes(*graph_);
+			return iterator(nodes, detail::graph_access::edges(*graph_), nodes.begin());
+		}
+
+		[[nodiscard]] auto end() const -> iterator {
+			auto const& nodes = detail::graph_access::nodes(*graph_);
+			return iterator(nodes, detail::graph_access::edges(*graph_), nodes.end());
+		}
+
+	private:
+		auto require_nodes(N const& src, N const& dst, char const* caller) const -> void {
+			if (!is_node(src) || !is_node(dst)) {
+				throw std::runtime_error(std::string("Cannot call gdwg::transpose_view<N, E>::")
+				                         + caller + " if src or dst node don't exist in the view");
+			}
+		}
+
+		graph<N, E> const* graph_;
+	};
+} // namespace gdwg
+
+#endif // GDWG_VIEWS_HPP
@@ -0,0 +1,482 @@
+#ifndef GDWG_WRITE_AHEAD_LOG_HPP
+#define GDWG_WRITE_AHEAD_LOG_HPP
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <exception>
+#include <filesystem>
+#include <optional>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "gdwg/detail/attached_observer.hpp"
+#include "gdwg/detail/crc32.hpp"
+#include "gdwg/detail/file.hpp"
+#include "gdwg/detail/varint.hpp"
+#include "gdwg/graph.hpp"
+#include "gdwg/serializer.hpp"
+#include "gdwg/trace.hpp"
+
+// Crash safe persistence for a gdwg::graph, kept in one directory. Every change made to the graph
+// is appended to a write ahead log as a checksummed record. Records are buffered and written with
+// one sync per group of changes, so durability costs one disk flush per group rather than per
+// change, and commit() flushes whatever is buffered. Every so often the whole graph is written
+// out as a compact snapshot and the log started afresh, so recovery loads the snapshot and
+// replays only what was logged since. A crash part way through writing a group leaves a record
+// whose checksum fails, recovery drops it and everything after it.
+//
+// Snapshots and logs carry a generation number. A new snapshot is renamed into place before its
+// empty log, so a crash between the two leaves an older log that recovery knows to ignore.
+
+namespace gdwg {
+	struct wal_options {
+		// changes buffered before they are written and synced as one group
+		std::size_t group_size = 64;
+		// records logged since the last snapshot before commit() takes a new one, 0 never does
+		std::size_t snapshot_every = 65536;
+	};
+
+	// what the constructor found in the directory
+	struct recovery_stats {
+		std::size_t snapshot_nodes = 0;
+		std::size_t snapshot_edges = 0;
+		// log records applied on top of the snapshot
+		std::size_t replayed = 0;
+		// a partly written group at the end of the log was dropped
+		bool torn_tail = false;
+	};
+
+	// N and E need a gdwg::serializer, see gdwg/serializer.hpp
+	template<typename N, typename E>
+	class write_ahead_log : private detail::attached_observer<N, E> {
+	public:
+		// recovers g from directory if it holds a snapshot, in which case g must be empty, or
+		// starts the directory off with a snapshot of g. Logs every later change to g
+		write_ahead_log(graph<N, E>& g, std::filesystem::path directory, wal_options options = {})
+		: detail::attached_observer<N, E>(g)
+		, directory_(std::move(directory))
+		, options_(options) {
+			[[maybe_unused]] auto const span = trace::span("gdwg::write_ahead_log::recover");
+			std::filesystem::create_directories(directory_);
+			recover();
+			this->subscribe();
+		}
+
+		// commits what is buffered, if it can
+		~write_ahead_log() override {
+			try {
+				commit();
+			} catch (...) {
+			}
+		}
+
+		// returns once every change made so far would survive a crash
+		auto commit() -> void {
+			if (auto error = std::exchange(error_, nullptr)) {
+				std::rethrow_exception(error);
+			}
+			if (snapshot_needed_) {
+				if (this->graph_ != nullptr) {
+					checkpoint();
+				}
+				return;
+			}
+			write_group();
+			if (options_.snapshot_every != 0 && log_records_ >= options_.snapshot_every
+			    && this->graph_ != nullptr)
+			{
+				checkpoint();
+			}
+		}
+
+		// writes a snapshot of the graph and starts an empty log
+		auto checkpoint() -> void {
+			[[maybe_unused]] auto const span = trace::span("gdwg::write_ahead_log::checkpoint");
+			if (this->graph_ == nullptr) {
+				throw std::runtime_error("Cannot call gdwg::write_ahead_log<N, E>::checkpoint once the "
+				                         "graph has been destroyed");
+			}
+			auto const generation = generation_ + 1;
+			detail::replace_file(directory_ / snapshot_name, encode_snapshot(generation));
+			start_log(generation);
+			generation_ = generation;
+			pending_.clear();
+			pending_records_ = 0;
+			snapshot_needed_ = false;
+		}
+
+		[[nodiscard]] auto recovered() const noexcept -> recovery_stats const& {
+			return recovered_;
+		}
+
+		// changes made but not yet synced to disk
+		[[nodiscard]] auto pending() const noexcept -> std::size_t {
+			return pending_records_;
+		}
+
+		// records in the log since the last snapshot, what a recovery would replay
+		[[nodiscard]] auto log_records() const noexcept -> std::size_t {
+			return log_records_;
+		}
+
+		[[nodiscard]] auto directory() const noexcept -> std::filesystem::path const& {
+			return directory_;
+		}
+
+	private:
+		enum class kind : std::uint8_t {
+			insert_node = 1,
+			erase_node,
+			replace_node,
+			insert_edge,
+			erase_edge,
+		};
+
+		static constexpr auto snapshot_name = "snapshot";
+		static constexpr auto log_name = "wal";
+		static constexpr auto snapshot_magic =
+		   std::array<char, 8>{'G', 'D', 'W', 'G', 'S', 'N', 'A', 'P'};
+		static constexpr auto log_magic = std::array<char, 8>{'G', 'D', 'W', 'G', 'W', 'A', 'L', '1'};
+		// magic and generation
+		static constexpr std::size_t header_size = 16;
+		// payload length and checksum before each record
+		static constexpr std::size_t record_header_size = 8;
+
+		std::filesystem::path directory_;
+		wal_options options_;
+		recovery_stats recovered_;
+		detail::file log_;
+		std::uint64_t generation_ = 0;
+		// bytes of the log known to be whole, where it is cut back to if a write fails
+		std::size_t log_size_ = 0;
+		std::size_t log_records_ = 0;
+		std::vector<std::uint8_t> pending_;
+		std::size_t pending_records_ = 0;
+		// the graph was cleared or assigned to, so only a snapshot can describe it
+		bool snapshot_needed_ = false;
+		// a write from inside a hook failed, commit() throws it
+		std::exception_ptr error_;
+
+		// ----------   logging -----------
+
+		auto node_inserted(N const& value) -> void override {
+			log(kind::insert_node, [&] { serializer<N>::put(pending_, value); });
+		}
+
+		auto node_erased(N const& value) -> void override {
+			log(kind::erase_node, [&] { serializer<N>::put(pending_, value); });
+		}
+
+		auto node_replaced(N const& old_data, N const& new_data) -> void override {
+			log(kind::replace_node, [&] {
+				serializer<N>::put(pending_, old_data);
+				serializer<N>::put(pending_, new_data);
+			});
+		}
+
+		auto edge_inserted(N const& src, N const& dst, E const& weight) -> void override {
+			log(kind::insert_edge, [&] { put_edge(src, dst, weight); });
+		}
+
+		auto edge_erased(N const& src, N const& dst, E const& weight) -> void override {
+			log(kind::erase_edge, [&] { put_edge(src, dst, weight); });
+		}
+
+		auto reloaded() -> void override {
+			snapshot_needed_ = true;
+			pending_.clear();
+			pending_records_ = 0;
+		}
+
+		auto put_edge(N const& src, N const& dst, E const& weight) -> void {
+			serializer<N>::put(pending_, src);
+			serializer<N>::put(pending_, dst);
+			serializer<E>::put(pending_, weight);
+		}
+
+		// hooks can't throw, so a failure is kept for commit()
+		template<typename Payload>
+		auto log(kind what, Payload&& payload) noexcept -> void {
+			if (snapshot_needed_) {
+				return;
+			}
+			auto const start = pending_.size();
+			try {
+				pending_.resize(start + record_header_size);
+				pending_.push_back(static_cast<std::uint8_t>(what));
+				payload();
+				seal(start);
+				++pending_records_;
+			} catch (...) {
+				pending_.resize(start);
+				error_ = std::current_exception();
+				return;
+			}
+			if (pending_records_ >= options_.group_size) {
+				try {
+					write_group();
+				} catch (...) {
+					error_ = std::current_exception();
+				}
+			}
+		}
+
+		// fills in the length and checksum of the record starting at start
+		auto seal(std::size_t start) noexcept -> void {
+			auto const* payload = pending_.data() + start + record_header_size;
+			auto const length =
+			   static_cast<std::uint32_t>(pending_.size() - start - record_header_size);
+			auto const crc = detail::crc32c(payload, length);
+			std::memcpy(pending_.data() + start, &length, sizeof(length));
+			std::memcpy(pending_.data() + start + sizeof(length), &crc, sizeof(crc));
+		}
+
+		auto write_group() -> void {
+			if (pending_records_ == 0) {
+				return;
+			}
+			try {
+				log_.write(pending_.data(), pending_.size());
+				log_.sync();
+			} catch (...) {
+				// drop whatever part of the group made it, so later groups stay readable
+				try {
+					log_.truncate(log_size_);
+				} catch (...) {
+				}
+				throw;
+			}
+			log_size_ += pending_.size();
+			log_records_ += pending_records_;
+			pending_.clear();
+			pending_records_ = 0;
+		}
+
+		// ----------   snapshots -----------
+
+		static auto put_header(std::vector<std::uint8_t>& out,
+		                       std::array<char, 8> const& magic,
+		                       std::uint64_t generation) -> void {
+			auto const at = out.size();
+			out.resize(at + header_size);
+			std::memcpy(out.data() + at, magic.data(), magic.size());
+			std::memcpy(out.data() + at + magic.size(), &generation, sizeof(generation));
+		}
+
+		// the generation in bytes' header, or nothing if it isn't one of ours
+		static auto read_header(std::vector<std::uint8_t> const& bytes,
+		                        std::array<char, 8> const& magic) -> std::optional<std::uint64_t> {
+			if (bytes.size() < header_size || !std::equal(magic.begin(), magic.end(), bytes.begin()))
+			{
+				return std::nullopt;
+			}
+			auto generation = std::uint64_t{0};
+			std::memcpy(&generation, bytes.data() + magic.size(), sizeof(generation));
+			return generation;
+		}
+
+		// header, body checksum, then the sorted nodes and each edge as the gap from the previous
+		// edge's source index, its destination index and its weight
+		auto encode_snapshot(std::uint64_t generation) const -> std::vector<std::uint8_t> {
+			auto const nodes = this->graph_->nodes();
+			auto out = std::vector<std::uint8_t>();
+			put_header(out, snapshot_magic, generation);
+			out.resize(out.size() + sizeof(std::uint32_t));
+			auto const body = out.size();
+
+			detail::put_varint(out, nodes.size());
+			for (auto const& value : nodes) {
+				serializer<N>::put(out, value);
+			}
+			detail::put_varint(out, this->graph_->num_edges());
+			auto src_index = std::size_t{0};
+			auto previous = std::size_t{0};
+			for (auto const& [src, row] : detail::graph_access::edges(*this->graph_)) {
+				while (nodes[src_index] < *src) {
+					++src_index;
+				}
+				for (auto const& [dst, weights] : row) {
+					auto const dst_index = static_cast<std::size_t>(
+					   std::lower_bound(nodes.begin(), nodes.end(), *dst) - nodes.begin());
+					for (auto const& weight : weights) {
+						detail::put_varint(out, src_index - previous);
+						detail::put_varint(out, dst_index);
+						serializer<E>::put(out, *weight);
+						previous = src_index;
+					}
+				}
+			}
+
+			auto const crc = detail::crc32c(out.data() + body, out.size() - body);
+			std::memcpy(out.data() + header_size, &crc, sizeof(crc));
+			return out;
+		}
+
+		auto load_snapshot(std::vector<std::uint8_t> const& bytes) -> void {
+			auto const generation = read_header(bytes, snapshot_magic);
+			auto const body = header_size + sizeof(std::uint32_t);
+			if (!generation || bytes.size() < body) {
+				throw corrupt("the snapshot isn't a gdwg::write_ahead_log snapshot");
+			}
+			auto crc = std::uint32_t{0};
+			std::memcpy(&crc, bytes.data() + header_size, sizeof(crc));
+			if (detail::crc32c(bytes.data() + body, bytes.size() - body) != crc) {
+				throw corrupt("the snapshot's checksum doesn't match");
+			}
+			generation_ = *generation;
+
+			auto& g = *this->graph_;
+			auto in = byte_reader(std::span<std::uint8_t const>(bytes).subspan(body));
+			auto nodes = std::vector<N>(static_cast<std::size_t>(in.varint()));
+			for (auto& value : nodes) {
+				value = serializer<N>::get(in);
+				g.insert_node(value);
+			}
+			auto edges = typename graph<N, E>::batch();
+			edges.resize(static_cast<std::size_t>(in.varint()));
+			auto src_index = std::size_t{0};
+			for (auto& edge : edges) {
+				src_index += static_cast<std::size_t>(in.varint());
+				auto const dst_index = static_cast<std::size_t>(in.varint());
+				if (src_index >= nodes.size() || dst_index >= nodes.size()) {
+					throw corrupt("the snapshot has an edge between nodes it doesn't have");
+				}
+				edge = {graph<N, E>::edge_operation::kind::insert,
+				        nodes[src_index],
+				        nodes[dst_index],
+				        serializer<E>::get(in)};
+			}
+			g.apply(edges);
+			recovered_.snapshot_nodes = nodes.size();
+			recovered_.snapshot_edges = edges.size();
+		}
+
+		// ----------   the log -----------
+
+		// replaces the log with an empty one for generation and opens it for appending
+		auto start_log(std::uint64_t generation) -> void {
+			auto header = std::vector<std::uint8_t>();
+			put_header(header, log_magic, generation);
+			log_.close();
+			detail::replace_file(directory_ / log_name, header);
+			log_ = detail::file(directory_ / log_name, O_WRONLY | O_APPEND);
+			log_size_ = header.size();
+			log_records_ = 0;
+		}
+
+		// applies every whole record, runs of edge changes as one batch, and returns where the
+		// last whole record ends
+		auto replay(std::vector<std::uint8_t> const& bytes) -> std::size_t {
+			auto& g = *this->graph_;
+			auto edges = typename graph<N, E>::batch();
+			auto const flush = [&] {
+				g.apply(edges);
+				edges.clear();
+			};
+
+			auto at = header_size;
+			while (bytes.size() - at >= record_header_size) {
+				auto length = std::uint32_t{0};
+				auto crc = std::uint32_t{0};
+				std::memcpy(&length, bytes.data() + at, sizeof(length));
+				std::memcpy(&crc, bytes.data() + at + sizeof(length), sizeof(crc));
+				auto const* payload = bytes.data() + at + record_header_size;
+				if (bytes.size() - at - record_header_size < length
+				    || detail::crc32c(payload, length) != crc || length == 0)
+				{
+					recovered_.torn_tail = true;
+					break;
+				}
+
+				auto in = byte_reader(std::span<std::uint8_t const>(payload, length));
+				auto const what = static_cast<kind>(in.bytes(1)[0]);
+				if (what == kind::insert_edge || what == kind::erase_edge) {
+					auto const op = what == kind::insert_edge
+					                   ? graph<N, E>::edge_operation::kind::insert
+					                   : graph<N, E>::edge_operation::kind::erase;
+					auto src = serializer<N>::get(in);
+					auto dst = serializer<N>::get(in);
+					edges.push_back({op, std::move(src), std::move(dst), serializer<E>::get(in)});
+				}
+				else {
+					flush();
+					if (what == kind::insert_node) {
+						g.insert_node(serializer<N>::get(in));
+					}
+					else if (what == kind::erase_node) {
+						g.erase_node(serializer<N>::get(in));
+					}
+					else if (what == kind::replace_node) {
+						auto old_data = serializer<N>::get(in);
+						g.replace_node(old_data, serializer<N>::get(in));
+					}
+					else {
+						throw std::runtime_error("a record is of an unknown kind");
+					}
+				}
+				if (in.remaining() != 0) {
+					throw std::runtime_error("a record is longer than its contents");
+				}
+				at += record_header_size + length;
+				++recovered_.replayed;
+			}
+			flush();
+			if (at != bytes.size()) {
+				recovered_.torn_tail = true;
+			}
+			return at;
+		}
+
+		auto recover() -> void {
+			auto const snapshot = detail::read_file(directory_ / snapshot_name);
+			auto const log = detail::read_file(directory_ / log_name);
+			if (!snapshot) {
+				if (log) {
+					throw corrupt("it has a log but no snapshot");
+				}
+				checkpoint();
+				return;
+			}
+			if (!this->graph_->empty()) {
+				throw std::runtime_error("Cannot recover " + directory_.string()
+				                         + " into a gdwg::graph that isn't empty");
+			}
+
+			load_snapshot(*snapshot);
+			auto const log_generation = log ? read_header(*log, log_magic) : std::nullopt;
+			if (log_generation && *log_generation > generation_) {
+				throw corrupt("its log is newer than its snapshot");
+			}
+			if (!log_generation || *log_generation < generation_) {
+				// the crash came between a snapshot and its log, which the snapshot covers
+				start_log(generation_);
+				return;
+			}
+
+			try {
+				log_size_ = replay(*log);
+			} catch (std::runtime_error const& error) {
+				throw corrupt(std::string("replaying its log failed: ") + error.what());
+			}
+			log_records_ = recovered_.replayed;
+			log_ = detail::file(directory_ / log_name, O_WRONLY | O_APPEND);
+			if (log_size_ != log->size()) {
+				log_.truncate(log_size_);
+				log_.sync();
+			}
+		}
+
+		auto corrupt(std::string const& reason) const -> std::runtime_error {
+			return std::runtime_error("Cannot recover a gdwg::graph from " + directory_.string()
+			                          + ": " + reason);
+		}
+	};
+} // namespace gdwg
+
+#endif // GDWG_WRITE_AHEAD_LOG_HPP
@@ -0,0 +1,214 @@
+#include "gdwg/centrality.hpp"
+
+#include <algorithm>
+#include <catch2/catch.hpp>
+#include <cmath>
+#include <cstddef>
+#include <limits>
+#include <numeric>
+#include <random>
+#include <vector>
+
+namespace {
+	using graph_t = gdwg::graph<int, int>;
+
+	auto random_graph(int nodes, int edges, int longest, unsigned seed) -> graph_t {
+		auto g = graph_t{};
+		for (auto i = 0; i < nodes; ++i) {
+			g.insert_node(i);
+		}
+		auto rng = std::mt19937(seed);
+		auto pick = std::uniform_int_distribution<int>(0, nodes - 1);
+		auto length = std::uniform_int_distribution<int>(1, longest);
+		for (auto i = 0; i < edges; ++i) {
+			g.insert_edge(pick(rng), pick(rng), length(rng));
+		}
+		return g;
+	}
+
+	struct reference {
+		std::vector<double> betweenness;
+		std::vector<double> closeness;
+	};
+
+	// Floyd-Warshall for distances, then path counts built up in order of distance from each source
+	auto reference_centrality(graph_t const& g, bool weighted) -> reference {
+		auto const n = g.nodes().size();
+		auto constexpr far = std::numeric_limits<double>::infinity();
+		auto length = std::vector<std::vector<double>>(n, std::vector<double>(n, far));
+		for (auto const& [src, dst, weight] : g) {
+			auto const u = static_cast<std::size_t>(src);
+			auto const v = static_cast<std::size_t>(dst);
+			if (u != v) {
+				length[u][v] = std::min(length[u][v], weighted ? weight : 1.0);
+			}
+		}
+		auto distance = length;
+		for (auto v = std::size_t{0}; v < n; ++v) {
+			distance[v][v] = 0;
+		}
+		for (auto k = std::size_t{0}; k < n; ++k) {
+			for (auto s = std::size_t{0}; s < n; ++s) {
+				for (auto t = std::size_t{0}; t < n; ++t) {
+					distance[s][t] = std::min(distance[s][t], distance[s][k] + distance[k][t]);
+				}
+			}
+		}
+		auto paths = std::vector<std::vector<double>>(n, std::vector<double>(n, 0));
+		for (auto s = std::size_t{0}; s < n; ++s) {
+			auto order = std::vector<std::size_t>(n);
+			for (auto v = std::size_t{0}; v < n; ++v) {
+				order[v] = v;
+			}
+			std::sort(order.begin(), order.end(), [&](std::size_t left, std::size_t right) {
+				return distance[s][left] < distance[s][right];
+			});
+			paths[s][s] = 1;
+			for (auto t : order) {
+				if (t == s || distance[s][t] == far) {
+					continue;
+				}
+				for (auto u = std::size_t{0}; u < n; ++u) {
+					if (distance[s][u] + length[u][t] == distance[s][t]) {
+						paths[s][t] += paths[s][u];
+					}
+				}
+			}
+		}
+
+		auto result = reference{std::vector<double>(n), std::vector<double>(n)};
+		for (auto v = std::size_t{0}; v < n; ++v) {
+			auto total = 0.0;
+			auto reached = 0.0;
+			for (auto s = std::size_t{0}; s < n; ++s) {
+				if (s != v && distance[s][v] != far) {
+					total += distance[s][v];
+					reached += 1;
+				}
+				for (auto t = std::size_t{0}; t < n; ++t) {
+					if (s == v || t == v || s == t || distance[s][t] == far) {
+						continue;
+					}
+					if (distance[s][v] + distance[v][t] == distance[s][t]) {
+						result.betweenness[v] += paths[s][v] * paths[v][t] / paths[s][t];
+					}
+				}
+			}
+			if (total > 0) {
+				result.closeness[v] = reached / total * reached / static_cast<double>(n - 1);
+			}
+		}
+		return result;
+	}
+
+	auto close(std::vector<double> const& left, std::vector<double> const& right) -> bool {
+		if (left.size() != right.size()) {
+			return false;
+		}
+		for (auto i = std::size_t{0}; i < left.size(); ++i) {
+			if (std::abs(left[i] - right[i]) > 1e-9 * std::max(1.0, std::abs(right[i]))) {
+				return false;
+			}
+		}
+		return true;
+	}
+} // namespace
+
+TEST_CASE("Exact centrality matches brute force over every pair", "[Centrality]") {
+	for (auto seed = 1U; seed <= 12; ++seed) {
+		auto const g = random_graph(14, 20 + 3 * static_cast<int>(seed), 3, seed);
+		for (auto const weighted : {false, true}) {
+			auto const expected = reference_centrality(g, weighted);
+			for (auto const threads : {std::size_t{1}, std::size_t{4}}) {
+				auto options = gdwg::centrality_options();
+				options.weighted = weighted;
+				options.normalized = false;
+				options.threads = threads;
+				CHECK(close(gdwg::betweenness_centrality(g, options), expected.betweenness));
+				CHECK(close(gdwg::closeness_centrality(g, options), expected.closeness));
+			}
+		}
+	}
+}
+
+TEST_CASE("Centrality on a directed path", "[Centrality]") {
+	auto g = graph_t{0, 1, 2, 3};
+	g.insert_edge(0, 1, 1);
+	g.insert_edge(1, 2, 1);
+	g.insert_edge(2, 3, 1);
+	// a second, longer weight and a self loop change nothing
+	g.insert_edge(1, 2, 9);
+	g.insert_edge(2, 2, 1);
+
+	auto options = gdwg::centrality_options();
+	options.normalized = false;
+	CHECK(gdwg::betweenness_centrality(g, options) == std::vector<double>{0, 2, 2, 0});
+	options.normalized = true;
+	CHECK(gdwg::betweenness_centrality(g, options) == std::vector<double>{0, 1.0 / 3, 1.0 / 3, 0});
+
+	// node 3 is reached by all three others at distances 1, 2 and 3
+	auto const closeness = gdwg::closeness_centrality(g, options);
+	CHECK(closeness[0] == 0);
+	CHECK(closeness[1] == Approx(1.0 / 3));
+	CHECK(closeness[2] == Approx(2.0 / 3 * 2.0 / 3));
+	CHECK(closeness[3] == Approx(3.0 / 6));
+}
+
+TEST_CASE("Sampled centrality estimates the exact values", "[Centrality]") {
+	// a sparse random graph with one hub that plenty of shortest paths go through
+	auto g = random_graph(600, 1500, 1, 5);
+	g.insert_node(600);
+	for (auto i = 0; i < 600; i += 7) {
+		g.insert_edge(i, 600, 1);
+		g.insert_edge(600, (i * 31) % 600, 1);
+	}
+	auto options = gdwg::centrality_options();
+	auto const betweenness = gdwg::betweenness_centrality(g, options);
+	auto const closeness = gdwg::closeness_centrality(g, options);
+
+	SECTION("samples covering every node are exact") {
+		options.samples = 601;
+		CHECK(close(gdwg::betweenness_centrality(g, options), betweenness));
+		CHECK(close(gdwg::closeness_centrality(g, options), closeness));
+	}
+
+	SECTION("a third of the sources lands close") {
+		options.samples = 200;
+		auto const rough_betweenness = gdwg::betweenness_centrality(g, options);
+		auto const rough_closeness = gdwg::closeness_centrality(g, options);
+		// single nodes off the hub are noisy, but the hub and the totals come out close
+		CHECK(rough_betweenness[600] == Approx(betweenness[600]).epsilon(0.1));
+		auto const sum = [](std::vector<double> const& values) {
+			return std::accumulate(values.begin(), values.end(), 0.0);
+		};
+		CHECK(sum(rough_betweenness) == Approx(sum(betweenness)).epsilon(0.1));
+		CHECK(std::max_element(rough_betweenness.begin(), rough_betweenness.end())
+		      == rough_betweenness.begin() + 600);
+
+		auto closeness_error = 0.0;
+		for (auto v = std::size_t{0}; v < closeness.size(); ++v) {
+			closeness_error += std::abs(rough_closeness[v] - closeness[v]);
+		}
+		CHECK(closeness_error / sum(closeness) < 0.05);
+
+		// the same seed draws the same sources
+		CHECK(close(gdwg::betweenness_centrality(g, options), rough_betweenness));
+	}
+}
+
+TEST_CASE("Weighted centrality needs positive lengths", "[Centrality]") {
+	auto g = graph_t{1, 2};
+	g.insert_edge(1, 2, 0);
+	CHECK(gdwg::betweenness_centrality(g) == std::vector<double>{0, 0});
+	auto options = gdwg::centrality_options();
+	options.weighted = true;
+	CHECK_THROWS_MATCHES(gdwg::betweenness_centrality(g, options),
+	                     std::runtime_error,
+	                     Catch::Matchers::Message("Cannot call gdwg::betweenness_centrality with an "
+	                                              "edge weight that isn't positive"));
+	CHECK_THROWS_MATCHES(gdwg::closeness_centrality(g, options),
+	                     std::runtime_error,
+	                     Catch::Matchers::Message("Cannot call gdwg::closeness_centrality with an "
+	                                              "edge weight that isn't positive"));
+	CHECK(gdwg::closeness_centrality(graph_t{}).empty());
+}
@@ -0,0 +1,132 @@
+#include "gdwg/components.hpp"
+
+#include <catch2/catch.hpp>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+namespace {
+	using graph_t = gdwg::graph<int, int>;
+
+	auto random_graph(int nodes, int edges, unsigned seed) -> graph_t {
+		auto g = graph_t{};
+		for (auto i = 0; i < nodes; ++i) {
+			g.insert_node(i);
+		}
+		auto rng = std::mt19937(seed);
+		auto pick = std::uniform_int_distribution<int>(0, nodes - 1);
+		for (auto i = 0; i < edges; ++i) {
+			g.insert_edge(pick(rng), pick(rng), i % 3);
+		}
+		return g;
+	}
+
+	// breadth first search over the undirected graph, labels in order of smallest node
+	auto reference_wcc(gdwg::frozen_graph<int, int> const& g) -> gdwg::component_labels {
+		auto const none = std::uint32_t{0xffffffff};
+		auto res = gdwg::component_labels{std::vector<std::uint32_t>(g.num_nodes(), none), 0};
+		for (auto root = std::uint32_t{0}; root < g.num_nodes(); ++root) {
+			if (res.component[root] != none) {
+				continue;
+			}
+			auto queue = std::vector<std::uint32_t>{root};
+			res.component[root] = res.count;
+			while (!queue.empty()) {
+				auto const v = queue.back();
+				queue.pop_back();
+				auto visit = [&](std::uint32_t w) {
+					if (res.component[w] == none) {
+						res.component[w] = res.count;
+						queue.push_back(w);
+					}
+				};
+				for (auto w : g.out_neighbors(v)) {
+					visit(w);
+				}
+				for (auto w : g.in_neighbors(v)) {
+					visit(w);
+				}
+			}
+			++res.count;
+		}
+		return res;
+	}
+} // namespace
+
+TEST_CASE("Weakly connected components", "[Components]") {
+	SECTION("check small graph, weakly_connected_components()") {
+		auto g = graph_t{1, 2, 3, 4, 5, 6};
+		g.insert_edge(2, 1, 0);
+		g.insert_edge(3, 2, 0);
+		g.insert_edge(5, 4, 0);
+		auto const res = gdwg::weakly_connected_components(g, 2);
+		CHECK(res.count == 3);
+		CHECK(res.component == std::vector<std::uint32_t>{0, 0, 0, 1, 1, 2});
+	}
+
+	SECTION("check empty graph, weakly_connected_components()") {
+		auto const res = gdwg::weakly_connected_components(graph_t{});
+		CHECK(res.count == 0);
+		CHECK(res.component.empty());
+	}
+
+	SECTION("check against a breadth first search, weakly_connected_components()") {
+		for (auto threads : {1u, 2u, 4u}) {
+			auto const frozen = gdwg::frozen_graph<int, int>(random_graph(3000, 2500, threads));
+			auto const expected = reference_wcc(frozen);
+			auto const res = gdwg::weakly_connected_components(frozen, threads);
+			CHECK(res.count == expected.count);
+			CHECK(res.component == expected.component);
+		}
+	}
+}
+
+TEST_CASE("Strongly connected components", "[Components]") {
+	// two cycles joined one way, a self loop, and a chain
+	auto g = graph_t{1, 2, 3, 4, 5, 6, 7, 8};
+	g.insert_edge(1, 2, 0);
+	g.insert_edge(2, 3, 0);
+	g.insert_edge(3, 1, 0);
+	g.insert_edge(3, 4, 0);
+	g.insert_edge(4, 5, 0);
+	g.insert_edge(5, 4, 0);
+	g.insert_edge(6, 6, 0);
+	g.insert_edge(7, 8, 0);
+
+	SECTION("check small graph, strongly_connected_components()") {
+		auto const res = gdwg::strongly_connected_components(g);
+		CHECK(res.count == 5);
+		CHECK(res.component == std::vector<std::uint32_t>{0, 0, 0, 1, 1, 2, 3, 4});
+	}
+
+	SECTION("check small graph, strongly_connected_components_parallel()") {
+		auto const res = gdwg::strongly_connected_components_parallel(g, 3);
+		CHECK(res.count == 5);
+		CHECK(res.component == std::vector<std::uint32_t>{0, 0, 0, 1, 1, 2, 3, 4});
+	}
+
+	SECTION("check the two algorithms agree, strongly_connected_components_parallel()") {
+		for (auto threads : {1u, 2u, 4u}) {
+			auto const frozen = gdwg::frozen_graph<int, int>(random_graph(2000, 4000, threads));
+			auto const sequential = gdwg::strongly_connected_components(frozen);
+			auto const parallel = gdwg::strongly_connected_components_parallel(frozen, threads);
+			CHECK(sequential.count > 1);
+			CHECK(sequential.count < 2000);
+			CHECK(parallel.count == sequential.count);
+			CHECK(parallel.component == sequential.component);
+		}
+	}
+
+	SECTION("check a long path doesn't overflow the stack, strongly_connected_components()") {
+		auto path = graph_t{};
+		for (auto i = 0; i < 20000; ++i) {
+			path.insert_node(i);
+		}
+		for (auto i = 0; i + 1 < 20000; ++i) {
+			path.insert_edge(i, i + 1, 0);
+		}
+		path.insert_edge(19999, 0, 0);
+		CHECK(gdwg::strongly_connected_components(path).count == 1);
+		CHECK(gdwg::strongly_connected_components_parallel(path, 2).count == 1);
+	}
+}
@@ -0,0 +1,136 @@
+#include "gdwg/compressed_graph.hpp"
+
+#include <catch2/catch.hpp>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+TEST_CASE("Compressing a graph", "[CompressedGraph]") {
+	auto g = gdwg::graph<std::string, int>{"a", "b", "c", "d"};
+	g.insert_edge("a", "b", 3);
+	g.insert_edge("a", "b", -1);
+	g.insert_edge("a", "c", 2);
+	g.insert_edge("c", "a", 5);
+	g.insert_edge("d", "d", 4);
+	auto const compressed = gdwg::compressed_graph<std::string, int>(g);
+
+	SECTION("check sizes, num_nodes() num_edges()") {
+		CHECK(compressed.num_nodes() == 4);
+		CHECK(compressed.num_edges() == 5);
+		CHECK(!compressed.empty());
+		CHECK(gdwg::compressed_graph<std::string, int>().empty());
+		CHECK(compressed.nodes() == std::vector<std::string>{"a", "b", "c", "d"});
+		CHECK(compressed.is_node("c"));
+		CHECK(!compressed.is_node("z"));
+	}
+
+	SECTION("check rows decode, decode()") {
+		auto row = gdwg::compressed_graph<std::string, int>::row();
+		compressed.decode(0, row);
+		CHECK(row.targets == std::vector<std::uint32_t>{1, 2});
+		CHECK(row.counts == std::vector<std::uint32_t>{2, 1});
+		CHECK(row.weights == std::vector<int>{-1, 3, 2});
+		compressed.decode(1, row);
+		CHECK(row.targets.empty());
+		CHECK(row.weights.empty());
+		compressed.decode(2, row);
+		CHECK(row.targets == std::vector<std::uint32_t>{0});
+	}
+
+	SECTION("check same answers as the graph, connections() weights() is_connected()") {
+		for (auto const& node : g.nodes()) {
+			CHECK(compressed.connections(node) == g.connections(node));
+			for (auto const& other : g.nodes()) {
+				CHECK(compressed.weights(node, other) == g.weights(node, other));
+				CHECK(compressed.is_connected(node, other) == g.is_connected(node, other));
+			}
+		}
+		CHECK_THROWS_MATCHES(compressed.connections("z"),
+		                     std::runtime_error,
+		                     Catch::Matchers::Message("Cannot call gdwg::compressed_graph<N, "
+		                                              "E>::connections if src doesn't exist in the "
+		                                              "graph"));
+		CHECK_THROWS_MATCHES(compressed.weights("a", "z"),
+		                     std::runtime_error,
+		                     Catch::Matchers::Message("Cannot call gdwg::compressed_graph<N, "
+		                                              "E>::weights if src or dst node don't exist "
+		                                              "in the graph"));
+	}
+
+	SECTION("check iteration matches the graph, begin() end()") {
+		auto const expected = std::vector(g.begin(), g.end());
+		auto const actual = std::vector(compressed.begin(), compressed.end());
+		REQUIRE(actual.size() == expected.size());
+		for (auto i = std::size_t{0}; i < actual.size(); ++i) {
+			CHECK(actual[i].from == expected[i].from);
+			CHECK(actual[i].to == expected[i].to);
+			CHECK(actual[i].weight == expected[i].weight);
+		}
+		auto const empty = gdwg::compressed_graph<std::string, int>();
+		CHECK(empty.begin() == empty.end());
+	}
+}
+
+TEST_CASE("Varints round trip", "[CompressedGraph]") {
+	auto values = std::vector<std::uint64_t>{0, 1, 127, 128, 300, 16383, 16384, ~std::uint64_t{0}};
+	// long runs of one byte values take the fast path
+	for (auto i = 0; i < 40; ++i) {
+		values.push_back(static_cast<std::uint64_t>(i % 5 == 4 ? 1000 + i : i));
+	}
+	auto bytes = std::vector<std::uint8_t>();
+	for (auto value : values) {
+		gdwg::detail::put_varint(bytes, value);
+	}
+	bytes.resize(bytes.size() + gdwg::detail::varint_padding);
+
+	auto decoded = std::vector<std::uint64_t>(values.size());
+	auto const* end = gdwg::detail::get_varints(bytes.data(), values.size(), decoded.data());
+	CHECK(decoded == values);
+	CHECK(static_cast<std::size_t>(end - bytes.data()) + gdwg::detail::varint_padding
+	      == bytes.size());
+
+	for (auto value : {std::int64_t{0}, std::int64_t{-1}, std::int64_t{1}, std::int64_t{-70000}}) {
+		CHECK(gdwg::detail::unzigzag(gdwg::detail::zigzag(value)) == value);
+	}
+	CHECK(gdwg::detail::zigzag(-1) == 1);
+	CHECK(gdwg::detail::zigzag(1) == 2);
+}
+
+TEST_CASE("Compressing a larger graph", "[CompressedGraph]") {
+	// a grid, so neighbours are near each other once numbered breadth first
+	constexpr auto side = 40;
+	auto g = gdwg::graph<int, long>{};
+	for (auto v = 0; v < side * side; ++v) {
+		g.insert_node(v);
+	}
+	for (auto v = 0; v < side * side; ++v) {
+		if (v % side + 1 < side) {
+			g.insert_edge(v, v + 1, v);
+			g.insert_edge(v + 1, v, -v);
+		}
+		if (v + side < side * side) {
+			g.insert_edge(v, v + side, 7);
+			g.insert_edge(v, v + side, 9);
+		}
+	}
+
+	for (auto order : {gdwg::node_order::sorted, gdwg::node_order::bfs}) {
+		auto const compressed = gdwg::compressed_graph<int, long>(g, order);
+		CHECK(compressed.num_edges() == g.num_edges());
+		for (auto v = 0; v < side * side; v += 37) {
+			CHECK(compressed.connections(v) == g.connections(v));
+			CHECK(compressed.weights(v, v + 1) == g.weights(v, v + 1));
+		}
+		// a few bytes per edge against a tree node and a weight set per edge
+		CHECK(compressed.memory_usage() * 5 < g.memory_usage().total());
+	}
+
+	SECTION("check non-integral weights are kept aside, weights()") {
+		auto h = gdwg::graph<int, double>{1, 2};
+		h.insert_edge(1, 2, 0.5);
+		h.insert_edge(1, 2, -2.5);
+		auto const compressed = gdwg::compressed_graph<int, double>(h);
+		CHECK(compressed.weights(1, 2) == std::vector<double>{-2.5, 0.5});
+		CHECK(std::vector(compressed.begin(), compressed.end()).size() == 2);
+	}
+}
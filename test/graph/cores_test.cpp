@@ -0,0 +1,202 @@
+#include "gdwg/cores.hpp"
+
+#include <algorithm>
+#include <catch2/catch.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <random>
+#include <set>
+#include <span>
+#include <vector>
+
+namespace {
+	using graph_t = gdwg::graph<int, int>;
+
+	auto random_graph(int nodes, int edges, unsigned seed) -> graph_t {
+		auto g = graph_t{};
+		for (auto i = 0; i < nodes; ++i) {
+			g.insert_node(i);
+		}
+		auto rng = std::mt19937(seed);
+		auto pick = std::uniform_int_distribution<int>(0, nodes - 1);
+		auto batch = graph_t::batch();
+		for (auto i = 0; i < edges; ++i) {
+			auto const src = pick(rng);
+			auto const dst = pick(rng);
+			batch.push_back({graph_t::edge_operation::kind::insert, src, dst, i % 3});
+		}
+		g.apply(batch);
+		return g;
+	}
+
+	// the undirected simple graph as an adjacency matrix
+	auto adjacency(graph_t const& g) -> std::vector<std::vector<bool>> {
+		auto const n = g.nodes().size();
+		auto joined = std::vector<std::vector<bool>>(n, std::vector<bool>(n));
+		for (auto const& [src, dst, weight] : g) {
+			auto const u = static_cast<std::size_t>(src);
+			auto const v = static_cast<std::size_t>(dst);
+			if (u != v) {
+				joined[u][v] = true;
+				joined[v][u] = true;
+			}
+		}
+		return joined;
+	}
+
+	// for every k, strip nodes below k until none are left to strip
+	auto reference_cores(graph_t const& g) -> std::vector<std::uint32_t> {
+		auto const joined = adjacency(g);
+		auto const n = joined.size();
+		auto core = std::vector<std::uint32_t>(n);
+		for (auto k = std::uint32_t{1}; k <= n; ++k) {
+			auto alive = std::vector<bool>(n, true);
+			for (auto changed = true; changed;) {
+				changed = false;
+				for (auto v = std::size_t{0}; v < n; ++v) {
+					auto degree = std::uint32_t{0};
+					for (auto w = std::size_t{0}; w < n; ++w) {
+						degree += alive[w] && joined[v][w] ? 1U : 0U;
+					}
+					if (alive[v] && degree < k) {
+						alive[v] = false;
+						changed = true;
+					}
+				}
+			}
+			for (auto v = std::size_t{0}; v < n; ++v) {
+				if (alive[v]) {
+					core[v] = k;
+				}
+			}
+		}
+		return core;
+	}
+
+	// every subset that is a clique no other node can join
+	auto reference_cliques(graph_t const& g) -> std::set<std::vector<std::uint32_t>> {
+		auto const joined = adjacency(g);
+		auto const n = joined.size();
+		auto cliques = std::set<std::vector<std::uint32_t>>();
+		for (auto mask = std::uint32_t{1}; mask < (1U << n); ++mask) {
+			auto members = std::vector<std::uint32_t>();
+			for (auto v = std::uint32_t{0}; v < n; ++v) {
+				if ((mask >> v & 1U) != 0) {
+					members.push_back(v);
+				}
+			}
+			auto const joins_all = [&](std::size_t v) {
+				return std::all_of(members.begin(), members.end(), [&](std::uint32_t w) {
+					return v == w || joined[v][w];
+				});
+			};
+			if (!std::all_of(members.begin(), members.end(), joins_all)) {
+				continue;
+			}
+			auto maximal = true;
+			for (auto v = std::uint32_t{0}; v < n && maximal; ++v) {
+				maximal = (mask >> v & 1U) != 0 || !joins_all(v);
+			}
+			if (maximal) {
+				cliques.insert(members);
+			}
+		}
+		return cliques;
+	}
+
+	auto all_cliques(gdwg::frozen_graph<int, int> const& g,
+	                 gdwg::core_decomposition const& cores,
+	                 std::size_t threads) -> std::set<std::vector<std::uint32_t>> {
+		auto cliques = std::set<std::vector<std::uint32_t>>();
+		auto lock = std::mutex();
+		auto const found = gdwg::maximal_cliques(
+		   g,
+		   cores,
+		   [&](std::span<std::uint32_t const> clique, std::size_t) {
+			   auto const guard = std::scoped_lock(lock);
+			   cliques.emplace(clique.begin(), clique.end());
+		   },
+		   threads);
+		CHECK(found == cliques.size());
+		return cliques;
+	}
+} // namespace
+
+TEST_CASE("Both algorithms find the core numbers and a degeneracy ordering", "[Cores]") {
+	for (auto seed = 1U; seed <= 15; ++seed) {
+		auto const nodes = 5 + static_cast<int>(seed) * 2;
+		auto const g = random_graph(nodes, nodes * static_cast<int>(1 + seed % 4), seed);
+		auto const expected = reference_cores(g);
+		auto const joined = adjacency(g);
+		for (auto const algorithm :
+		     {gdwg::core_algorithm::buckets, gdwg::core_algorithm::parallel_peeling}) {
+			auto options = gdwg::core_options();
+			options.algorithm = algorithm;
+			options.threads = 4;
+			auto const cores = gdwg::k_core_decomposition(g, options);
+			CHECK(cores.core == expected);
+			CHECK(cores.degeneracy == *std::max_element(expected.begin(), expected.end()));
+
+			// no node has more neighbours after it than its own core number
+			REQUIRE(cores.order.size() == expected.size());
+			auto const sorted = std::set<std::uint32_t>(cores.order.begin(), cores.order.end());
+			CHECK(sorted.size() == expected.size());
+			for (auto i = std::size_t{0}; i < cores.order.size(); ++i) {
+				auto later = std::uint32_t{0};
+				for (auto j = i + 1; j < cores.order.size(); ++j) {
+					later += joined[cores.order[i]][cores.order[j]] ? 1U : 0U;
+				}
+				CHECK(later <= cores.core[cores.order[i]]);
+			}
+		}
+	}
+}
+
+TEST_CASE("A clique hanging off a path", "[Cores]") {
+	// 0-1-2-3 fully joined, 3-4-5 a path, 6 alone
+	auto g = graph_t{0, 1, 2, 3, 4, 5, 6};
+	for (auto u = 0; u < 4; ++u) {
+		for (auto v = u + 1; v < 4; ++v) {
+			g.insert_edge(u, v, 1);
+		}
+	}
+	g.insert_edge(3, 4, 1);
+	g.insert_edge(5, 4, 1);
+	g.insert_edge(4, 5, 2);
+	g.insert_edge(6, 6, 1);
+
+	auto const cores = gdwg::k_core_decomposition(g);
+	CHECK(cores.core == std::vector<std::uint32_t>{3, 3, 3, 3, 1, 1, 0});
+	CHECK(cores.degeneracy == 3);
+
+	auto const frozen = gdwg::frozen_graph<int, int>(g);
+	CHECK(gdwg::triangle_count(frozen, cores) == 4);
+	auto const expected = std::set<std::vector<std::uint32_t>>{{0, 1, 2, 3}, {3, 4}, {4, 5}, {6}};
+	CHECK(all_cliques(frozen, cores, 1) == expected);
+}
+
+TEST_CASE("The degeneracy ordering speeds up triangles and cliques", "[Cores]") {
+	for (auto seed = 1U; seed <= 10; ++seed) {
+		auto const g = random_graph(16, 16 * static_cast<int>(1 + seed % 5), seed);
+		auto const frozen = gdwg::frozen_graph<int, int>(g);
+		auto options = gdwg::core_options();
+		options.algorithm = gdwg::core_algorithm::parallel_peeling;
+		auto const cores = gdwg::k_core_decomposition(frozen, options);
+		CHECK(gdwg::triangle_count(frozen, cores, 4) == gdwg::triangle_count(frozen));
+
+		auto const expected = reference_cliques(g);
+		CHECK(all_cliques(frozen, cores, 1) == expected);
+		CHECK(all_cliques(frozen, cores, 4) == expected);
+	}
+}
+
+TEST_CASE("Cores must come from the same graph", "[Cores]") {
+	auto const small = gdwg::frozen_graph<int, int>(graph_t{1, 2});
+	auto const cores = gdwg::k_core_decomposition(graph_t{1, 2, 3});
+	CHECK_THROWS_MATCHES(gdwg::triangle_count(small, cores),
+	                     std::runtime_error,
+	                     Catch::Matchers::Message("Cannot call gdwg::triangle_count with the cores "
+	                                              "of a different graph"));
+	CHECK(gdwg::k_core_decomposition(graph_t{}).order.empty());
+}
@@ -0,0 +1,169 @@
+#include "gdwg/frozen_graph.hpp"
+
+#include <algorithm>
+#include <catch2/catch.hpp>
+#include <string>
+#include <vector>
+
+TEST_CASE("Freezing a graph into compressed rows", "[FrozenGraph]") {
+	auto g = gdwg::graph<std::string, int>{"a", "b", "c", "d"};
+	g.insert_edge("a", "b", 3);
+	g.insert_edge("a", "b", 1);
+	g.insert_edge("a", "c", 2);
+	g.insert_edge("c", "a", 5);
+	g.insert_edge("d", "d", 4);
+	auto const frozen = gdwg::frozen_graph<std::string, int>(g);
+
+	SECTION("check sizes, num_nodes() num_edges()") {
+		CHECK(frozen.num_nodes() == 4);
+		CHECK(frozen.num_edges() == 5);
+		CHECK(!frozen.empty());
+		CHECK(gdwg::frozen_graph<std::string, int>().empty());
+	}
+
+	SECTION("check ids follow node order, id() node() find()") {
+		CHECK(frozen.nodes() == std::vector<std::string>{"a", "b", "c", "d"});
+		CHECK(frozen.id("c") == 2);
+		CHECK(frozen.node(3) == "d");
+		CHECK(!frozen.find("z").has_value());
+		CHECK(!frozen.is_node("z"));
+		CHECK_THROWS_MATCHES(frozen.id("z"),
+		                     std::runtime_error,
+		                     Catch::Matchers::Message("Cannot call gdwg::frozen_graph<N, E>::id if "
+		                                              "the node doesn't exist in the graph"));
+	}
+
+	SECTION("check rows, out_neighbors() in_neighbors()") {
+		auto const out = frozen.out_neighbors(0);
+		auto const expected = std::vector<std::uint32_t>{1, 1, 2};
+		CHECK(std::vector<std::uint32_t>(out.begin(), out.end()) == expected);
+		auto const out_w = frozen.out_weights(0);
+		CHECK(std::vector<int>(out_w.begin(), out_w.end()) == std::vector<int>{1, 3, 2});
+		auto const in = frozen.in_neighbors(0);
+		CHECK(std::vector<std::uint32_t>(in.begin(), in.end()) == std::vector<std::uint32_t>{2});
+		CHECK(frozen.in_weights(0)[0] == 5);
+		CHECK(frozen.out_degree(1) == 0);
+		CHECK(frozen.in_degree(1) == 2);
+		CHECK(frozen.in_degree(3) == 1);
+		CHECK(frozen.out_offsets().size() == 5);
+		CHECK(frozen.in_sources().size() == 5);
+	}
+
+	SECTION("check same answers as the graph, connections() weights()") {
+		for (auto const& node : g.nodes()) {
+			CHECK(frozen.connections(node) == g.connections(node));
+			for (auto const& other : g.nodes()) {
+				CHECK(frozen.weights(node, other) == g.weights(node, other));
+			}
+		}
+		CHECK_THROWS_MATCHES(frozen.weights("a", "z"),
+		                     std::runtime_error,
+		                     Catch::Matchers::Message("Cannot call gdwg::frozen_graph<N, E>::weights "
+		                                              "if src or dst node don't exist in the "
+		                                              "graph"));
+	}
+}
+
+namespace {
+	using int_graph = gdwg::graph<int, int>;
+	using frozen_t = gdwg::frozen_graph<int, int>;
+
+	// largest distance between the ids of an edge's endpoints
+	auto bandwidth(frozen_t const& frozen) -> std::uint32_t {
+		auto widest = std::uint32_t{0};
+		for (auto v = std::uint32_t{0}; v < frozen.num_nodes(); ++v) {
+			for (auto w : frozen.out_neighbors(v)) {
+				widest = std::max(widest, v > w ? v - w : w - v);
+			}
+		}
+		return widest;
+	}
+
+	// a path through 0..99 visited in a scattered order
+	auto scattered_path() -> int_graph {
+		auto g = int_graph{};
+		for (auto i = 0; i < 100; ++i) {
+			g.insert_node(i);
+		}
+		for (auto i = 0; i + 1 < 100; ++i) {
+			g.insert_edge(i * 37 % 100, (i + 1) * 37 % 100, i);
+		}
+		return g;
+	}
+} // namespace
+
+TEST_CASE("Renumbering a frozen graph", "[FrozenGraph]") {
+	auto const orders = {gdwg::node_order::degree,
+	                     gdwg::node_order::reverse_cuthill_mckee,
+	                     gdwg::node_order::bfs,
+	                     gdwg::node_order::community};
+
+	SECTION("check every order keeps the same graph, order() id() connections()") {
+		auto g = scattered_path();
+		g.insert_edge(5, 5, 1);
+		g.insert_edge(5, 9, 2);
+		g.insert_edge(5, 9, 1);
+		for (auto order : orders) {
+			auto const frozen = frozen_t(g, order);
+			CHECK(frozen.order() == order);
+			CHECK(frozen.num_edges() == g.num_edges());
+			for (auto id = std::uint32_t{0}; id < frozen.num_nodes(); ++id) {
+				CHECK(frozen.id(frozen.node(id)) == id);
+				auto const out = frozen.out_neighbors(id);
+				auto const weights = frozen.out_weights(id);
+				for (auto i = std::size_t{1}; i < out.size(); ++i) {
+					auto const ascending =
+					   out[i - 1] < out[i] || (out[i - 1] == out[i] && weights[i - 1] < weights[i]);
+					CHECK(ascending);
+				}
+			}
+			for (auto const& node : g.nodes()) {
+				CHECK(frozen.is_node(node));
+				CHECK(frozen.connections(node) == g.connections(node));
+				CHECK(frozen.weights(5, node) == g.weights(5, node));
+			}
+			CHECK(!frozen.find(100).has_value());
+			CHECK(!frozen.find(-1).has_value());
+		}
+	}
+
+	SECTION("check hubs come first, node_order::degree") {
+		auto g = int_graph{1, 2, 3, 4};
+		g.insert_edge(1, 2, 0);
+		g.insert_edge(3, 2, 0);
+		g.insert_edge(4, 2, 0);
+		g.insert_edge(4, 3, 0);
+		auto const frozen = frozen_t(g, gdwg::node_order::degree);
+		CHECK(frozen.nodes() == std::vector<int>{2, 3, 4, 1});
+	}
+
+	SECTION("check a scattered path becomes a band, node_order::reverse_cuthill_mckee") {
+		auto const g = scattered_path();
+		CHECK(bandwidth(frozen_t(g)) > 50);
+		CHECK(bandwidth(frozen_t(g, gdwg::node_order::reverse_cuthill_mckee)) == 1);
+		CHECK(bandwidth(frozen_t(g, gdwg::node_order::bfs)) <= 2);
+	}
+
+	SECTION("check each community is numbered together, node_order::community") {
+		// evens and odds form two cliques joined by one edge
+		auto g = int_graph{0, 1, 2, 3, 4, 5, 6, 7, 8, 9};
+		for (auto a = 0; a < 10; ++a) {
+			for (auto b = a + 2; b < 10; b += 2) {
+				g.insert_edge(a, b, 0);
+			}
+		}
+		g.insert_edge(8, 9, 0);
+		auto const frozen = frozen_t(g, gdwg::node_order::community);
+		auto span_of = [&](int parity) {
+			auto low = std::uint32_t{10};
+			auto high = std::uint32_t{0};
+			for (auto v = parity; v < 10; v += 2) {
+				low = std::min(low, frozen.id(v));
+				high = std::max(high, frozen.id(v));
+			}
+			return high - low;
+		};
+		CHECK(span_of(0) == 4);
+		CHECK(span_of(1) == 4);
+	}
+}
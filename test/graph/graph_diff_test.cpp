@@ -0,0 +1,138 @@
+#include "gdwg/graph_diff.hpp"
+
+#include <catch2/catch.hpp>
+#include <cstdint>
+#include <random>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace {
+	using graph_t = gdwg::graph<int, int>;
+
+	// random node and edge insertions and erasures over the values 0 to 59
+	auto mutate(graph_t g, int changes, std::mt19937& rng) -> graph_t {
+		auto pick = std::uniform_int_distribution<int>(0, 59);
+		auto what = std::uniform_int_distribution<int>(0, 9);
+		for (auto i = 0; i < changes; ++i) {
+			auto const src = pick(rng);
+			auto const dst = pick(rng);
+			auto const weight = pick(rng) % 4;
+			switch (what(rng)) {
+			case 0: g.erase_node(src); break;
+			case 1: g.insert_node(src); break;
+			case 2:
+			case 3:
+				if (g.is_node(src) && g.is_node(dst)) {
+					g.apply({{graph_t::edge_operation::kind::erase, src, dst, weight}});
+				}
+				break;
+			default:
+				g.insert_node(src);
+				g.insert_node(dst);
+				g.insert_edge(src, dst, weight);
+			}
+		}
+		return g;
+	}
+} // namespace
+
+TEST_CASE("Patching a graph with its diff gives the other graph", "[GraphDiff]") {
+	auto rng = std::mt19937(3);
+	auto base = mutate(graph_t{}, 300, rng);
+	for (auto round = 0; round < 30; ++round) {
+		auto const next = mutate(base, 1 + round % 12, rng);
+		auto const delta = gdwg::diff(base, next);
+		CHECK(delta.base_hash == base.structural_hash());
+		CHECK(delta.target_hash == next.structural_hash());
+
+		auto replica = base;
+		gdwg::apply_patch(replica, delta);
+		CHECK(replica == next);
+
+		// and the same once it has been through bytes
+		auto const bytes = gdwg::encode_delta(delta);
+		auto shipped = base;
+		gdwg::apply_patch(shipped, gdwg::decode_delta<int, int>(bytes));
+		CHECK(shipped == next);
+		base = next;
+	}
+	CHECK(gdwg::diff(base, base).empty());
+}
+
+TEST_CASE("A diff lists only what changed", "[GraphDiff]") {
+	auto a = gdwg::graph<std::string, double>{"a", "b", "c", "d"};
+	a.insert_edge("a", "b", 1.5);
+	a.insert_edge("a", "c", 2.0);
+	a.insert_edge("c", "d", 0.5);
+	a.insert_edge("d", "a", 3.0);
+	auto b = a;
+	b.erase_node("d");
+	b.insert_node("e");
+	b.insert_edge("a", "e", 4.0);
+	b.apply({{gdwg::graph<std::string, double>::edge_operation::kind::erase, "a", "c", 2.0}});
+
+	auto const delta = gdwg::diff(a, b);
+	CHECK(delta.erased_nodes == std::vector<std::string>{"d"});
+	CHECK(delta.inserted_nodes == std::vector<std::string>{"e"});
+	// c -> d and d -> a go with d
+	REQUIRE(delta.erased_edges.size() == 1);
+	CHECK(delta.erased_edges[0].from == "a");
+	CHECK(delta.erased_edges[0].to == "c");
+	CHECK(delta.erased_edges[0].weight == 2.0);
+	REQUIRE(delta.inserted_edges.size() == 1);
+	CHECK(delta.inserted_edges[0].to == "e");
+
+	auto const bytes = gdwg::encode_delta(delta);
+	auto const decoded = gdwg::decode_delta<std::string, double>(bytes);
+	CHECK(decoded.erased_nodes == delta.erased_nodes);
+	CHECK(decoded.inserted_nodes == delta.inserted_nodes);
+	CHECK(decoded.inserted_edges[0].weight == 4.0);
+	auto replica = a;
+	gdwg::apply_patch(replica, decoded);
+	CHECK(replica == b);
+}
+
+TEST_CASE("A small change makes a small delta", "[GraphDiff]") {
+	auto g = graph_t{};
+	auto batch = graph_t::batch();
+	for (auto i = 0; i < 2000; ++i) {
+		g.insert_node(i);
+	}
+	for (auto i = 0; i < 2000; ++i) {
+		batch.push_back({graph_t::edge_operation::kind::insert, i, (i * 7 + 1) % 2000, i % 5});
+		batch.push_back({graph_t::edge_operation::kind::insert, i, (i * 13 + 2) % 2000, i % 3});
+	}
+	g.apply(batch);
+	auto next = g;
+	next.insert_edge(5, 6, 100);
+	next.insert_edge(5, 7, 100);
+	next.insert_node(5000);
+
+	auto const bytes = gdwg::encode_delta(gdwg::diff(g, next));
+	CHECK(bytes.size() < 64);
+}
+
+TEST_CASE("Patches only apply where they were taken", "[GraphDiff]") {
+	auto a = graph_t{1, 2};
+	auto b = graph_t{1, 2, 3};
+	b.insert_edge(1, 3, 0);
+	auto const delta = gdwg::diff(a, b);
+	gdwg::apply_patch(a, delta);
+	CHECK(a == b);
+	// a second time, a already moved on
+	CHECK_THROWS_MATCHES(gdwg::apply_patch(a, delta),
+	                     std::runtime_error,
+	                     Catch::Matchers::Message("Cannot call gdwg::apply_patch on a graph the "
+	                                              "delta wasn't taken from"));
+	CHECK(a == b);
+
+	auto bytes = gdwg::encode_delta(delta);
+	bytes.back() ^= 1U;
+	CHECK_THROWS_MATCHES((gdwg::decode_delta<int, int>(bytes)),
+	                     std::runtime_error,
+	                     Catch::Matchers::Message("Cannot call gdwg::decode_delta on bytes that "
+	                                              "aren't an intact delta"));
+	bytes.resize(10);
+	CHECK_THROWS_AS((gdwg::decode_delta<int, int>(bytes)), std::runtime_error);
+}
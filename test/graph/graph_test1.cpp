@@ -2,6 +2,8 @@
 
 #include <catch2/catch.hpp>
 #include <sstream>
+#include <string>
+#include <vector>
 
 /*
 Testing Rationale
@@ -403,6 +405,109 @@ TEST_CASE("Checking nodes in a graph", "[Accessors]") {
 	}
 }
 
+TEST_CASE("Counting nodes and edges in a graph", "[Accessors]") {
+	SECTION("check counts follow the modifiers, num_nodes(), num_edges()") {
+		using graph_t = gdwg::graph<int, int>;
+		auto g = graph_t{1, 2, 3, 4};
+		CHECK(g.num_nodes() == 4);
+		CHECK(g.num_edges() == 0);
+
+		g.insert_edge(1, 4, 3);
+		g.insert_edge(1, 4, 5);
+		g.insert_edge(2, 1, 2);
+		g.insert_edge(3, 3, 1);
+		CHECK(!g.insert_edge(1, 4, 3));
+		CHECK(g.num_edges() == 4);
+
+		g.erase_edge(1, 4, 5);
+		CHECK(g.num_edges() == 3);
+
+		g.erase_node(1);
+		CHECK(g.num_nodes() == 3);
+		CHECK(g.num_edges() == 1);
+
+		auto copy = g;
+		CHECK(copy.num_edges() == 1);
+		g.clear();
+		CHECK(g.num_nodes() == 0);
+		CHECK(g.num_edges() == 0);
+	}
+
+	SECTION("check degrees, out_degree(), in_degree(), degree()") {
+		using graph_t = gdwg::graph<int, int>;
+		auto g = graph_t{1, 2, 3};
+		g.insert_edge(1, 2, 1);
+		g.insert_edge(1, 2, 2);
+		g.insert_edge(1, 3, 1);
+		g.insert_edge(3, 1, 1);
+		g.insert_edge(2, 2, 1);
+
+		CHECK(g.out_degree(1) == 3);
+		CHECK(g.in_degree(1) == 1);
+		CHECK(g.degree(1) == 4);
+		CHECK(g.degree(2) == 4);
+
+		g.replace_node(2, 7);
+		CHECK(g.in_degree(7) == 3);
+		CHECK(g.out_degree(7) == 1);
+
+		g.erase_node(3);
+		CHECK(g.out_degree(1) == 2);
+		CHECK(g.in_degree(1) == 0);
+
+		auto const copy = g;
+		CHECK(copy.degree(7) == 4);
+		CHECK_THROWS_WITH(g.degree(3),
+		                  "Cannot call gdwg::graph<N, E>::degree if the node doesn't exist in the "
+		                  "graph");
+	}
+
+	SECTION("check memory usage grows with the graph, memory_usage()") {
+		using graph_t = gdwg::graph<std::string, int>;
+		auto g = graph_t{"a", "b"};
+		auto const small = g.memory_usage();
+		CHECK(small.nodes > 0);
+		CHECK(small.weight_sets == 0);
+
+		g.insert_node(std::string(100, 'c'));
+		g.insert_edge("a", "b", 1);
+		g.insert_edge("a", "b", 2);
+		auto const large = g.memory_usage();
+		CHECK(large.nodes >= small.nodes + 100);
+		CHECK(large.adjacency_maps > small.adjacency_maps);
+		CHECK(large.weight_sets > 0);
+		CHECK(large.control_blocks > small.control_blocks);
+		CHECK(large.total()
+		      == large.nodes + large.adjacency_maps + large.weight_sets + large.control_blocks);
+
+		g.clear();
+		CHECK(g.memory_usage().total() == 0);
+	}
+
+	SECTION("check nodes shared with the edges count once, memory_usage()") {
+		using graph_t = gdwg::graph<std::string, int>;
+		using kind = graph_t::edge_operation::kind;
+		auto const names = std::vector<std::string>{std::string(50, 'a'), std::string(60, 'b')};
+		auto const bare = graph_t(names.begin(), names.end());
+		auto inserted = bare;
+		inserted.insert_edge(names[0], names[1], 1);
+		inserted.insert_edge(names[1], names[0], 2);
+		auto applied = bare;
+		applied.apply({{kind::insert, names[0], names[1], 1}, {kind::insert, names[1], names[0], 2}});
+		REQUIRE(applied == inserted);
+
+		// apply() keys the edges with the nodes' own values
+		auto const shared = applied.memory_usage();
+		CHECK(shared.nodes == bare.memory_usage().nodes);
+		auto const separate = inserted.memory_usage();
+		CHECK(separate.adjacency_maps == shared.adjacency_maps);
+		CHECK(separate.weight_sets == shared.weight_sets);
+		CHECK(separate.nodes >= shared.nodes + 4 * sizeof(std::string) + 2 * 50 + 2 * 60);
+		// a copy allocates its own keys, as insert_edge() does
+		CHECK(graph_t(applied).memory_usage().total() == separate.total());
+	}
+}
+
 TEST_CASE("Iterators", "[Iterator Access, Iterators]") {
 	SECTION("check begin and dereferencing works simple case, begin(), operator*()") {
 		using graph_t = gdwg::graph<int, int>;
@@ -766,6 +871,233 @@ TEST_CASE("Modifying the nodes and edges in a graph", "[Modifiers]") {
 	}
 }
 
+namespace {
+	// weight whose copy throws for one value, to exercise apply() rolling back
+	struct fragile_weight {
+		int value;
+
+		fragile_weight(int v)
+		: value(v) {}
+		fragile_weight(fragile_weight const& other)
+		: value(other.value) {
+			if (value == 13) {
+				throw std::runtime_error("unlucky");
+			}
+		}
+		auto operator=(fragile_weight const&) -> fragile_weight& = default;
+		auto operator<=>(fragile_weight const&) const = default;
+	};
+} // namespace
+
+TEST_CASE("Applying a batch of edge operations", "[Modifiers]") {
+	SECTION("check a mixed batch matches single operations, apply()") {
+		using graph_t = gdwg::graph<int, int>;
+		using kind = graph_t::edge_operation::kind;
+		auto g = graph_t{1, 2, 3, 4};
+		g.insert_edge(1, 2, 5);
+		g.insert_edge(3, 4, 1);
+
+		auto const changed = g.apply({
+		   {kind::insert, 4, 1, 2},
+		   {kind::insert, 1, 3, 7},
+		   {kind::erase, 3, 4, 1},
+		   {kind::insert, 1, 2, 5},
+		   {kind::erase, 2, 1, 9},
+		   {kind::insert, 1, 2, 6},
+		   {kind::insert, 4, 4, 3},
+		});
+		CHECK(changed == 5);
+
+		auto expected = graph_t{1, 2, 3, 4};
+		expected.insert_edge(1, 2, 5);
+		expected.insert_edge(1, 2, 6);
+		expected.insert_edge(1, 3, 7);
+		expected.insert_edge(4, 1, 2);
+		expected.insert_edge(4, 4, 3);
+		CHECK(g == expected);
+		CHECK(g.num_edges() == 5);
+		CHECK(g.out_degree(1) == 3);
+		CHECK(g.out_degree(3) == 0);
+		CHECK(g.is_node(3));
+	}
+
+	SECTION("check operations on the same edge keep their order, apply()") {
+		using graph_t = gdwg::graph<int, int>;
+		using kind = graph_t::edge_operation::kind;
+		auto g = graph_t{1, 2};
+
+		CHECK(g.apply({{kind::insert, 1, 2, 3}, {kind::erase, 1, 2, 3}}) == 2);
+		CHECK(g.num_edges() == 0);
+		CHECK(g.find(1, 2, 3) == g.end());
+
+		CHECK(g.apply({{kind::erase, 1, 2, 3}, {kind::insert, 1, 2, 3}}) == 1);
+		CHECK(g.find(1, 2, 3) != g.end());
+	}
+
+	SECTION("check a missing endpoint rejects the whole batch, apply()") {
+		using graph_t = gdwg::graph<int, int>;
+		using kind = graph_t::edge_operation::kind;
+		auto g = graph_t{1, 2};
+		g.insert_edge(1, 2, 3);
+		auto const before = g;
+
+		auto const operations = graph_t::batch{
+		   {kind::insert, 1, 1, 1},
+		   {kind::erase, 1, 2, 3},
+		   {kind::insert, 2, 9, 1},
+		};
+		CHECK_THROWS_WITH(g.apply(operations),
+		                  "Cannot call gdwg::graph<N, E>::apply when either src or dst node does not "
+		                  "exist");
+		CHECK(g == before);
+	}
+
+	SECTION("check a failed allocation rolls the batch back, apply()") {
+		using graph_t = gdwg::graph<int, fragile_weight>;
+		using kind = graph_t::edge_operation::kind;
+		auto g = graph_t{1, 2, 3};
+		g.insert_edge(1, 2, fragile_weight(1));
+		g.insert_edge(2, 3, fragile_weight(2));
+		auto const edges = g.num_edges();
+		auto const hash = g.structural_hash();
+
+		auto operations = graph_t::batch();
+		operations.push_back({kind::erase, 1, 2, fragile_weight(1)});
+		operations.push_back({kind::insert, 2, 1, fragile_weight(4)});
+		operations.push_back({kind::erase, 2, 3, fragile_weight(2)});
+		operations.push_back({kind::insert, 3, 1, fragile_weight(5)});
+		operations.push_back({kind::insert, 3, 2, fragile_weight(6)});
+		operations.back().weight.value = 13;
+		CHECK_THROWS_WITH(g.apply(operations), "unlucky");
+
+		CHECK(g.num_edges() == edges);
+		CHECK(g.structural_hash() == hash);
+		CHECK(g.connections(1) == std::vector<int>{2});
+		CHECK(g.connections(2) == std::vector<int>{3});
+		CHECK(g.connections(3).empty());
+		CHECK(g.out_degree(3) == 0);
+	}
+}
+
+namespace {
+	// writes every change it is told about as one line
+	struct change_log : gdwg::graph<int, int>::observer {
+		std::vector<std::string> lines;
+
+		auto node_inserted(int const& value) -> void override {
+			lines.push_back("+" + std::to_string(value));
+		}
+		auto node_erased(int const& value) -> void override {
+			lines.push_back("-" + std::to_string(value));
+		}
+		auto node_replaced(int const& old_data, int const& new_data) -> void override {
+			lines.push_back(std::to_string(old_data) + "=>" + std::to_string(new_data));
+		}
+		auto edge_inserted(int const& src, int const& dst, int const& weight) -> void override {
+			lines.push_back("+" + std::to_string(src) + "->" + std::to_string(dst) + "|"
+			                + std::to_string(weight));
+		}
+		auto edge_erased(int const& src, int const& dst, int const& weight) -> void override {
+			lines.push_back("-" + std::to_string(src) + "->" + std::to_string(dst) + "|"
+			                + std::to_string(weight));
+		}
+		auto reloaded() -> void override {
+			lines.emplace_back("reloaded");
+		}
+		auto detached() -> void override {
+			lines.emplace_back("detached");
+		}
+	};
+} // namespace
+
+TEST_CASE("Observing changes to a graph", "[Modifiers]") {
+	using graph_t = gdwg::graph<int, int>;
+	using lines = std::vector<std::string>;
+
+	SECTION("check single modifiers are reported, subscribe()") {
+		auto log = change_log();
+		auto g = graph_t{1, 2};
+		g.subscribe(log);
+		g.subscribe(log);
+
+		g.insert_node(3);
+		g.insert_node(3);
+		g.insert_edge(1, 2, 4);
+		g.insert_edge(1, 2, 4);
+		g.insert_edge(3, 1, 5);
+		g.replace_node(2, 7);
+		g.erase_edge(1, 7, 4);
+		// erasing 1's last outgoing edge erases 1 as well
+		CHECK(log.lines == lines{"+3", "+1->2|4", "+3->1|5", "2=>7", "-1->7|4", "-3->1|5", "-1"});
+
+		log.lines.clear();
+		g.insert_node(1);
+		g.insert_edge(1, 3, 2);
+		g.erase_node(3);
+		CHECK(log.lines == lines{"+1", "+1->3|2", "-1->3|2", "-3"});
+	}
+
+	SECTION("check apply() and its rollback are reported, subscribe()") {
+		using kind = graph_t::edge_operation::kind;
+		auto log = change_log();
+		auto g = graph_t{1, 2};
+		g.insert_edge(1, 2, 3);
+		g.subscribe(log);
+
+		g.apply({{kind::erase, 1, 2, 3}, {kind::insert, 2, 1, 4}});
+		CHECK(log.lines == lines{"-1->2|3", "+2->1|4"});
+
+		log.lines.clear();
+		CHECK_THROWS(g.apply({{kind::insert, 1, 1, 1}, {kind::insert, 1, 9, 1}}));
+		CHECK(log.lines.empty());
+	}
+
+	SECTION("check wholesale changes and destruction, subscribe()") {
+		auto log = change_log();
+		{
+			auto g = graph_t{1, 2};
+			g.subscribe(log);
+			g = graph_t{3};
+			g.clear();
+			auto copy = g;
+			copy.insert_node(4);
+			auto moved = std::move(g);
+		}
+		CHECK(log.lines == lines{"reloaded", "reloaded", "reloaded", "detached"});
+	}
+
+	SECTION("check nothing is reported after unsubscribe()") {
+		auto log = change_log();
+		auto g = graph_t{1};
+		g.subscribe(log);
+		g.unsubscribe(log);
+		g.insert_node(2);
+		g.erase_node(1);
+		CHECK(log.lines.empty());
+	}
+
+	SECTION("check an observer can go before its graphs, ~observer()") {
+		auto g = graph_t{1};
+		auto other = graph_t{2};
+		auto kept = change_log();
+		{
+			auto log = change_log();
+			g.subscribe(log);
+			other.subscribe(log);
+			g.subscribe(kept);
+			// a copy isn't subscribed to anything
+			auto copy = log;
+			g.insert_node(3);
+			CHECK(log.lines == lines{"+3"});
+			CHECK(copy.lines.empty());
+		}
+		g.insert_node(4);
+		other.insert_node(5);
+		// kept goes before g as well
+		CHECK(kept.lines == lines{"+3", "+4"});
+	}
+}
+
 TEST_CASE("Checking if graphs are equal", "[Comparisons]") {
 	SECTION("check if 2 graphs are equal, operator==()") {
 		using graph_t = gdwg::graph<int, int>;
@@ -829,6 +1161,116 @@ TEST_CASE("Checking if graphs are equal", "[Comparisons]") {
 	}
 }
 
+TEST_CASE("Checking the structural hash of a graph", "[Comparisons]") {
+	SECTION("check insertion order doesn't change the hash, structural_hash()") {
+		using graph_t = gdwg::graph<int, int>;
+		auto g = graph_t{1, 2, 3, 4};
+		auto g2 = graph_t{4, 3, 2, 1};
+		g.insert_edge(1, 4, 3);
+		g.insert_edge(2, 4, 2);
+		g2.insert_edge(2, 4, 2);
+		g2.insert_edge(1, 4, 3);
+
+		CHECK(g.structural_hash() == g2.structural_hash());
+		CHECK(g == g2);
+	}
+
+	SECTION("check erasing restores the hash, structural_hash()") {
+		using graph_t = gdwg::graph<int, int>;
+		auto g = graph_t{1, 2, 3, 4};
+		g.insert_edge(1, 4, 3);
+		auto const before = g.structural_hash();
+
+		g.insert_node(5);
+		g.insert_edge(5, 1, 2);
+		g.insert_edge(2, 5, 7);
+		CHECK(g.structural_hash() != before);
+
+		g.erase_node(5);
+		CHECK(g.structural_hash() == before);
+	}
+
+	SECTION("check copies and replaced nodes compare equal, operator==()") {
+		using graph_t = gdwg::graph<int, int>;
+		auto g = graph_t{1, 2, 3};
+		g.insert_edge(1, 2, 3);
+		g.insert_edge(1, 1, 4);
+		g.insert_edge(3, 1, 5);
+		auto const copy = g;
+		CHECK(copy == g);
+
+		g.replace_node(1, 7);
+		auto expected = graph_t{7, 2, 3};
+		expected.insert_edge(7, 2, 3);
+		expected.insert_edge(7, 7, 4);
+		expected.insert_edge(3, 7, 5);
+		CHECK(g == expected);
+		CHECK(g.structural_hash() == expected.structural_hash());
+		CHECK(g != copy);
+	}
+
+	SECTION("check graphs differing only by weight are unequal, operator==()") {
+		using graph_t = gdwg::graph<std::string, double>;
+		auto g = graph_t{"a", "b"};
+		auto g2 = graph_t{"a", "b"};
+		g.insert_edge("a", "b", 1.5);
+		g2.insert_edge("a", "b", 2.5);
+		CHECK(g != g2);
+	}
+}
+
+TEST_CASE("Checking the version of a graph", "[Comparisons]") {
+	using graph_t = gdwg::graph<int, int>;
+
+	SECTION("check every change moves the version on, version()") {
+		auto g = graph_t{1, 2};
+		auto seen = g.version();
+		auto moved_on = [&] {
+			auto const now = g.version();
+			auto const later = now > seen;
+			seen = now;
+			return later;
+		};
+
+		CHECK(g.insert_edge(1, 2, 3));
+		CHECK(moved_on());
+		CHECK(g.replace_node(2, 4));
+		CHECK(moved_on());
+		CHECK(g.erase_edge(1, 4, 3));
+		CHECK(moved_on());
+		g.apply({{graph_t::edge_operation::kind::insert, 4, 4, 1}});
+		CHECK(moved_on());
+		CHECK(g.erase_node(4));
+		CHECK(moved_on());
+		g.clear();
+		CHECK(moved_on());
+	}
+
+	SECTION("check no-op modifiers leave the version alone, version()") {
+		auto g = graph_t{1, 2};
+		g.insert_edge(1, 2, 3);
+		auto const before = g.version();
+		CHECK(!g.insert_node(1));
+		CHECK(!g.insert_edge(1, 2, 3));
+		CHECK(!g.replace_node(1, 2));
+		CHECK(!g.erase_node(9));
+		CHECK(!g.erase_edge(2, 1, 3));
+		CHECK(g.apply({}) == 0);
+		CHECK(g.version() == before);
+	}
+
+	SECTION("check assignment and moving from never go back, version()") {
+		auto g = graph_t{1, 2, 3};
+		auto const before = g.version();
+		g = graph_t{};
+		CHECK(g.version() > before);
+		auto const assigned = g.version();
+		auto taken = std::move(g);
+		CHECK(taken.version() == assigned);
+		CHECK(g.version() > assigned);
+	}
+}
+
 TEST_CASE("Checking if extractor works", "[Extractor]") {
 	SECTION("fully formed graph, operator<<()") {
 		using graph_t = gdwg::graph<int, int>;
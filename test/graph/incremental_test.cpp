@@ -0,0 +1,208 @@
+#include "gdwg/incremental.hpp"
+
+#include "gdwg/components.hpp"
+
+#include <catch2/catch.hpp>
+#include <map>
+#include <optional>
+#include <random>
+#include <set>
+#include <vector>
+
+namespace {
+	using graph_t = gdwg::graph<int, int>;
+
+	// plain Dijkstra over the public interface
+	auto reference_distances(graph_t const& g, int source) -> std::map<int, int> {
+		auto dist = std::map<int, int>();
+		if (!g.is_node(source)) {
+			return dist;
+		}
+		auto pending = std::set<std::pair<int, int>>{{0, source}};
+		dist[source] = 0;
+		while (!pending.empty()) {
+			auto const [d, x] = *pending.begin();
+			pending.erase(pending.begin());
+			for (auto y : g.connections(x)) {
+				auto const through = d + g.weights(x, y).front();
+				auto found = dist.find(y);
+				if (found == dist.end() || through < found->second) {
+					if (found != dist.end()) {
+						pending.erase({found->second, y});
+					}
+					dist[y] = through;
+					pending.emplace(through, y);
+				}
+			}
+		}
+		return dist;
+	}
+
+	auto check_connectivity(graph_t const& g, gdwg::incremental_connectivity<int, int> const& conn)
+	   -> void {
+		auto const expected = gdwg::weakly_connected_components(g, 1);
+		REQUIRE(conn.component_count() == expected.count);
+		auto const nodes = g.nodes();
+		for (auto i = std::size_t{0}; i < nodes.size(); ++i) {
+			for (auto j = i + 1; j < nodes.size(); ++j) {
+				auto const same = expected.component[i] == expected.component[j];
+				REQUIRE(conn.connected(nodes[i], nodes[j]) == same);
+			}
+		}
+	}
+
+	auto check_distances(graph_t const& g, gdwg::incremental_shortest_paths<int, int> const& sssp)
+	   -> void {
+		auto const expected = reference_distances(g, sssp.source());
+		for (auto const& node : g.nodes()) {
+			auto const found = expected.find(node);
+			auto const distance = sssp.distance(node);
+			REQUIRE(distance.has_value() == (found != expected.end()));
+			if (!distance) {
+				CHECK(sssp.path(node).empty());
+				continue;
+			}
+			REQUIRE(*distance == found->second);
+
+			// the path really is that long
+			auto const path = sssp.path(node);
+			REQUIRE(path.front() == sssp.source());
+			REQUIRE(path.back() == node);
+			auto length = 0;
+			for (auto i = std::size_t{1}; i < path.size(); ++i) {
+				length += g.weights(path[i - 1], path[i]).front();
+			}
+			REQUIRE(length == *distance);
+		}
+	}
+} // namespace
+
+TEST_CASE("Maintaining connectivity through the change feed", "[Incremental]") {
+	auto g = graph_t{1, 2, 3, 4, 5};
+	auto conn = gdwg::incremental_connectivity<int, int>(g);
+
+	SECTION("check merges and splits, connected()") {
+		CHECK(conn.component_count() == 5);
+		g.insert_edge(1, 2, 1);
+		g.insert_edge(3, 2, 1);
+		g.insert_edge(3, 2, 4);
+		// keeps 3 around once its edges to 2 are gone
+		g.insert_edge(3, 3, 0);
+		CHECK(conn.connected(1, 3));
+		CHECK(conn.component_size(1) == 3);
+		CHECK(conn.component_count() == 3);
+
+		g.erase_edge(3, 2, 1);
+		CHECK(conn.connected(1, 3));
+		g.erase_edge(3, 2, 4);
+		CHECK(!conn.connected(1, 3));
+		CHECK(conn.component_count() == 4);
+
+		g.replace_node(5, 9);
+		CHECK(conn.component_size(9) == 1);
+		CHECK_THROWS_WITH(conn.connected(5, 1),
+		                  "Cannot call gdwg::incremental_connectivity<N, E>::connected if the node "
+		                  "doesn't exist in the graph");
+	}
+
+	SECTION("check wholesale changes rebuild, connected()") {
+		g.insert_edge(1, 2, 1);
+		auto other = graph_t{1, 2};
+		g = other;
+		CHECK(conn.component_count() == 2);
+		g.clear();
+		CHECK(conn.component_count() == 0);
+	}
+
+	SECTION("check against recomputing after random changes, connected()") {
+		auto rng = std::mt19937(7);
+		auto pick = std::uniform_int_distribution<int>(0, 29);
+		for (auto i = 0; i < 400; ++i) {
+			auto const a = pick(rng);
+			auto const b = pick(rng);
+			auto const w = pick(rng) % 3;
+			switch (pick(rng) % 6) {
+			case 0: g.insert_node(a); break;
+			case 1: g.erase_node(a); break;
+			case 2:
+			case 3:
+				g.insert_node(a);
+				g.insert_node(b);
+				g.insert_edge(a, b, w);
+				break;
+			case 4:
+				if (g.is_node(a) && g.is_node(b)) {
+					g.erase_edge(a, b, w);
+				}
+				break;
+			default:
+				if (g.is_node(a)) {
+					g.replace_node(a, b);
+				}
+				break;
+			}
+			check_connectivity(g, conn);
+		}
+	}
+}
+
+TEST_CASE("Maintaining shortest paths through the change feed", "[Incremental]") {
+	auto g = graph_t{1, 2, 3, 4};
+	auto sssp = gdwg::incremental_shortest_paths<int, int>(g, 1);
+
+	SECTION("check shortcuts and detours, distance() path()") {
+		CHECK(sssp.distance(1) == 0);
+		CHECK(sssp.distance(2) == std::nullopt);
+		g.insert_edge(1, 2, 5);
+		g.insert_edge(2, 3, 5);
+		CHECK(sssp.distance(3) == 10);
+		g.insert_edge(1, 3, 4);
+		CHECK(sssp.distance(3) == 4);
+		CHECK(sssp.path(3) == std::vector<int>{1, 3});
+
+		g.insert_edge(1, 3, 20);
+		g.erase_edge(1, 3, 4);
+		CHECK(sssp.distance(3) == 10);
+		CHECK(sssp.path(3) == std::vector<int>{1, 2, 3});
+
+		g.replace_node(1, 0);
+		CHECK(sssp.source() == 0);
+		CHECK(sssp.distance(2) == 5);
+		CHECK_THROWS_WITH(sssp.distance(9),
+		                  "Cannot call gdwg::incremental_shortest_paths<N, E>::distance if the node "
+		                  "doesn't exist in the graph");
+	}
+
+	SECTION("check an erased source leaves everything unreachable, distance()") {
+		g.insert_edge(1, 2, 1);
+		g.insert_edge(3, 2, 1);
+		g.erase_node(1);
+		CHECK(sssp.distance(2) == std::nullopt);
+		g.insert_node(1);
+		g.insert_edge(1, 3, 2);
+		CHECK(sssp.distance(2) == 3);
+	}
+
+	SECTION("check against recomputing after random changes, distance()") {
+		using kind = graph_t::edge_operation::kind;
+		auto rng = std::mt19937(11);
+		auto pick = std::uniform_int_distribution<int>(0, 24);
+		for (auto i = 0; i < 400; ++i) {
+			auto const a = pick(rng);
+			auto const b = pick(rng);
+			auto const w = pick(rng) % 6;
+			g.insert_node(a);
+			g.insert_node(b);
+			switch (pick(rng) % 5) {
+			case 0:
+			case 1: g.insert_edge(a, b, w); break;
+			case 2: g.erase_edge(a, b, w); break;
+			case 3:
+				g.apply({{kind::insert, b, a, w}, {kind::erase, a, b, w}, {kind::insert, a, a, w}});
+				break;
+			default: g.erase_node(a); break;
+			}
+			check_distances(g, sssp);
+		}
+	}
+}
@@ -0,0 +1,59 @@
+#include "gdwg/graph.hpp"
+
+#include <catch2/catch.hpp>
+#include <sstream>
+
+// Built with GDWG_INSTRUMENTATION=1, see test/graph/CMakeLists.txt.
+
+TEST_CASE("Counting graph operations", "[Instrumentation]") {
+	using gdwg::instrumentation::operation;
+	static_assert(gdwg::instrumentation::policy::enabled);
+	static_assert(std::is_empty_v<gdwg::instrumentation::null_policy::scope>);
+
+	SECTION("check calls, allocations and comparisons are attributed, take_snapshot()") {
+		using graph_t = gdwg::graph<int, int>;
+		auto g = graph_t{1, 2, 3};
+		gdwg::instrumentation::reset();
+
+		g.insert_edge(1, 2, 3);
+		g.insert_edge(1, 3, 4);
+		g.insert_edge(2, 3, 1);
+		auto const snap = gdwg::instrumentation::take_snapshot();
+
+		CHECK(snap[operation::insert_edge].calls == 3);
+		CHECK(snap[operation::insert_edge].allocations >= 9);
+		CHECK(snap[operation::insert_edge].comparisons > 0);
+		CHECK(snap[operation::erase_node].calls == 0);
+		CHECK(snap[operation::insert_edge].percentile(0.99) > 0);
+	}
+
+	SECTION("check nested operations are counted separately, take_snapshot()") {
+		using graph_t = gdwg::graph<int, int>;
+		auto g = graph_t{1, 2, 3};
+		g.insert_edge(1, 2, 3);
+		g.insert_edge(2, 3, 4);
+		gdwg::instrumentation::reset();
+
+		g.erase_edge(1, 2, 3);
+		for (auto iter = g.begin(); iter != g.end(); ++iter) {
+		}
+		g.erase_node(3);
+		auto const snap = gdwg::instrumentation::take_snapshot();
+
+		CHECK(snap[operation::erase_edge].calls == 1);
+		CHECK(snap[operation::find].calls == 1);
+		CHECK(snap[operation::iterator_increment].calls > 0);
+		CHECK(snap[operation::erase_node].calls >= 1);
+	}
+
+	SECTION("check snapshots print the operations that ran, operator<<()") {
+		auto g = gdwg::graph<int, int>{1, 2};
+		gdwg::instrumentation::reset();
+		g.insert_edge(1, 2, 3);
+
+		auto out = std::ostringstream{};
+		out << gdwg::instrumentation::take_snapshot();
+		CHECK(out.str().rfind("insert_edge calls=1 ", 0) == 0);
+		CHECK(out.str().find("erase_node") == std::string::npos);
+	}
+}
@@ -0,0 +1,153 @@
+#include "gdwg/max_flow.hpp"
+
+#include <algorithm>
+#include <catch2/catch.hpp>
+#include <cstdint>
+#include <limits>
+#include <random>
+#include <vector>
+
+namespace {
+	// Edmonds-Karp over a capacity matrix
+	auto reference_flow(std::vector<std::vector<std::int64_t>> capacity, int source, int sink)
+	   -> std::int64_t {
+		auto const n = static_cast<int>(capacity.size());
+		auto total = std::int64_t{0};
+		for (;;) {
+			auto parent = std::vector<int>(capacity.size(), -1);
+			parent[static_cast<std::size_t>(source)] = source;
+			auto queue = std::vector<int>{source};
+			for (auto i = std::size_t{0}; i < queue.size(); ++i) {
+				auto const u = queue[i];
+				for (auto v = 0; v < n; ++v) {
+					auto const uu = static_cast<std::size_t>(u);
+					auto const vv = static_cast<std::size_t>(v);
+					if (parent[vv] == -1 && capacity[uu][vv] > 0) {
+						parent[vv] = u;
+						queue.push_back(v);
+					}
+				}
+			}
+			if (parent[static_cast<std::size_t>(sink)] == -1) {
+				return total;
+			}
+			auto bottleneck = std::numeric_limits<std::int64_t>::max();
+			for (auto v = sink; v != source; v = parent[static_cast<std::size_t>(v)]) {
+				auto const u = static_cast<std::size_t>(parent[static_cast<std::size_t>(v)]);
+				bottleneck = std::min(bottleneck, capacity[u][static_cast<std::size_t>(v)]);
+			}
+			for (auto v = sink; v != source; v = parent[static_cast<std::size_t>(v)]) {
+				auto const u = static_cast<std::size_t>(parent[static_cast<std::size_t>(v)]);
+				capacity[u][static_cast<std::size_t>(v)] -= bottleneck;
+				capacity[static_cast<std::size_t>(v)][u] += bottleneck;
+			}
+			total += bottleneck;
+		}
+	}
+} // namespace
+
+TEST_CASE("Push-relabel agrees with Edmonds-Karp", "[MaxFlow]") {
+	auto rng = std::mt19937(17);
+	for (auto round = 0; round < 40; ++round) {
+		auto const n = 2 + round % 25;
+		auto const edges = n * (1 + round % 4);
+		auto g = gdwg::graph<int, int>();
+		auto capacity = std::vector<std::vector<std::int64_t>>(
+		   static_cast<std::size_t>(n),
+		   std::vector<std::int64_t>(static_cast<std::size_t>(n)));
+		for (auto i = 0; i < n; ++i) {
+			g.insert_node(i);
+		}
+		auto pick = std::uniform_int_distribution<int>(0, n - 1);
+		auto weight = std::uniform_int_distribution<int>(0, 20);
+		for (auto i = 0; i < edges; ++i) {
+			auto const u = pick(rng);
+			auto const v = pick(rng);
+			auto const w = weight(rng);
+			if (g.insert_edge(u, v, w) && u != v) {
+				capacity[static_cast<std::size_t>(u)][static_cast<std::size_t>(v)] += w;
+			}
+		}
+
+		auto const source = 0;
+		auto const sink = n - 1;
+		auto const result = gdwg::max_flow(g, source, sink);
+		CHECK(result.flow == reference_flow(capacity, source, sink));
+		CHECK(result.source_side[static_cast<std::size_t>(source)] == 1);
+		CHECK(result.source_side[static_cast<std::size_t>(sink)] == 0);
+		auto cut = std::int64_t{0};
+		for (auto const& e : result.cut) {
+			CHECK(result.source_side[e.src] == 1);
+			CHECK(result.source_side[e.dst] == 0);
+			cut += e.capacity;
+		}
+		CHECK(cut == result.flow);
+	}
+}
+
+TEST_CASE("Parallel edges add their capacities", "[MaxFlow]") {
+	auto g = gdwg::graph<char, double>{'s', 'a', 't'};
+	g.insert_edge('s', 'a', 1.5);
+	g.insert_edge('s', 'a', 2.5);
+	g.insert_edge('a', 't', 3.0);
+	g.insert_edge('a', 't', 0.25);
+	g.insert_edge('t', 's', 100.0);
+	auto const result = gdwg::max_flow(g, 's', 't');
+	CHECK(result.flow == Approx(3.25));
+	REQUIRE(result.cut.size() == 1);
+	// ids follow g.nodes(), which sorts 'a' first
+	CHECK(result.cut[0].src == 0);
+	CHECK(result.cut[0].dst == 2);
+	CHECK(result.cut[0].capacity == Approx(3.25));
+	CHECK(result.source_side == std::vector<std::uint8_t>{1, 1, 0});
+}
+
+TEST_CASE("A layered network needs the gap and global relabel heuristics", "[MaxFlow]") {
+	// every layer fully joined to the next, with a bottleneck layer halfway along
+	auto constexpr layers = 30;
+	auto constexpr width = 12;
+	auto g = gdwg::graph<int, int>();
+	auto const id = [](int layer, int i) { return layer * width + i; };
+	auto const source = -1;
+	auto const sink = layers * width;
+	g.insert_node(source);
+	g.insert_node(sink);
+	for (auto layer = 0; layer < layers; ++layer) {
+		for (auto i = 0; i < width; ++i) {
+			g.insert_node(id(layer, i));
+		}
+	}
+	for (auto i = 0; i < width; ++i) {
+		g.insert_edge(source, id(0, i), 1000);
+		g.insert_edge(id(layers - 1, i), sink, 1000);
+	}
+	for (auto layer = 0; layer + 1 < layers; ++layer) {
+		for (auto i = 0; i < width; ++i) {
+			for (auto j = 0; j < width; ++j) {
+				g.insert_edge(id(layer, i), id(layer + 1, j), layer == layers / 2 ? 1 : 50);
+			}
+		}
+	}
+	auto const result = gdwg::max_flow(g, source, sink);
+	CHECK(result.flow == width * width);
+	CHECK(result.cut.size() == static_cast<std::size_t>(width * width));
+}
+
+TEST_CASE("Max flow rejects what it can't solve", "[MaxFlow]") {
+	auto g = gdwg::graph<int, int>{1, 2};
+	g.insert_edge(1, 2, 4);
+	CHECK(gdwg::max_flow(g, 2, 1).flow == 0);
+	CHECK_THROWS_MATCHES(gdwg::max_flow(g, 1, 3),
+	                     std::runtime_error,
+	                     Catch::Matchers::Message("Cannot call gdwg::max_flow if source or sink "
+	                                              "don't exist in the graph"));
+	CHECK_THROWS_MATCHES(gdwg::max_flow(g, 1, 1),
+	                     std::runtime_error,
+	                     Catch::Matchers::Message("Cannot call gdwg::max_flow with the same source "
+	                                              "and sink"));
+	g.insert_edge(2, 1, -4);
+	CHECK_THROWS_MATCHES(gdwg::max_flow(g, 1, 2),
+	                     std::runtime_error,
+	                     Catch::Matchers::Message("Cannot call gdwg::max_flow with a negative "
+	                                              "capacity"));
+}
@@ -0,0 +1,170 @@
+#include "gdwg/neighborhood.hpp"
+
+#include <algorithm>
+#include <catch2/catch.hpp>
+#include <cstdint>
+#include <random>
+#include <set>
+#include <string>
+#include <vector>
+
+namespace {
+	using graph_t = gdwg::graph<int, int>;
+
+	auto random_graph(int nodes, int edges, unsigned seed) -> graph_t {
+		auto g = graph_t{};
+		for (auto i = 0; i < nodes; ++i) {
+			g.insert_node(i);
+		}
+		auto rng = std::mt19937(seed);
+		auto pick = std::uniform_int_distribution<int>(0, nodes - 1);
+		for (auto i = 0; i < edges; ++i) {
+			g.insert_edge(pick(rng), pick(rng), i % 3);
+		}
+		return g;
+	}
+
+	// every unordered triple of distinct nodes joined pairwise in either direction
+	auto reference_triangles(graph_t const& g) -> std::uint64_t {
+		auto const nodes = g.nodes();
+		auto joined = [&](int a, int b) { return g.is_connected(a, b) || g.is_connected(b, a); };
+		auto count = std::uint64_t{0};
+		for (auto i = std::size_t{0}; i < nodes.size(); ++i) {
+			for (auto j = i + 1; j < nodes.size(); ++j) {
+				if (!joined(nodes[i], nodes[j])) {
+					continue;
+				}
+				for (auto k = j + 1; k < nodes.size(); ++k) {
+					count += joined(nodes[i], nodes[k]) && joined(nodes[j], nodes[k]) ? 1 : 0;
+				}
+			}
+		}
+		return count;
+	}
+} // namespace
+
+TEST_CASE("Sorted set intersection", "[Neighborhood]") {
+	auto rng = std::mt19937(7);
+	for (auto round = 0; round < 50; ++round) {
+		auto pick = std::uniform_int_distribution<std::uint32_t>(0, 200);
+		auto a = std::set<std::uint32_t>();
+		auto b = std::set<std::uint32_t>();
+		for (auto i = 0; i < round; ++i) {
+			a.insert(pick(rng));
+			b.insert(pick(rng) / 2);
+		}
+		auto const left = std::vector<std::uint32_t>(a.begin(), a.end());
+		auto const right = std::vector<std::uint32_t>(b.begin(), b.end());
+		auto expected = std::vector<std::uint32_t>();
+		std::set_intersection(left.begin(),
+		                      left.end(),
+		                      right.begin(),
+		                      right.end(),
+		                      std::back_inserter(expected));
+		auto actual = std::vector<std::uint32_t>(left.size());
+		actual.resize(gdwg::detail::intersect(left, right, actual.data()));
+		CHECK(actual == expected);
+		CHECK(gdwg::detail::intersect(right, left) == expected.size());
+	}
+}
+
+TEST_CASE("Common neighbours", "[Neighborhood]") {
+	auto g = gdwg::graph<std::string, int>{"a", "b", "c", "d", "e"};
+	g.insert_edge("a", "c", 1);
+	g.insert_edge("a", "c", 2);
+	g.insert_edge("a", "d", 1);
+	g.insert_edge("a", "e", 1);
+	g.insert_edge("b", "c", 1);
+	g.insert_edge("b", "e", 1);
+	g.insert_edge("e", "a", 1);
+	auto const sets = gdwg::neighbor_sets<std::string, int>(g);
+
+	SECTION("check shared targets, common_neighbors() count_common_neighbors()") {
+		CHECK(sets.common_neighbors("a", "b") == std::vector<std::string>{"c", "e"});
+		CHECK(sets.count_common_neighbors("a", "b") == 2);
+		CHECK(sets.common_neighbors("a", "c").empty());
+		CHECK(sets.common_neighbors("a", "a") == g.connections("a"));
+	}
+
+	SECTION("check similarity, jaccard()") {
+		CHECK(sets.jaccard("a", "b") == Approx(2.0 / 3.0));
+		CHECK(sets.jaccard("a", "a") == 1.0);
+		CHECK(sets.jaccard("c", "d") == 0.0);
+		CHECK(sets.jaccard("a", "e") == 0.0);
+	}
+
+	SECTION("check renumbered ids give the same answers, common_neighbors()") {
+		auto const renumbered = gdwg::neighbor_sets<std::string, int>(
+		   gdwg::frozen_graph<std::string, int>(g, gdwg::node_order::degree));
+		CHECK(renumbered.common_neighbors("a", "b") == std::vector<std::string>{"c", "e"});
+		CHECK(renumbered.jaccard("a", "b") == Approx(2.0 / 3.0));
+	}
+
+	SECTION("check missing nodes, jaccard()") {
+		CHECK_THROWS_MATCHES(sets.jaccard("a", "z"),
+		                     std::runtime_error,
+		                     Catch::Matchers::Message("Cannot call gdwg::neighbor_sets<N, "
+		                                              "E>::jaccard if a or b node don't exist in "
+		                                              "the graph"));
+	}
+
+	SECTION("check against connections(), common_neighbors()") {
+		auto const big = random_graph(60, 900, 3);
+		auto const big_sets = gdwg::neighbor_sets<int, int>(big);
+		for (auto a = 0; a < 60; a += 7) {
+			for (auto b = 0; b < 60; b += 5) {
+				auto const left = big.connections(a);
+				auto const right = big.connections(b);
+				auto expected = std::vector<int>();
+				std::set_intersection(left.begin(),
+				                      left.end(),
+				                      right.begin(),
+				                      right.end(),
+				                      std::back_inserter(expected));
+				CHECK(big_sets.common_neighbors(a, b) == expected);
+			}
+		}
+	}
+}
+
+TEST_CASE("Triangle counting", "[Neighborhood]") {
+	SECTION("check small graphs, triangle_count()") {
+		auto g = graph_t{1, 2, 3, 4};
+		g.insert_edge(1, 2, 0);
+		g.insert_edge(2, 3, 0);
+		g.insert_edge(3, 1, 0);
+		CHECK(gdwg::triangle_count(g) == 1);
+		// reversed, repeated and self edges add nothing
+		g.insert_edge(2, 1, 0);
+		g.insert_edge(1, 2, 5);
+		g.insert_edge(3, 3, 0);
+		CHECK(gdwg::triangle_count(g) == 1);
+		g.insert_edge(4, 1, 0);
+		g.insert_edge(4, 2, 0);
+		g.insert_edge(3, 4, 0);
+		CHECK(gdwg::triangle_count(g) == 4);
+		CHECK(gdwg::triangle_count(graph_t{}) == 0);
+	}
+
+	SECTION("check against brute force, triangle_count()") {
+		for (auto seed = 0U; seed < 4; ++seed) {
+			auto const g = random_graph(80, 400, seed);
+			auto const expected = reference_triangles(g);
+			CHECK(gdwg::triangle_count(g, 1) == expected);
+			CHECK(gdwg::triangle_count(g, 4) == expected);
+		}
+	}
+
+	SECTION("check a skewed graph, triangle_count()") {
+		// every pair of spokes joined through the hub is one triangle per rim edge
+		auto g = graph_t{};
+		for (auto v = 0; v <= 500; ++v) {
+			g.insert_node(v);
+		}
+		for (auto v = 1; v <= 500; ++v) {
+			g.insert_edge(0, v, 0);
+			g.insert_edge(v, v % 500 + 1, 0);
+		}
+		CHECK(gdwg::triangle_count(g) == 500);
+	}
+}
@@ -0,0 +1,183 @@
+#include "gdwg/pagerank.hpp"
+
+#include <catch2/catch.hpp>
+#include <cmath>
+#include <cstdint>
+#include <map>
+#include <numeric>
+#include <random>
+#include <vector>
+
+namespace {
+	using graph_t = gdwg::graph<int, int>;
+
+	auto random_graph(int nodes, int edges, unsigned seed) -> graph_t {
+		auto g = graph_t{};
+		for (auto i = 0; i < nodes; ++i) {
+			g.insert_node(i);
+		}
+		auto rng = std::mt19937(seed);
+		auto pick = std::uniform_int_distribution<int>(0, nodes - 1);
+		for (auto i = 0; i < edges; ++i) {
+			g.insert_edge(pick(rng), pick(rng), 1 + i % 4);
+		}
+		return g;
+	}
+
+	// push style power iteration straight off the graph's own interface
+	auto reference_pagerank(graph_t const& g, std::vector<double> const& teleport, double d)
+	   -> std::vector<double> {
+		auto const nodes = g.nodes();
+		auto const n = nodes.size();
+		auto rank = teleport;
+		for (auto iteration = 0; iteration < 500; ++iteration) {
+			auto next = std::vector<double>(n);
+			auto leaked = 0.0;
+			for (auto u = std::size_t{0}; u < n; ++u) {
+				auto total = 0.0;
+				for (auto const& v : g.connections(nodes[u])) {
+					for (auto w : g.weights(nodes[u], v)) {
+						total += w;
+					}
+				}
+				if (total == 0) {
+					leaked += rank[u];
+					continue;
+				}
+				for (auto const& v : g.connections(nodes[u])) {
+					for (auto w : g.weights(nodes[u], v)) {
+						next[static_cast<std::size_t>(v)] += d * rank[u] * w / total;
+					}
+				}
+			}
+			for (auto v = std::size_t{0}; v < n; ++v) {
+				next[v] += (1 - d + d * leaked) * teleport[v];
+			}
+			rank = next;
+		}
+		return rank;
+	}
+
+	auto close(std::vector<double> const& left, std::vector<double> const& right) -> bool {
+		if (left.size() != right.size()) {
+			return false;
+		}
+		for (auto i = std::size_t{0}; i < left.size(); ++i) {
+			if (std::abs(left[i] - right[i]) > 1e-8) {
+				return false;
+			}
+		}
+		return true;
+	}
+} // namespace
+
+TEST_CASE("PageRank", "[PageRank]") {
+	SECTION("check a cycle ranks every node equally, pagerank()") {
+		auto g = graph_t{0, 1, 2, 3};
+		for (auto v = 0; v < 4; ++v) {
+			g.insert_edge(v, (v + 1) % 4, 1);
+		}
+		auto const result = gdwg::pagerank(g);
+		CHECK(result.converged);
+		CHECK(close(result.rank, std::vector<double>(4, 0.25)));
+	}
+
+	SECTION("check weights split a node's rank, pagerank()") {
+		auto g = graph_t{0, 1, 2};
+		g.insert_edge(0, 1, 3);
+		g.insert_edge(0, 2, 1);
+		g.insert_edge(1, 0, 1);
+		g.insert_edge(2, 0, 1);
+		// self loops make the walk aperiodic, so it settles without teleporting
+		g.insert_edge(0, 0, 4);
+		g.insert_edge(1, 1, 1);
+		g.insert_edge(2, 2, 1);
+		auto const result = gdwg::pagerank(g, {.damping = 1.0});
+		CHECK(result.converged);
+		CHECK(close(result.rank, std::vector<double>{0.5, 0.375, 0.125}));
+	}
+
+	SECTION("check against a scalar reference, pagerank()") {
+		auto const g = random_graph(300, 1200, 11);
+		auto const n = g.nodes().size();
+		auto const expected = reference_pagerank(g, std::vector<double>(n, 1.0 / 300), 0.85);
+		for (auto threads : {std::size_t{1}, std::size_t{4}}) {
+			auto const result = gdwg::pagerank(g, {.threads = threads});
+			CHECK(result.converged);
+			CHECK(result.iterations > 1);
+			CHECK(result.residual < 1e-9);
+			CHECK(close(result.rank, expected));
+			CHECK(std::accumulate(result.rank.begin(), result.rank.end(), 0.0) == Approx(1.0));
+		}
+	}
+
+	SECTION("check iteration limit, pagerank_result") {
+		auto const g = random_graph(100, 400, 3);
+		auto const result = gdwg::pagerank(g, {.max_iterations = 2});
+		CHECK(!result.converged);
+		CHECK(result.iterations == 2);
+		CHECK(result.residual > 0);
+		auto const empty = gdwg::pagerank(graph_t{});
+		CHECK(empty.converged);
+		CHECK(empty.iterations == 0);
+		CHECK(empty.rank.empty());
+	}
+
+	SECTION("check errors, pagerank()") {
+		auto g = graph_t{0, 1};
+		g.insert_edge(0, 1, -1);
+		CHECK_THROWS_MATCHES(gdwg::pagerank(g),
+		                     std::runtime_error,
+		                     Catch::Matchers::Message("Cannot call gdwg::pagerank with a negative "
+		                                              "edge weight"));
+		CHECK_THROWS_MATCHES(gdwg::pagerank(graph_t{1}, {.damping = 1.5}),
+		                     std::runtime_error,
+		                     Catch::Matchers::Message("Cannot call gdwg::pagerank with a damping "
+		                                              "factor outside [0, 1]"));
+	}
+}
+
+TEST_CASE("Personalized PageRank", "[PageRank]") {
+	SECTION("check against a scalar reference, personalized_pagerank()") {
+		auto const g = random_graph(200, 700, 5);
+		auto teleport = std::vector<double>(200);
+		teleport[3] = 0.75;
+		teleport[40] = 0.25;
+		auto const expected = reference_pagerank(g, teleport, 0.7);
+		auto const seeds = std::map<int, double>{{3, 3.0}, {40, 1.0}};
+		auto const result = gdwg::personalized_pagerank(g, seeds, {.damping = 0.7});
+		CHECK(result.converged);
+		CHECK(close(result.rank, expected));
+	}
+
+	SECTION("check unreachable nodes get nothing, personalized_pagerank()") {
+		auto g = graph_t{0, 1, 2, 3};
+		g.insert_edge(0, 1, 1);
+		g.insert_edge(1, 0, 1);
+		g.insert_edge(2, 3, 1);
+		auto const result = gdwg::personalized_pagerank(g, std::map<int, double>{{0, 1.0}});
+		CHECK(result.rank[2] == 0);
+		CHECK(result.rank[3] == 0);
+		CHECK(result.rank[0] > result.rank[1]);
+		auto const no_damping =
+		   gdwg::personalized_pagerank(g, std::map<int, double>{{2, 1.0}}, {.damping = 0});
+		CHECK(no_damping.rank == std::vector<double>{0, 0, 1, 0});
+	}
+
+	SECTION("check errors, personalized_pagerank()") {
+		auto const g = graph_t{0, 1};
+		CHECK_THROWS_MATCHES(gdwg::personalized_pagerank(g, std::map<int, double>{{5, 1.0}}),
+		                     std::runtime_error,
+		                     Catch::Matchers::Message("Cannot call gdwg::personalized_pagerank if a "
+		                                              "personalised node doesn't exist in the "
+		                                              "graph"));
+		CHECK_THROWS_MATCHES(gdwg::personalized_pagerank(g, std::map<int, double>{{0, -1.0}}),
+		                     std::runtime_error,
+		                     Catch::Matchers::Message("Cannot call gdwg::personalized_pagerank with "
+		                                              "a negative personalisation weight"));
+		CHECK_THROWS_MATCHES(gdwg::personalized_pagerank(g, std::map<int, double>{}),
+		                     std::runtime_error,
+		                     Catch::Matchers::Message("Cannot call gdwg::personalized_pagerank "
+		                                              "without a positive personalisation weight"));
+	}
+}
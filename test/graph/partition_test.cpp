@@ -0,0 +1,111 @@
+#include "gdwg/partition.hpp"
+
+#include <algorithm>
+#include <catch2/catch.hpp>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+namespace {
+	using graph_t = gdwg::graph<int, int>;
+
+	// clusters of dense random edges, joined by a sparse ring
+	auto clustered_graph(int clusters, int size, unsigned seed) -> graph_t {
+		auto g = graph_t{};
+		for (auto v = 0; v < clusters * size; ++v) {
+			g.insert_node(v);
+		}
+		auto rng = std::mt19937(seed);
+		auto pick = std::uniform_int_distribution<int>(0, size - 1);
+		for (auto c = 0; c < clusters; ++c) {
+			for (auto i = 0; i < size * 4; ++i) {
+				g.insert_edge(c * size + pick(rng), c * size + pick(rng), i);
+			}
+			g.insert_edge(c * size, (c + 1) % clusters * size, 0);
+		}
+		return g;
+	}
+
+	auto grid(int side) -> graph_t {
+		auto g = graph_t{};
+		for (auto v = 0; v < side * side; ++v) {
+			g.insert_node(v);
+		}
+		for (auto v = 0; v < side * side; ++v) {
+			if (v % side + 1 < side) {
+				g.insert_edge(v, v + 1, 0);
+			}
+			if (v + side < side * side) {
+				g.insert_edge(v, v + side, 0);
+			}
+		}
+		return g;
+	}
+
+	auto largest_part(gdwg::partitioning const& layout) -> std::size_t {
+		auto sizes = std::vector<std::size_t>(layout.parts);
+		for (auto p : layout.part) {
+			++sizes[p];
+		}
+		return *std::max_element(sizes.begin(), sizes.end());
+	}
+
+	// edges whose ends are in different parts, straight off the graph
+	auto count_cut(graph_t const& g, gdwg::partitioning const& layout) -> std::size_t {
+		auto cut = std::size_t{0};
+		for (auto const& [from, to, weight] : g) {
+			auto const src = layout.part[static_cast<std::size_t>(from)];
+			auto const dst = layout.part[static_cast<std::size_t>(to)];
+			cut += src != dst ? 1 : 0;
+		}
+		return cut;
+	}
+} // namespace
+
+TEST_CASE("Partitioning a graph", "[Partition]") {
+	using gdwg::partition_method;
+
+	SECTION("check every method balances and reports its cut, partition()") {
+		auto const g = clustered_graph(8, 50, 1);
+		for (auto method : {partition_method::hash,
+		                    partition_method::label_propagation,
+		                    partition_method::multilevel})
+		{
+			auto const layout = gdwg::partition(g, 4, {.method = method});
+			CHECK(layout.parts == 4);
+			CHECK(layout.part.size() == 400);
+			CHECK(std::all_of(layout.part.begin(), layout.part.end(), [](auto p) { return p < 4; }));
+			CHECK(largest_part(layout) <= 105 + (method == partition_method::hash ? 20 : 0));
+			CHECK(layout.edge_cut == count_cut(g, layout));
+		}
+	}
+
+	SECTION("check looking at edges cuts far fewer, partition()") {
+		auto const g = clustered_graph(8, 50, 2);
+		auto const hashed = gdwg::partition(g, 4, {.method = partition_method::hash});
+		auto const propagated =
+		   gdwg::partition(g, 4, {.method = partition_method::label_propagation});
+		auto const multilevel = gdwg::partition(g, 4, {.method = partition_method::multilevel});
+		CHECK(propagated.edge_cut < hashed.edge_cut);
+		CHECK(multilevel.edge_cut * 10 < hashed.edge_cut);
+		// two clusters per part leaves little more than the ring
+		CHECK(multilevel.edge_cut <= 20);
+	}
+
+	SECTION("check a grid is cut into blocks, partition_method::multilevel") {
+		auto const g = grid(30);
+		auto const layout = gdwg::partition(g, 4, {.method = partition_method::multilevel});
+		// four quadrants cut 60 edges, hashing cuts three quarters of 1740
+		CHECK(layout.edge_cut < 150);
+		CHECK(largest_part(layout) <= 237);
+	}
+
+	SECTION("check edge cases, partition()") {
+		auto const one = gdwg::partition(grid(5), 1);
+		CHECK(one.edge_cut == 0);
+		CHECK(gdwg::partition(graph_t{}, 3).part.empty());
+		CHECK_THROWS_MATCHES(gdwg::partition(grid(2), 0),
+		                     std::runtime_error,
+		                     Catch::Matchers::Message("Cannot call gdwg::partition with 0 parts"));
+	}
+}
@@ -0,0 +1,193 @@
+#include "gdwg/pregel.hpp"
+
+#include <algorithm>
+#include <catch2/catch.hpp>
+#include <cstdint>
+#include <limits>
+#include <map>
+#include <queue>
+#include <random>
+#include <span>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace {
+	using graph_t = gdwg::graph<int, int>;
+	using id_t = std::uint32_t;
+
+	auto random_graph(int nodes, int edges, unsigned seed) -> graph_t {
+		auto g = graph_t{};
+		for (auto i = 0; i < nodes; ++i) {
+			g.insert_node(i);
+		}
+		auto rng = std::mt19937(seed);
+		auto pick = std::uniform_int_distribution<int>(0, nodes - 1);
+		for (auto i = 0; i < edges; ++i) {
+			g.insert_edge(pick(rng), pick(rng), 1 + i % 7);
+		}
+		return g;
+	}
+
+	auto dijkstra(graph_t const& g, int source) -> std::map<int, long> {
+		auto distance = std::map<int, long>{{source, 0}};
+		using entry = std::pair<long, int>;
+		auto queue = std::priority_queue<entry, std::vector<entry>, std::greater<>>();
+		queue.emplace(0, source);
+		while (!queue.empty()) {
+			auto const [d, v] = queue.top();
+			queue.pop();
+			if (d > distance[v]) {
+				continue;
+			}
+			for (auto const& w : g.connections(v)) {
+				auto const weights = g.weights(v, w);
+				auto const next = d + *std::min_element(weights.begin(), weights.end());
+				if (auto found = distance.find(w); found == distance.end() || next < found->second) {
+					distance[w] = next;
+					queue.emplace(next, w);
+				}
+			}
+		}
+		return distance;
+	}
+
+	constexpr auto unreached = std::numeric_limits<long>::max();
+
+	// Bellman-Ford as a vertex program, a node only speaks up when its distance improves
+	auto sssp(gdwg::pregel<int, int, long, long>& engine, id_t source, std::size_t threads) {
+		return engine.run(
+		   [&](auto& v, std::span<long const> messages) {
+			   auto best = v.superstep() == 0 && v.id() == source ? 0L : unreached;
+			   for (auto m : messages) {
+				   best = std::min(best, m);
+			   }
+			   if (best < v.value()) {
+				   v.value() = best;
+				   auto const targets = v.out_neighbors();
+				   auto const weights = v.out_weights();
+				   for (auto i = std::size_t{0}; i < targets.size(); ++i) {
+					   v.send(targets[i], best + weights[i]);
+				   }
+			   }
+			   v.vote_to_halt();
+		   },
+		   {.threads = threads});
+	}
+} // namespace
+
+TEST_CASE("Pregel engine", "[Pregel]") {
+	SECTION("check shortest paths against Dijkstra, run()") {
+		auto const g = random_graph(150, 700, 4);
+		auto const expected = dijkstra(g, 0);
+		for (auto threads : {std::size_t{1}, std::size_t{4}}) {
+			for (auto combine : {false, true}) {
+				auto engine = gdwg::pregel<int, int, long, long>(g, unreached);
+				if (combine) {
+					engine.set_combiner([](long left, long right) { return std::min(left, right); });
+				}
+				auto const result = sssp(engine, 0, threads);
+				CHECK(result.halted);
+				CHECK(result.messages > 0);
+				for (auto v = 0; v < 150; ++v) {
+					auto const found = expected.find(v);
+					CHECK(engine.value(v) == (found == expected.end() ? unreached : found->second));
+				}
+			}
+		}
+	}
+
+	SECTION("check every message arrives once without a combiner, run()") {
+		auto g = graph_t{0, 1, 2, 3};
+		g.insert_edge(0, 3, 1);
+		g.insert_edge(1, 3, 1);
+		g.insert_edge(2, 3, 1);
+		g.insert_edge(2, 3, 2);
+		auto engine = gdwg::pregel<int, int, std::vector<int>, int>(g);
+		auto const result = engine.run(
+		   [](auto& v, std::span<int const> messages) {
+			   if (v.superstep() == 0) {
+				   v.send_to_neighbors(v.node());
+			   }
+			   v.value().insert(v.value().end(), messages.begin(), messages.end());
+			   v.vote_to_halt();
+		   },
+		   {.threads = 3});
+		CHECK(result.halted);
+		CHECK(result.supersteps == 2);
+		CHECK(result.messages == 4);
+		auto heard = engine.value(3);
+		std::sort(heard.begin(), heard.end());
+		CHECK(heard == std::vector<int>{0, 1, 2, 2});
+		CHECK(engine.value(0).empty());
+	}
+
+	SECTION("check aggregators reduce over a superstep, add_aggregator() aggregated()") {
+		auto const g = random_graph(100, 200, 2);
+		auto engine = gdwg::pregel<int, int, int, int>(g);
+		auto const total = engine.add_aggregator(0L, [](long a, long b) { return a + b; });
+		auto const most = engine.add_aggregator(0, [](int a, int b) { return std::max(a, b); });
+		auto seen = std::vector<long>();
+		engine.run(
+		   [&](auto& v, std::span<int const>) {
+			   if (v.id() == 0) {
+				   seen.push_back(v.aggregated(total));
+			   }
+			   v.aggregate(total, long{v.node()});
+			   v.aggregate(most, v.node());
+			   if (v.superstep() == 2) {
+				   v.vote_to_halt();
+			   }
+		   },
+		   {.threads = 4});
+		CHECK(seen == std::vector<long>{0, 4950, 4950});
+		CHECK(engine.aggregated(total) == 4950);
+		CHECK(engine.aggregated(most) == 99);
+	}
+
+	SECTION("check halted nodes wake on a message, vote_to_halt()") {
+		// a token passed down a path, one node awake at a time
+		auto g = graph_t{0, 1, 2, 3, 4};
+		for (auto v = 0; v < 4; ++v) {
+			g.insert_edge(v, v + 1, 0);
+		}
+		auto engine = gdwg::pregel<int, int, int, int>(g, -1);
+		auto const result = engine.run([](auto& v, std::span<int const> messages) {
+			if (v.superstep() == 0 && v.id() == 0) {
+				v.send_to_neighbors(1);
+			}
+			for (auto hops : messages) {
+				v.value() = static_cast<int>(v.superstep());
+				v.send_to_neighbors(hops + 1);
+			}
+			v.vote_to_halt();
+		});
+		CHECK(result.halted);
+		CHECK(result.supersteps == 5);
+		CHECK(engine.values() == std::vector<int>{-1, 1, 2, 3, 4});
+	}
+
+	SECTION("check the superstep limit, pregel_result") {
+		auto g = graph_t{0, 1};
+		g.insert_edge(0, 1, 0);
+		g.insert_edge(1, 0, 0);
+		auto engine = gdwg::pregel<int, int, int, int>(g);
+		auto const result = engine.run(
+		   [](auto& v, std::span<int const>) {
+			   ++v.value();
+			   v.send_to_neighbors(0);
+		   },
+		   {.max_supersteps = 7});
+		CHECK(!result.halted);
+		CHECK(result.supersteps == 7);
+		CHECK(engine.values() == std::vector<int>{7, 7});
+
+		auto empty = gdwg::pregel<int, int, int, int>(graph_t{});
+		CHECK(empty.run([](auto&, std::span<int const>) {}).halted);
+		CHECK_THROWS_MATCHES(engine.value(9),
+		                     std::runtime_error,
+		                     Catch::Matchers::Message("Cannot call gdwg::pregel<N, E, Value, "
+		                                              "Message>::value if the node doesn't exist "
+		                                              "in the graph"));
+	}
+}
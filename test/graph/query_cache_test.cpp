@@ -0,0 +1,154 @@
+#include "gdwg/query_cache.hpp"
+
+#include <catch2/catch.hpp>
+#include <memory>
+#include <set>
+#include <utility>
+#include <vector>
+
+namespace {
+	using graph_t = gdwg::graph<int, int>;
+
+	struct hop_hash {
+		auto operator()(std::pair<int, int> const& key) const noexcept -> std::size_t {
+			return std::hash<int>{}(key.first) * 31 + std::hash<int>{}(key.second);
+		}
+	};
+
+	// (source, hops) to the nodes within that many hops
+	using cache_t = gdwg::query_cache<int, int, std::pair<int, int>, std::set<int>, hop_hash>;
+
+	// nodes within hops steps of src, recording every node whose edges were read
+	template<typename Record>
+	auto k_hop(graph_t const& g, int src, int hops, Record&& record) -> std::set<int> {
+		auto res = std::set<int>{src};
+		auto frontier = std::vector<int>{src};
+		for (auto i = 0; i < hops; ++i) {
+			auto next = std::vector<int>();
+			for (auto node : frontier) {
+				record(node);
+				for (auto dst : g.connections(node)) {
+					if (res.insert(dst).second) {
+						next.push_back(dst);
+					}
+				}
+			}
+			frontier = std::move(next);
+		}
+		return res;
+	}
+} // namespace
+
+TEST_CASE("Caching query results by version", "[QueryCache]") {
+	auto g = graph_t{1, 2, 3, 4};
+	g.insert_edge(1, 2, 1);
+	g.insert_edge(2, 3, 1);
+	auto cache = cache_t(g, 2);
+	auto computed = 0;
+	auto query = [&](int src, int hops) {
+		return [&, src, hops] {
+			++computed;
+			return k_hop(g, src, hops, [](int) {});
+		};
+	};
+
+	SECTION("check repeat queries are served from the cache, get()") {
+		CHECK(cache.get({1, 2}, query(1, 2)) == std::set<int>{1, 2, 3});
+		CHECK(cache.get({1, 2}, query(1, 2)) == std::set<int>{1, 2, 3});
+		CHECK(computed == 1);
+		CHECK(cache.hits() == 1);
+		CHECK(cache.misses() == 1);
+	}
+
+	SECTION("check any change makes plain entries stale, get()") {
+		cache.get({1, 2}, query(1, 2));
+		g.insert_edge(4, 4, 1);
+		CHECK(cache.find({1, 2}) == nullptr);
+		CHECK(cache.size() == 0);
+		g.insert_edge(2, 4, 1);
+		CHECK(cache.get({1, 2}, query(1, 2)) == std::set<int>{1, 2, 3, 4});
+		CHECK(computed == 2);
+	}
+
+	SECTION("check the least recently used entry is evicted, get()") {
+		cache.get({1, 1}, query(1, 1));
+		cache.get({2, 1}, query(2, 1));
+		cache.get({1, 1}, query(1, 1));
+		cache.get({3, 1}, query(3, 1));
+		CHECK(cache.size() == 2);
+		CHECK(cache.find({2, 1}) == nullptr);
+		CHECK(cache.find({1, 1}) != nullptr);
+		CHECK(computed == 3);
+	}
+
+	SECTION("check erase() and clear()") {
+		cache.get({1, 1}, query(1, 1));
+		cache.get({2, 1}, query(2, 1));
+		CHECK(cache.erase({1, 1}));
+		CHECK(!cache.erase({1, 1}));
+		CHECK(cache.size() == 1);
+		cache.clear();
+		CHECK(cache.size() == 0);
+	}
+
+	SECTION("check a capacity of 0 is rejected") {
+		CHECK_THROWS_WITH(cache_t(g, 0), "Cannot create gdwg::query_cache with a capacity of 0");
+	}
+}
+
+TEST_CASE("Caching query results by the nodes they read", "[QueryCache]") {
+	auto g = graph_t{1, 2, 3, 4, 5, 6};
+	g.insert_edge(1, 2, 1);
+	g.insert_edge(2, 3, 1);
+	g.insert_edge(5, 6, 1);
+	auto cache = cache_t(g, 8);
+	auto computed = 0;
+	auto query = [&](int src, int hops) {
+		return [&, src, hops](cache_t::dependencies& depends_on) {
+			++computed;
+			return k_hop(g, src, hops, [&](int node) { depends_on.add(node); });
+		};
+	};
+
+	SECTION("check unrelated changes keep the entry, get_tracked()") {
+		cache.get_tracked({1, 2}, query(1, 2));
+		g.insert_edge(5, 4, 1);
+		g.insert_edge(3, 4, 1);
+		g.erase_node(6);
+		CHECK(cache.get_tracked({1, 2}, query(1, 2)) == std::set<int>{1, 2, 3});
+		CHECK(computed == 1);
+	}
+
+	SECTION("check a change to a node it read drops the entry, get_tracked()") {
+		cache.get_tracked({1, 2}, query(1, 2));
+		cache.get_tracked({5, 1}, query(5, 1));
+		g.insert_edge(2, 4, 1);
+		CHECK(cache.get_tracked({1, 2}, query(1, 2)) == std::set<int>{1, 2, 3, 4});
+		CHECK(cache.get_tracked({5, 1}, query(5, 1)) == std::set<int>{5, 6});
+		CHECK(computed == 3);
+
+		g.replace_node(5, 7);
+		CHECK(cache.find({5, 1}) == nullptr);
+		g.clear();
+		CHECK(cache.size() == 0);
+	}
+
+	SECTION("check renaming a destination drops the entries that read its sources, get_tracked()") {
+		CHECK(cache.get_tracked({1, 1}, query(1, 1)) == std::set<int>{1, 2});
+		cache.get_tracked({5, 1}, query(5, 1));
+		g.replace_node(2, 9);
+		CHECK(cache.find({1, 1}) == nullptr);
+		CHECK(cache.get_tracked({1, 1}, query(1, 1)) == std::set<int>{1, 9});
+		CHECK(cache.get_tracked({5, 1}, query(5, 1)) == std::set<int>{5, 6});
+		CHECK(computed == 3);
+	}
+
+	SECTION("check the cache outlives its graph, get_tracked()") {
+		auto other = std::make_unique<graph_t>(graph_t{1});
+		auto orphan = cache_t(*other, 1);
+		orphan.get({1, 0}, [] { return std::set<int>{1}; });
+		other.reset();
+		CHECK(orphan.size() == 0);
+		CHECK(orphan.find({1, 0}) == nullptr);
+	}
+}
@@ -0,0 +1,168 @@
+#include "gdwg/random_walk.hpp"
+
+#include <algorithm>
+#include <array>
+#include <catch2/catch.hpp>
+#include <cstdint>
+#include <mutex>
+#include <span>
+#include <vector>
+
+namespace {
+	using graph_t = gdwg::graph<int, double>;
+	using walker_t = gdwg::random_walker<int, double>;
+	using node_id = walker_t::node_id;
+
+	auto all_walks(walker_t const& walker, gdwg::walk_options const& options)
+	   -> std::vector<std::vector<node_id>> {
+		auto walks = std::vector<std::vector<node_id>>();
+		auto lock = std::mutex();
+		walker.generate(
+		   [&](std::span<node_id const> walk, std::size_t) {
+			   auto const guard = std::scoped_lock(lock);
+			   walks.emplace_back(walk.begin(), walk.end());
+		   },
+		   options);
+		std::sort(walks.begin(), walks.end());
+		return walks;
+	}
+} // namespace
+
+TEST_CASE("Steps follow edges in proportion to their weights", "[RandomWalk]") {
+	auto g = graph_t{0, 1, 2, 3};
+	g.insert_edge(0, 1, 1.0);
+	g.insert_edge(0, 2, 3.0);
+	// two weights to the same node add up
+	g.insert_edge(0, 3, 2.0);
+	g.insert_edge(0, 3, 4.0);
+	auto const walker = walker_t(g);
+
+	auto landed = std::array<double, 4>{};
+	auto options = gdwg::walk_options();
+	options.length = 2;
+	options.walks_per_node = 50'000;
+	options.threads = 1;
+	auto const made = walker.generate(
+	   [&](std::span<node_id const> walk, std::size_t) {
+		   if (walk.size() == 2) {
+			   ++landed[walk[1]];
+		   }
+	   },
+	   options);
+	CHECK(made == 200'000);
+	CHECK(landed[0] == 0);
+	CHECK(landed[1] / 50'000 == Approx(0.1).margin(0.01));
+	CHECK(landed[2] / 50'000 == Approx(0.3).margin(0.01));
+	CHECK(landed[3] / 50'000 == Approx(0.6).margin(0.01));
+}
+
+TEST_CASE("Walks follow edges and stop at dead ends", "[RandomWalk]") {
+	auto g = graph_t{0, 1, 2, 3, 4};
+	g.insert_edge(0, 1, 1.0);
+	g.insert_edge(1, 2, 1.0);
+	g.insert_edge(2, 0, 1.0);
+	g.insert_edge(2, 3, 1.0);
+	// only zero weight out of 3, which is as good as none
+	g.insert_edge(3, 4, 0.0);
+	auto const walker = walker_t(g);
+
+	auto options = gdwg::walk_options();
+	options.length = 12;
+	options.walks_per_node = 20;
+	for (auto const& walk : all_walks(walker, options)) {
+		REQUIRE(!walk.empty());
+		CHECK(walk.size() <= 12);
+		for (auto i = std::size_t{1}; i < walk.size(); ++i) {
+			CHECK(g.is_connected(walker.frozen().node(walk[i - 1]), walker.frozen().node(walk[i])));
+		}
+		if (walk.size() < 12) {
+			CHECK((walk.back() == 3 || walk.back() == 4));
+		}
+	}
+
+	auto path = std::vector<node_id>{9, 9, 9};
+	walker.walk(4, path, options);
+	CHECK(path == std::vector<node_id>{4});
+}
+
+TEST_CASE("Walks are the same whatever the thread count", "[RandomWalk]") {
+	auto g = graph_t{};
+	for (auto i = 0; i < 40; ++i) {
+		g.insert_node(i);
+	}
+	for (auto i = 0; i < 40; ++i) {
+		g.insert_edge(i, (i + 1) % 40, 1.0);
+		g.insert_edge(i, (i * 7 + 3) % 40, 2.5);
+		g.insert_edge(i, (i * 13 + 5) % 40, 0.5);
+	}
+	auto const walker = walker_t(g);
+
+	auto options = gdwg::walk_options();
+	options.length = 20;
+	options.walks_per_node = 5;
+	options.p = 0.5;
+	options.q = 2;
+	options.threads = 1;
+	auto const serial = all_walks(walker, options);
+	options.threads = 4;
+	CHECK(all_walks(walker, options) == serial);
+	CHECK(serial.size() == 200);
+}
+
+TEST_CASE("node2vec biases the step after the first", "[RandomWalk]") {
+	// coming into v from t, v can go back to t, on to a which t also reaches, or out to b
+	enum : int { t, v, a, b };
+	auto g = graph_t{t, v, a, b};
+	g.insert_edge(t, v, 1.0);
+	g.insert_edge(t, a, 1.0);
+	g.insert_edge(v, t, 1.0);
+	g.insert_edge(v, a, 1.0);
+	g.insert_edge(v, b, 1.0);
+	auto const walker = walker_t(g);
+
+	auto options = gdwg::walk_options();
+	options.length = 3;
+	options.walks_per_node = 100'000;
+	options.p = 0.5;
+	options.q = 4;
+	auto next = std::array<double, 4>{};
+	auto lock = std::mutex();
+	walker.generate(
+	   [&](std::span<node_id const> walk, std::size_t) {
+		   if (walk.size() == 3 && walk[0] == t && walk[1] == v) {
+			   auto const guard = std::scoped_lock(lock);
+			   ++next[walk[2]];
+		   }
+	   },
+	   options);
+	auto const total = next[t] + next[a] + next[b];
+	REQUIRE(total > 10'000);
+	// 1/p, 1 and 1/q, out of 3.25
+	CHECK(next[t] / total == Approx(2 / 3.25).margin(0.02));
+	CHECK(next[a] / total == Approx(1 / 3.25).margin(0.02));
+	CHECK(next[b] / total == Approx(0.25 / 3.25).margin(0.02));
+}
+
+TEST_CASE("Random walkers reject what they can't sample", "[RandomWalk]") {
+	auto g = graph_t{1, 2};
+	g.insert_edge(1, 2, 1.0);
+	auto const walker = walker_t(g);
+	auto path = std::vector<node_id>();
+
+	auto options = gdwg::walk_options();
+	options.q = 0;
+	CHECK_THROWS_MATCHES(walker.walk(0, path, options),
+	                     std::runtime_error,
+	                     Catch::Matchers::Message("Cannot call gdwg::random_walker<N, E>::walk "
+	                                              "without positive p and q"));
+	CHECK_THROWS_MATCHES(walker.walk(2, path, {}),
+	                     std::runtime_error,
+	                     Catch::Matchers::Message("Cannot call gdwg::random_walker<N, E>::walk if "
+	                                              "start doesn't exist in the graph"));
+
+	g.insert_edge(2, 1, -1.0);
+	CHECK_THROWS_MATCHES(walker_t(g),
+	                     std::runtime_error,
+	                     Catch::Matchers::Message("Cannot create gdwg::random_walker<N, E> with a "
+	                                              "negative edge weight"));
+}
@@ -0,0 +1,106 @@
+#include "gdwg/reachability.hpp"
+
+#include <catch2/catch.hpp>
+#include <random>
+#include <set>
+#include <vector>
+
+namespace {
+	using graph_t = gdwg::graph<int, int>;
+
+	auto random_graph(int nodes, int edges, unsigned seed) -> graph_t {
+		auto g = graph_t{};
+		for (auto i = 0; i < nodes; ++i) {
+			g.insert_node(i);
+		}
+		auto rng = std::mt19937(seed);
+		auto pick = std::uniform_int_distribution<int>(0, nodes - 1);
+		for (auto i = 0; i < edges; ++i) {
+			// mostly forward edges, so the DAG has some depth
+			auto a = pick(rng);
+			auto b = pick(rng);
+			if (i % 8 != 0 && b < a) {
+				std::swap(a, b);
+			}
+			g.insert_edge(a, b, 0);
+		}
+		return g;
+	}
+
+	auto reachable_from(graph_t const& g, int src) -> std::set<int> {
+		auto seen = std::set<int>{src};
+		auto stack = std::vector<int>{src};
+		while (!stack.empty()) {
+			auto const x = stack.back();
+			stack.pop_back();
+			for (auto y : g.connections(x)) {
+				if (seen.insert(y).second) {
+					stack.push_back(y);
+				}
+			}
+		}
+		return seen;
+	}
+
+	auto check_against_search(graph_t const& g, gdwg::reachability_index<int, int> const& index)
+	   -> void {
+		for (auto const& src : g.nodes()) {
+			auto const expected = reachable_from(g, src);
+			for (auto const& dst : g.nodes()) {
+				REQUIRE(index.is_reachable(src, dst) == expected.contains(dst));
+			}
+		}
+	}
+} // namespace
+
+TEST_CASE("Answering reachability from an index", "[Reachability]") {
+	auto g = graph_t{1, 2, 3, 4, 5, 6};
+	g.insert_edge(1, 2, 0);
+	g.insert_edge(2, 1, 0);
+	g.insert_edge(2, 3, 0);
+	g.insert_edge(3, 4, 0);
+	g.insert_edge(5, 4, 0);
+
+	SECTION("check paths rather than single hops, is_reachable()") {
+		auto const index = gdwg::reachability_index<int, int>(g);
+		CHECK(index.uses_closure());
+		CHECK(index.num_components() == 5);
+		CHECK(index.is_reachable(1, 4));
+		CHECK(index.is_reachable(2, 1));
+		CHECK(index.is_reachable(6, 6));
+		CHECK(!index.is_reachable(4, 1));
+		CHECK(!index.is_reachable(5, 3));
+		CHECK(!index.is_reachable(1, 6));
+		CHECK_THROWS_WITH(index.is_reachable(1, 9),
+		                  "Cannot call gdwg::reachability_index<N, E>::is_reachable if src or dst "
+		                  "node don't exist in the graph");
+	}
+
+	SECTION("check the same answers from interval labels, is_reachable()") {
+		auto const index = gdwg::reachability_index<int, int>(g, 0);
+		CHECK(!index.uses_closure());
+		CHECK(index.is_reachable(1, 4));
+		CHECK(!index.is_reachable(4, 1));
+		CHECK(!index.is_reachable(5, 3));
+	}
+
+	SECTION("check rebuilding after a change, rebuild() is_stale()") {
+		auto index = gdwg::reachability_index<int, int>(g);
+		CHECK(!index.is_stale(g));
+		g.insert_edge(4, 5, 0);
+		CHECK(index.is_stale(g));
+		CHECK(!index.is_reachable(1, 5));
+		index.rebuild(g);
+		CHECK(!index.is_stale(g));
+		CHECK(index.is_reachable(1, 5));
+		CHECK(index.num_components() == 4);
+	}
+
+	SECTION("check both representations against a search on random graphs, is_reachable()") {
+		for (auto seed : {1u, 2u, 3u}) {
+			auto const random = random_graph(120, 150, seed);
+			check_against_search(random, gdwg::reachability_index<int, int>(random));
+			check_against_search(random, gdwg::reachability_index<int, int>(random, 0));
+		}
+	}
+}
@@ -0,0 +1,141 @@
+#include "gdwg/sharded_graph.hpp"
+
+#include <catch2/catch.hpp>
+#include <cstdint>
+#include <optional>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+	using graph_t = gdwg::graph<int, int>;
+
+	auto random_graph(int nodes, int edges, unsigned seed) -> graph_t {
+		auto g = graph_t{};
+		for (auto i = 0; i < nodes; ++i) {
+			g.insert_node(i);
+		}
+		auto rng = std::mt19937(seed);
+		auto pick = std::uniform_int_distribution<int>(0, nodes - 1);
+		for (auto i = 0; i < edges; ++i) {
+			g.insert_edge(pick(rng), pick(rng), i % 5);
+		}
+		return g;
+	}
+
+	auto reference_hops(graph_t const& g, int source) -> std::vector<std::optional<std::size_t>> {
+		auto const n = g.nodes().size();
+		auto res = std::vector<std::optional<std::size_t>>(n);
+		res[static_cast<std::size_t>(source)] = 0;
+		auto queue = std::vector<int>{source};
+		for (auto i = std::size_t{0}; i < queue.size(); ++i) {
+			auto const v = queue[i];
+			for (auto const& w : g.connections(v)) {
+				if (!res[static_cast<std::size_t>(w)]) {
+					res[static_cast<std::size_t>(w)] = *res[static_cast<std::size_t>(v)] + 1;
+					queue.push_back(w);
+				}
+			}
+		}
+		return res;
+	}
+} // namespace
+
+TEST_CASE("Sharding a graph across processes", "[ShardedGraph]") {
+	auto const g = random_graph(300, 900, 6);
+
+	SECTION("check queries go to the owning worker, connections() weights()") {
+		auto const sharded = gdwg::sharded_graph<int, int>(g, 3);
+		CHECK(sharded.num_shards() == 3);
+		CHECK(sharded.num_nodes() == 300);
+		for (auto v = 0; v < 300; v += 11) {
+			CHECK(sharded.owner(v) == sharded.layout().part[static_cast<std::size_t>(v)]);
+			CHECK(sharded.connections(v) == g.connections(v));
+			for (auto const& w : g.connections(v)) {
+				CHECK(sharded.weights(v, w) == g.weights(v, w));
+			}
+		}
+		CHECK(sharded.weights(0, 0) == g.weights(0, 0));
+		CHECK_THROWS_MATCHES(sharded.connections(1000),
+		                     std::runtime_error,
+		                     Catch::Matchers::Message("Cannot call gdwg::sharded_graph<N, "
+		                                              "E>::connections if src doesn't exist in the "
+		                                              "graph"));
+	}
+
+	SECTION("check shards hold every edge once, stats()") {
+		auto const sharded = gdwg::sharded_graph<int, int>(g, 4);
+		auto owned = std::size_t{0};
+		auto edges = std::size_t{0};
+		auto ghosts = std::size_t{0};
+		auto mirrors = std::size_t{0};
+		for (auto const& shard : sharded.stats()) {
+			owned += shard.owned;
+			edges += shard.edges;
+			ghosts += shard.ghosts;
+			mirrors += shard.mirrors;
+		}
+		CHECK(owned == 300);
+		CHECK(edges == g.num_edges());
+		// a ghost in one shard is a mirror in another
+		CHECK(ghosts == mirrors);
+		CHECK(ghosts > 0);
+	}
+
+	SECTION("check a distributed breadth first search, hops()") {
+		for (auto parts : {1U, 2U, 5U}) {
+			auto const sharded = gdwg::sharded_graph<int, int>(g, parts);
+			for (auto source : {0, 17, 250}) {
+				CHECK(sharded.hops(source) == reference_hops(g, source));
+			}
+		}
+	}
+
+	SECTION("check a layout from elsewhere, sharded_graph(g, partitioning)") {
+		auto const layout = gdwg::partition(g, 2, {.method = gdwg::partition_method::hash});
+		auto const sharded = gdwg::sharded_graph<int, int>(g, layout);
+		CHECK(sharded.layout().edge_cut == layout.edge_cut);
+		CHECK(sharded.hops(3) == reference_hops(g, 3));
+		auto wrong = layout;
+		wrong.part.pop_back();
+		using sharded_t = gdwg::sharded_graph<int, int>;
+		CHECK_THROWS_MATCHES(sharded_t(g, wrong),
+		                     std::runtime_error,
+		                     Catch::Matchers::Message("Cannot create gdwg::sharded_graph<N, E> from "
+		                                              "a partitioning of a different graph"));
+	}
+
+	SECTION("check lookups follow a reordered frozen graph, sharded_graph(frozen_graph)") {
+		auto const frozen = gdwg::frozen_graph<int, int>(g, gdwg::node_order::degree);
+		REQUIRE(frozen.nodes() != g.nodes());
+		auto const sharded = gdwg::sharded_graph<int, int>(frozen, 3);
+		for (auto v = 0; v < 300; v += 7) {
+			auto const id = *frozen.find(v);
+			CHECK(sharded.owner(v) == sharded.layout().part[id]);
+			CHECK(sharded.connections(v) == g.connections(v));
+			for (auto const& w : g.connections(v)) {
+				CHECK(sharded.weights(v, w) == g.weights(v, w));
+			}
+		}
+		CHECK_THROWS_AS(sharded.connections(1000), std::runtime_error);
+
+		// hops are by the frozen graph's ids
+		auto const expected = reference_hops(g, 17);
+		auto const reached = sharded.hops(17);
+		REQUIRE(reached.size() == expected.size());
+		for (auto id = std::uint32_t{0}; id < reached.size(); ++id) {
+			CHECK(reached[id] == expected[static_cast<std::size_t>(frozen.node(id))]);
+		}
+	}
+
+	SECTION("check node values never cross the sockets, sharded_graph<std::string, int>") {
+		auto words = gdwg::graph<std::string, int>{"ant", "bee", "cat", "dog"};
+		words.insert_edge("ant", "bee", 1);
+		words.insert_edge("bee", "dog", 2);
+		words.insert_edge("dog", "ant", 3);
+		auto const sharded = gdwg::sharded_graph<std::string, int>(words, 2);
+		CHECK(sharded.connections("bee") == std::vector<std::string>{"dog"});
+		auto const reached = sharded.hops("ant");
+		CHECK(reached == std::vector<std::optional<std::size_t>>{0, 1, std::nullopt, 2});
+	}
+}
@@ -0,0 +1,133 @@
+#include "gdwg/spanning_forest.hpp"
+
+#include <algorithm>
+#include <catch2/catch.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+	using graph_t = gdwg::graph<int, int>;
+
+	auto random_graph(int nodes, int edges, unsigned seed) -> graph_t {
+		auto g = graph_t{};
+		for (auto i = 0; i < nodes; ++i) {
+			g.insert_node(i);
+		}
+		auto rng = std::mt19937(seed);
+		auto pick = std::uniform_int_distribution<int>(0, nodes - 1);
+		// few distinct weights, so plenty of ties
+		auto weight = std::uniform_int_distribution<int>(1, 5);
+		auto batch = graph_t::batch();
+		for (auto i = 0; i < edges; ++i) {
+			auto const src = pick(rng);
+			auto const dst = pick(rng);
+			batch.push_back({graph_t::edge_operation::kind::insert, src, dst, weight(rng)});
+		}
+		g.apply(batch);
+		return g;
+	}
+
+	// Prim's algorithm over an adjacency matrix, restarted in every component
+	auto reference_weight(graph_t const& g) -> std::int64_t {
+		auto const n = g.nodes().size();
+		auto constexpr none = std::numeric_limits<int>::max();
+		auto lightest = std::vector<std::vector<int>>(n, std::vector<int>(n, none));
+		for (auto const& [src, dst, weight] : g) {
+			auto const u = static_cast<std::size_t>(src);
+			auto const v = static_cast<std::size_t>(dst);
+			if (u != v) {
+				lightest[u][v] = std::min(lightest[u][v], weight);
+				lightest[v][u] = lightest[u][v];
+			}
+		}
+		auto in_tree = std::vector<bool>(n);
+		auto cost = std::vector<int>(n, none);
+		auto total = std::int64_t{0};
+		for (auto added = std::size_t{0}; added < n; ++added) {
+			auto next = n;
+			for (auto v = std::size_t{0}; v < n; ++v) {
+				if (!in_tree[v] && (next == n || cost[v] < cost[next])) {
+					next = v;
+				}
+			}
+			in_tree[next] = true;
+			if (cost[next] != none) {
+				total += cost[next];
+			}
+			for (auto v = std::size_t{0}; v < n; ++v) {
+				cost[v] = std::min(cost[v], lightest[next][v]);
+			}
+		}
+		return total;
+	}
+
+	auto total_weight(std::vector<gdwg::spanning_edge<int>> const& forest) -> std::int64_t {
+		auto total = std::int64_t{0};
+		for (auto const& e : forest) {
+			total += e.weight;
+		}
+		return total;
+	}
+} // namespace
+
+TEST_CASE("Boruvka and Kruskal find the same minimum forest", "[SpanningForest]") {
+	for (auto seed = 1U; seed <= 20; ++seed) {
+		// sparse enough that some seeds leave several components
+		auto const nodes = 10 + static_cast<int>(seed) * 3;
+		auto const g = random_graph(nodes, nodes + static_cast<int>(seed % 5) * nodes / 2, seed);
+		auto options = gdwg::spanning_forest_options();
+		options.threads = 4;
+		auto const boruvka = gdwg::minimum_spanning_edges(g, options);
+		options.algorithm = gdwg::spanning_algorithm::kruskal;
+		auto const kruskal = gdwg::minimum_spanning_edges(g, options);
+
+		CHECK(boruvka == kruskal);
+		CHECK(total_weight(boruvka) == reference_weight(g));
+		auto const components = gdwg::weakly_connected_components(g);
+		CHECK(boruvka.size() == g.nodes().size() - components.count);
+		for (auto const& e : boruvka) {
+			CHECK(e.u < e.v);
+			CHECK(components.component[e.u] == components.component[e.v]);
+		}
+	}
+}
+
+TEST_CASE("The forest comes back as a graph", "[SpanningForest]") {
+	auto g = gdwg::graph<std::string, double>{"a", "b", "c", "d", "e"};
+	g.insert_edge("a", "b", 4.0);
+	// the lighter direction counts
+	g.insert_edge("b", "a", 1.5);
+	g.insert_edge("b", "c", 2.0);
+	g.insert_edge("c", "a", 3.0);
+	g.insert_edge("c", "c", 0.5);
+	g.insert_edge("d", "e", 7.0);
+	g.insert_edge("d", "e", 6.0);
+
+	auto expected = gdwg::graph<std::string, double>{"a", "b", "c", "d", "e"};
+	expected.insert_edge("a", "b", 1.5);
+	expected.insert_edge("b", "c", 2.0);
+	expected.insert_edge("d", "e", 6.0);
+	CHECK(gdwg::minimum_spanning_forest(g) == expected);
+
+	auto options = gdwg::spanning_forest_options();
+	options.algorithm = gdwg::spanning_algorithm::kruskal;
+	CHECK(gdwg::minimum_spanning_forest(g, options) == expected);
+	CHECK(gdwg::minimum_spanning_forest(gdwg::graph<std::string, double>{}).empty());
+}
+
+TEST_CASE("A large forest is the same on any number of threads", "[SpanningForest]") {
+	auto const g = random_graph(20'000, 60'000, 7);
+	auto const frozen = gdwg::frozen_graph<int, int>(g);
+	auto options = gdwg::spanning_forest_options();
+	options.threads = 1;
+	auto const serial = gdwg::minimum_spanning_edges(frozen, options);
+	options.threads = 8;
+	CHECK(gdwg::minimum_spanning_edges(frozen, options) == serial);
+	options.algorithm = gdwg::spanning_algorithm::kruskal;
+	CHECK(gdwg::minimum_spanning_edges(frozen, options) == serial);
+	CHECK(serial.size() == 20'000 - gdwg::weakly_connected_components(frozen).count);
+}
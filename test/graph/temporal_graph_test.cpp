@@ -0,0 +1,157 @@
+#include "gdwg/temporal_graph.hpp"
+
+#include <algorithm>
+#include <catch2/catch.hpp>
+#include <cstdint>
+#include <map>
+#include <random>
+#include <set>
+#include <string>
+#include <tuple>
+#include <vector>
+
+namespace {
+	using temporal_t = gdwg::temporal_graph<int, int>;
+
+	struct event {
+		int src;
+		int dst;
+		int weight;
+		std::int64_t at;
+	};
+
+	// floor division, the pane an event lands in
+	auto pane_of(std::int64_t at, std::int64_t width) -> std::int64_t {
+		return at / width - (at % width < 0 ? 1 : 0);
+	}
+} // namespace
+
+TEST_CASE("The window matches a brute force replay of the stream", "[TemporalGraph]") {
+	auto constexpr width = std::int64_t{10};
+	auto constexpr panes = std::size_t{4};
+	auto g = temporal_t(width, panes);
+	auto accepted = std::vector<event>();
+	auto newest = std::int64_t{-1000};
+
+	auto rng = std::mt19937(11);
+	auto node = std::uniform_int_distribution<int>(0, 15);
+	auto jitter = std::uniform_int_distribution<int>(-25, 4);
+	auto at = std::int64_t{-50};
+	for (auto i = 0; i < 2000; ++i) {
+		at += i % 7 == 0 ? 1 : 0;
+		auto const e = event{node(rng), node(rng), i % 3, at + jitter(rng)};
+		auto const fresh = pane_of(e.at, width) > pane_of(newest, width) - std::int64_t{panes};
+		CHECK(g.insert_edge(e.src, e.dst, e.weight, e.at) == fresh);
+		newest = std::max(newest, e.at);
+		if (fresh) {
+			accepted.push_back(e);
+		}
+
+		if (i % 50 != 0) {
+			continue;
+		}
+		auto const oldest = pane_of(newest, width) - std::int64_t{panes} + 1;
+		auto counts = std::map<std::tuple<int, int, int>, std::size_t>();
+		auto nodes = std::set<int>();
+		auto events = std::size_t{0};
+		for (auto const& a : accepted) {
+			if (pane_of(a.at, width) >= oldest) {
+				++counts[{a.src, a.dst, a.weight}];
+				nodes.insert(a.src);
+				nodes.insert(a.dst);
+				++events;
+			}
+		}
+		CHECK(g.window_start() == oldest * width);
+		CHECK(g.num_events() == events);
+		CHECK(g.num_edges() == counts.size());
+		CHECK(g.nodes() == std::vector<int>(nodes.begin(), nodes.end()));
+		for (auto const& [edge, times] : counts) {
+			auto const& [src, dst, weight] = edge;
+			CHECK(g.count(src, dst, weight) == times);
+			CHECK(g.is_connected(src, dst));
+		}
+		auto const edges = g.edges();
+		REQUIRE(edges.size() == counts.size());
+		auto expected = counts.begin();
+		for (auto const& [src, dst, weight] : edges) {
+			CHECK(std::tuple(src, dst, weight) == (expected++)->first);
+		}
+	}
+}
+
+TEST_CASE("Expired panes are evicted a whole pane at a time", "[TemporalGraph]") {
+	auto g = gdwg::temporal_graph<std::string, int>(60, 5);
+	g.insert_edge("a", "b", 1, 0);
+	g.insert_edge("a", "b", 1, 59);
+	g.insert_edge("a", "c", 2, 60);
+	g.insert_edge("c", "a", 3, 299);
+	CHECK(g.num_events() == 4);
+	CHECK(g.count("a", "b", 1) == 2);
+	CHECK(g.connections("a") == std::vector<std::string>{"b", "c"});
+
+	// the pane [0, 60) leaves once 300 arrives
+	g.advance(300);
+	CHECK(g.window_start() == 60);
+	CHECK(g.window_end() == 360);
+	CHECK(g.num_events() == 2);
+	CHECK_FALSE(g.is_connected("a", "b"));
+	CHECK_FALSE(g.is_node("b"));
+	CHECK(g.connections("a") == std::vector<std::string>{"c"});
+	CHECK(g.weights("c", "a") == std::vector<int>{3});
+
+	SECTION("events older than the window are dropped") {
+		CHECK_FALSE(g.insert_edge("x", "y", 0, 59));
+		CHECK(g.insert_edge("x", "y", 0, 60));
+		CHECK(g.is_connected("x", "y"));
+	}
+
+	SECTION("jumping far ahead empties the window") {
+		g.advance(1'000'000);
+		CHECK(g.num_events() == 0);
+		CHECK(g.num_nodes() == 0);
+		CHECK(g.edges().empty());
+		CHECK(g.insert_edge("a", "b", 1, 1'000'000 - 60 * 4));
+		CHECK_FALSE(g.insert_edge("a", "b", 1, 1'000'000 - 60 * 5));
+	}
+}
+
+TEST_CASE("Memory stays bounded over a long stream", "[TemporalGraph]") {
+	auto g = temporal_t(100, 3);
+	auto most = std::size_t{0};
+	for (auto t = std::int64_t{0}; t < 100'000; ++t) {
+		g.insert_edge(static_cast<int>(t % 97), static_cast<int>(t % 89), 0, t);
+		most = std::max(most, g.num_events());
+	}
+	CHECK(most == 300);
+	CHECK(g.num_events() == 300);
+}
+
+TEST_CASE("The window converts to an ordinary graph", "[TemporalGraph]") {
+	auto g = temporal_t(10, 2);
+	g.insert_edge(1, 2, 5, 3);
+	g.insert_edge(1, 2, 5, 4);
+	g.insert_edge(2, 3, 6, 15);
+	g.insert_edge(4, 4, 7, 19);
+
+	auto expected = gdwg::graph<int, int>{1, 2, 3, 4};
+	expected.insert_edge(1, 2, 5);
+	expected.insert_edge(2, 3, 6);
+	expected.insert_edge(4, 4, 7);
+	CHECK(g.to_graph() == expected);
+
+	g.clear();
+	CHECK(g.to_graph().empty());
+	CHECK(g.window_start() == 0);
+}
+
+TEST_CASE("A temporal graph needs a window", "[TemporalGraph]") {
+	CHECK_THROWS_MATCHES(temporal_t(0, 4),
+	                     std::runtime_error,
+	                     Catch::Matchers::Message("Cannot create a gdwg::temporal_graph<N, E> with "
+	                                              "an empty window"));
+	CHECK_THROWS_MATCHES(temporal_t(10, 0),
+	                     std::runtime_error,
+	                     Catch::Matchers::Message("Cannot create a gdwg::temporal_graph<N, E> with "
+	                                              "an empty window"));
+}
@@ -0,0 +1,66 @@
+#include "gdwg/graph.hpp"
+
+#include <catch2/catch.hpp>
+#include <sstream>
+#include <string>
+#include <thread>
+
+// Built with GDWG_TRACE=1, see test/graph/CMakeLists.txt.
+
+namespace {
+	auto count_of(std::string const& haystack, std::string const& needle) -> std::size_t {
+		auto count = std::size_t{0};
+		for (auto pos = haystack.find(needle); pos != std::string::npos;
+		     pos = haystack.find(needle, pos + 1)) {
+			++count;
+		}
+		return count;
+	}
+} // namespace
+
+TEST_CASE("Tracing graph operations", "[Trace]") {
+	static_assert(std::is_empty_v<gdwg::trace::null_span>);
+
+	SECTION("check expensive operations emit complete events, write_chrome_json()") {
+		gdwg::trace::clear();
+		auto g = gdwg::graph<int, int>{1, 2, 3};
+		g.insert_edge(1, 2, 3);
+		auto copy = g;
+		copy.replace_node(1, 4);
+		copy.erase_node(2);
+
+		auto out = std::ostringstream{};
+		gdwg::trace::write_chrome_json(out);
+		auto const json = out.str();
+		CHECK(json.rfind("{\"traceEvents\":[", 0) == 0);
+		CHECK(count_of(json, "\"name\":\"gdwg::graph::bulk_load\"") == 1);
+		CHECK(count_of(json, "\"name\":\"gdwg::graph::copy\"") == 1);
+		CHECK(count_of(json, "\"name\":\"gdwg::graph::replace_node\"") == 1);
+		CHECK(count_of(json, "\"name\":\"gdwg::graph::erase_node\"") == 1);
+		CHECK(count_of(json, "\"ph\":\"X\"") == 4);
+	}
+
+	SECTION("check each thread gets its own ring, write_chrome_json()") {
+		gdwg::trace::clear();
+		auto worker = std::thread([] { auto g = gdwg::graph<int, int>{1, 2}; });
+		worker.join();
+		auto g = gdwg::graph<int, int>{1, 2};
+
+		auto out = std::ostringstream{};
+		gdwg::trace::write_chrome_json(out);
+		auto const json = out.str();
+		CHECK(count_of(json, "gdwg::graph::bulk_load") == 2);
+		CHECK(count_of(json, "\"tid\":") == 2);
+	}
+
+	SECTION("check a full ring keeps only the newest spans, write_chrome_json()") {
+		gdwg::trace::clear();
+		for (auto i = std::size_t{0}; i < gdwg::trace::ring_capacity + 10; ++i) {
+			[[maybe_unused]] auto const span = gdwg::trace::span("test::span");
+		}
+
+		auto out = std::ostringstream{};
+		gdwg::trace::write_chrome_json(out);
+		CHECK(count_of(out.str(), "test::span") == gdwg::trace::ring_capacity);
+	}
+}
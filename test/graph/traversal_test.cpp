@@ -0,0 +1,155 @@
+#include "gdwg/traversal.hpp"
+
+#include <catch2/catch.hpp>
+#include <random>
+#include <ranges>
+#include <set>
+#include <string>
+#include <vector>
+
+namespace {
+	using graph_t = gdwg::graph<int, int>;
+
+	auto random_graph(int nodes, int edges, unsigned seed) -> graph_t {
+		auto g = graph_t{};
+		for (auto i = 0; i < nodes; ++i) {
+			g.insert_node(i);
+		}
+		auto rng = std::mt19937(seed);
+		auto pick = std::uniform_int_distribution<int>(0, nodes - 1);
+		for (auto i = 0; i < edges; ++i) {
+			g.insert_edge(pick(rng), pick(rng), i % 3);
+		}
+		return g;
+	}
+
+	auto reference_bfs(graph_t const& g, int src) -> std::vector<int> {
+		auto order = std::vector<int>{src};
+		auto seen = std::set<int>{src};
+		for (auto i = std::size_t{0}; i < order.size(); ++i) {
+			for (auto next : g.connections(order[i])) {
+				if (seen.insert(next).second) {
+					order.push_back(next);
+				}
+			}
+		}
+		return order;
+	}
+
+	auto reference_dfs(graph_t const& g, int node, std::set<int>& seen, std::vector<int>& order)
+	   -> void {
+		seen.insert(node);
+		order.push_back(node);
+		for (auto next : g.connections(node)) {
+			if (!seen.contains(next)) {
+				reference_dfs(g, next, seen, order);
+			}
+		}
+	}
+
+	template<typename Range>
+	auto collect(Range&& range) {
+		auto out = std::vector<std::ranges::range_value_t<Range>>();
+		for (auto const& value : range) {
+			out.push_back(value);
+		}
+		return out;
+	}
+} // namespace
+
+TEST_CASE("Breadth first traversal matches a reference", "[Traversal]") {
+	auto const g = random_graph(60, 150, 3);
+	for (auto src = 0; src < 60; src += 7) {
+		CHECK(collect(gdwg::bfs(g, src)) == reference_bfs(g, src));
+	}
+}
+
+TEST_CASE("Depth first traversal matches a reference", "[Traversal]") {
+	auto const g = random_graph(60, 150, 5);
+	for (auto src = 0; src < 60; src += 7) {
+		auto seen = std::set<int>();
+		auto expected = std::vector<int>();
+		reference_dfs(g, src, seen, expected);
+		CHECK(collect(gdwg::dfs(g, src)) == expected);
+	}
+}
+
+TEST_CASE("Traversals of a node without edges yield only that node", "[Traversal]") {
+	auto g = graph_t{1, 2};
+	g.insert_edge(2, 1, 0);
+	CHECK(collect(gdwg::bfs(g, 1)) == std::vector<int>{1});
+	CHECK(collect(gdwg::dfs(g, 1)) == std::vector<int>{1});
+	CHECK(collect(gdwg::edges_from(g, 1)).empty());
+}
+
+TEST_CASE("Traversals stop where the consumer does", "[Traversal]") {
+	auto g = graph_t{};
+	for (auto i = 0; i < 100; ++i) {
+		g.insert_node(i);
+	}
+	for (auto i = 0; i + 1 < 100; ++i) {
+		g.insert_edge(i, i + 1, 0);
+	}
+
+	SECTION("breaking out of the loop") {
+		auto seen = std::vector<int>();
+		for (auto node : gdwg::dfs(g, 10)) {
+			if (node == 13) {
+				break;
+			}
+			seen.push_back(node);
+		}
+		CHECK(seen == std::vector<int>{10, 11, 12});
+	}
+
+	SECTION("with std::views::take") {
+		CHECK(collect(gdwg::bfs(g, 0) | std::views::take(4)) == std::vector<int>{0, 1, 2, 3});
+	}
+
+	SECTION("advancing by hand") {
+		auto walk = gdwg::bfs(g, 97);
+		auto it = walk.begin();
+		CHECK(*it == 97);
+		CHECK(*++it == 98);
+		CHECK(*++it == 99);
+		CHECK(++it == walk.end());
+	}
+}
+
+TEST_CASE("Edges from a node match the graph's iterator", "[Traversal]") {
+	auto g = gdwg::graph<std::string, int>{"a", "b", "c"};
+	g.insert_edge("a", "c", 2);
+	g.insert_edge("a", "b", 5);
+	g.insert_edge("a", "b", 1);
+	g.insert_edge("b", "a", 3);
+	g.insert_edge("c", "c", 4);
+
+	auto expected = std::vector<std::string>();
+	for (auto const& [from, to, weight] : g) {
+		if (from == "a") {
+			expected.push_back(from + to + std::to_string(weight));
+		}
+	}
+	auto got = std::vector<std::string>();
+	for (auto const& [from, to, weight] : gdwg::edges_from(g, std::string("a"))) {
+		got.push_back(from + to + std::to_string(weight));
+	}
+	CHECK(got == expected);
+	CHECK(got == std::vector<std::string>{"ab1", "ab5", "ac2"});
+}
+
+TEST_CASE("Traversals from a node that doesn't exist throw", "[Traversal]") {
+	auto const g = graph_t{1, 2};
+	CHECK_THROWS_MATCHES(gdwg::bfs(g, 3),
+	                     std::runtime_error,
+	                     Catch::Matchers::Message("Cannot call gdwg::bfs if src doesn't exist "
+	                                              "in the graph"));
+	CHECK_THROWS_MATCHES(gdwg::dfs(g, 3),
+	                     std::runtime_error,
+	                     Catch::Matchers::Message("Cannot call gdwg::dfs if src doesn't exist "
+	                                              "in the graph"));
+	CHECK_THROWS_MATCHES(gdwg::edges_from(g, 3),
+	                     std::runtime_error,
+	                     Catch::Matchers::Message("Cannot call gdwg::edges_from if src doesn't "
+	                                              "exist in the graph"));
+}
@@ -0,0 +1,134 @@
+#include "gdwg/views.hpp"
+
+#include <catch2/catch.hpp>
+#include <tuple>
+#include <vector>
+
+namespace {
+	using graph_t = gdwg::graph<int, int>;
+
+	auto make_graph() -> graph_t {
+		auto g = graph_t{1, 2, 3, 4, 5};
+		auto const v = std::vector<graph_t::value_type>{
+		   {1, 2, 3},
+		   {1, 2, 9},
+		   {1, 3, 1},
+		   {2, 3, 7},
+		   {3, 1, 2},
+		   {4, 1, 8},
+		   {4, 4, 1},
+		};
+		for (const auto& [src, dst, weight] : v) {
+			g.insert_edge(src, dst, weight);
+		};
+		return g;
+	}
+
+	template<typename View>
+	auto edges_of(View const& view) -> std::vector<std::tuple<int, int, int>> {
+		auto res = std::vector<std::tuple<int, int, int>>();
+		for (auto const& [from, to, weight] : view) {
+			res.emplace_back(from, to, weight);
+		}
+		return res;
+	}
+} // namespace
+
+TEST_CASE("Filtering edges without copying", "[Views]") {
+	auto g = make_graph();
+	auto const light = gdwg::filtered_view(g, [](int, int, int weight) { return weight < 5; });
+
+	SECTION("check only accepted edges are visible, connections(), weights(), is_connected()") {
+		CHECK(light.nodes() == g.nodes());
+		CHECK(light.connections(1) == std::vector<int>{2, 3});
+		CHECK(light.connections(2).empty());
+		CHECK(light.weights(1, 2) == std::vector<int>{3});
+		CHECK(!light.is_connected(2, 3));
+		CHECK(light.is_connected(4, 4));
+		CHECK_THROWS_WITH(light.connections(9),
+		                  "Cannot call gdwg::filtered_view<N, E>::connections if src doesn't exist "
+		                  "in the view");
+	}
+
+	SECTION("check iteration skips rejected edges, begin(), end()") {
+		auto const expected = std::vector<std::tuple<int, int, int>>{
+		   {1, 2, 3},
+		   {1, 3, 1},
+		   {3, 1, 2},
+		   {4, 4, 1},
+		};
+		CHECK(edges_of(light) == expected);
+	}
+
+	SECTION("check the view follows the graph, begin()") {
+		g.insert_edge(5, 2, 4);
+		g.erase_edge(1, 2, 3);
+		CHECK(light.connections(5) == std::vector<int>{2});
+		CHECK(light.weights(1, 2).empty());
+	}
+
+	SECTION("check a view rejecting everything is empty, begin()") {
+		auto const none = gdwg::filtered_view(g, [](int, int, int) { return false; });
+		CHECK(none.begin() == none.end());
+	}
+}
+
+TEST_CASE("Restricting a graph to a node set", "[Views]") {
+	auto const g = make_graph();
+	auto const sub = gdwg::induced_subgraph_view(g, {1, 2, 4, 7});
+
+	SECTION("check nodes outside the set are hidden, nodes(), is_node()") {
+		CHECK(sub.nodes() == std::vector<int>{1, 2, 4});
+		CHECK(!sub.is_node(3));
+		CHECK(!sub.is_node(7));
+		CHECK(!sub.empty());
+	}
+
+	SECTION("check only edges inside the set are visible, connections(), begin()") {
+		CHECK(sub.connections(1) == std::vector<int>{2});
+		CHECK(sub.connections(2).empty());
+		auto const expected = std::vector<std::tuple<int, int, int>>{
+		   {1, 2, 3},
+		   {1, 2, 9},
+		   {4, 1, 8},
+		   {4, 4, 1},
+		};
+		CHECK(edges_of(sub) == expected);
+		CHECK_THROWS_WITH(sub.weights(1, 3),
+		                  "Cannot call gdwg::induced_subgraph_view<N, E>::weights if src or dst node "
+		                  "don't exist in the view");
+	}
+}
+
+TEST_CASE("Reversing every edge", "[Views]") {
+	auto const g = make_graph();
+	auto const reversed = gdwg::transpose_view(g);
+
+	SECTION("check lookups see reversed edges, connections(), weights(), is_connected()") {
+		CHECK(reversed.connections(1) == std::vector<int>{3, 4});
+		CHECK(reversed.connections(3) == std::vector<int>{1, 2});
+		CHECK(reversed.connections(5).empty());
+		CHECK(reversed.weights(2, 1) == std::vector<int>{3, 9});
+		CHECK(reversed.is_connected(1, 4));
+		CHECK(!reversed.is_connected(4, 1));
+	}
+
+	SECTION("check iteration is sorted by the reversed edge, begin(), end()") {
+		auto const expected = std::vector<std::tuple<int, int, int>>{
+		   {1, 3, 2},
+		   {1, 4, 8},
+		   {2, 1, 3},
+		   {2, 1, 9},
+		   {3, 1, 1},
+		   {3, 2, 7},
+		   {4, 4, 1},
+		};
+		CHECK(edges_of(reversed) == expected);
+	}
+
+	SECTION("check a graph without edges has nothing to iterate, begin()") {
+		auto const lonely = graph_t{1, 2};
+		auto const view = gdwg::transpose_view(lonely);
+		CHECK(view.begin() == view.end());
+	}
+}
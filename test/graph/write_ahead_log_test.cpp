@@ -0,0 +1,262 @@
+#include "gdwg/write_ahead_log.hpp"
+
+#include <catch2/catch.hpp>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace {
+	using graph_t = gdwg::graph<std::string, int>;
+	using log_t = gdwg::write_ahead_log<std::string, int>;
+
+	// a fresh directory for one test, removed afterwards
+	class scratch_directory {
+	public:
+		explicit scratch_directory(std::string const& name)
+		: path_(std::filesystem::temp_directory_path() / ("gdwg_wal_test_" + name)) {
+			std::filesystem::remove_all(path_);
+		}
+
+		~scratch_directory() {
+			std::filesystem::remove_all(path_);
+		}
+
+		scratch_directory(scratch_directory const&) = delete;
+		auto operator=(scratch_directory const&) -> scratch_directory& = delete;
+
+		[[nodiscard]] auto path() const -> std::filesystem::path const& {
+			return path_;
+		}
+
+	private:
+		std::filesystem::path path_;
+	};
+
+	auto recover(std::filesystem::path const& directory) -> graph_t {
+		auto g = graph_t{};
+		auto log = log_t(g, directory);
+		return g;
+	}
+
+	// what a crash would leave behind: the files as they are, without the destructor's commit
+	auto crash_copy(std::filesystem::path const& from, std::filesystem::path const& to) -> void {
+		std::filesystem::remove_all(to);
+		std::filesystem::copy(from, to);
+	}
+} // namespace
+
+TEST_CASE("CRC-32C matches its check value", "[WriteAheadLog]") {
+	auto const text = std::string("123456789");
+	CHECK(gdwg::detail::crc32c(text.data(), text.size()) == 0xe3069283U);
+	auto const split = gdwg::detail::crc32c(text.data() + 4,
+	                                        text.size() - 4,
+	                                        gdwg::detail::crc32c(text.data(), 4));
+	CHECK(split == 0xe3069283U);
+}
+
+TEST_CASE("Serializers read back what they wrote", "[WriteAheadLog]") {
+	auto out = std::vector<std::uint8_t>();
+	gdwg::serializer<int>::put(out, -123456);
+	gdwg::serializer<std::uint64_t>::put(out, 0xffffffffffffffffULL);
+	gdwg::serializer<double>::put(out, 2.5);
+	gdwg::serializer<std::string>::put(out, "node");
+	auto in = gdwg::byte_reader(out);
+	CHECK(gdwg::serializer<int>::get(in) == -123456);
+	CHECK(gdwg::serializer<std::uint64_t>::get(in) == 0xffffffffffffffffULL);
+	CHECK(gdwg::serializer<double>::get(in) == 2.5);
+	CHECK(gdwg::serializer<std::string>::get(in) == "node");
+	CHECK(in.remaining() == 0);
+	CHECK_THROWS_MATCHES(gdwg::serializer<int>::get(in),
+	                     std::runtime_error,
+	                     Catch::Matchers::Message("Cannot read past the end of a "
+	                                              "gdwg::byte_reader"));
+}
+
+TEST_CASE("Every kind of change survives a restart", "[WriteAheadLog]") {
+	auto const dir = scratch_directory("changes");
+	auto expected = graph_t{"a", "b", "c"};
+	{
+		auto g = graph_t{"a", "b", "c"};
+		auto log = log_t(g, dir.path());
+		CHECK(log.recovered().snapshot_nodes == 0);
+		for (auto* target : {&g, &expected}) {
+			target->insert_node("d");
+			target->insert_edge("a", "b", 1);
+			target->insert_edge("a", "b", 2);
+			target->insert_edge("b", "c", 3);
+			target->insert_edge("c", "a", 4);
+			target->insert_edge("d", "d", 5);
+			target->erase_edge("a", "b", 1);
+			target->replace_node("c", "e");
+			target->erase_node("d");
+			// the last edge out of b, which takes b with it
+			target->erase_edge("b", "e", 3);
+		}
+		log.commit();
+		CHECK(log.pending() == 0);
+	}
+
+	auto const g = recover(dir.path());
+	CHECK(g == expected);
+	CHECK(g.nodes() == std::vector<std::string>{"a", "e"});
+}
+
+TEST_CASE("Recovery replays the log on top of the snapshot", "[WriteAheadLog]") {
+	auto const dir = scratch_directory("replay");
+	{
+		auto g = graph_t{"a", "b"};
+		g.insert_edge("a", "b", 7);
+		auto log = log_t(g, dir.path());
+		g.insert_node("c");
+		g.insert_edge("b", "c", 8);
+	}
+	auto g = graph_t{};
+	auto log = log_t(g, dir.path());
+	CHECK(log.recovered().snapshot_nodes == 2);
+	CHECK(log.recovered().snapshot_edges == 1);
+	CHECK(log.recovered().replayed == 2);
+	CHECK_FALSE(log.recovered().torn_tail);
+	CHECK(g.is_connected("a", "b"));
+	CHECK(g.is_connected("b", "c"));
+}
+
+TEST_CASE("Changes are synced a group at a time", "[WriteAheadLog]") {
+	auto const dir = scratch_directory("group");
+	auto const crashed = scratch_directory("group_crashed");
+	auto g = graph_t{};
+	auto log = log_t(g, dir.path(), gdwg::wal_options{4, 0});
+	for (auto i = 0; i < 6; ++i) {
+		g.insert_node(std::to_string(i));
+	}
+	CHECK(log.pending() == 2);
+	CHECK(log.log_records() == 4);
+
+	crash_copy(dir.path(), crashed.path());
+	CHECK(recover(crashed.path()).nodes() == std::vector<std::string>{"0", "1", "2", "3"});
+
+	log.commit();
+	crash_copy(dir.path(), crashed.path());
+	CHECK(recover(crashed.path()).num_nodes() == 6);
+}
+
+TEST_CASE("A torn write at the end of the log is dropped", "[WriteAheadLog]") {
+	auto const dir = scratch_directory("torn");
+	{
+		auto g = graph_t{"a"};
+		auto log = log_t(g, dir.path());
+		g.insert_node("b");
+		log.commit();
+	}
+	{
+		// a record header promising more than made it to disk
+		auto const torn = std::string("\x20\x00\x00\x00garbage", 11);
+		auto wal = std::ofstream(dir.path() / "wal", std::ios::binary | std::ios::app);
+		wal.write(torn.data(), static_cast<std::streamsize>(torn.size()));
+	}
+	{
+		auto g = graph_t{};
+		auto log = log_t(g, dir.path());
+		CHECK(log.recovered().torn_tail);
+		CHECK(log.recovered().replayed == 1);
+		CHECK(g.nodes() == std::vector<std::string>{"a", "b"});
+		// appended after the good records, not after the garbage
+		g.insert_node("c");
+	}
+	auto g = graph_t{};
+	auto log = log_t(g, dir.path());
+	CHECK_FALSE(log.recovered().torn_tail);
+	CHECK(g.nodes() == std::vector<std::string>{"a", "b", "c"});
+}
+
+TEST_CASE("Snapshots bound what recovery replays", "[WriteAheadLog]") {
+	auto const dir = scratch_directory("snapshots");
+	{
+		auto g = graph_t{};
+		auto log = log_t(g, dir.path(), gdwg::wal_options{8, 100});
+		for (auto i = 0; i < 250; ++i) {
+			g.insert_node(std::to_string(i));
+			log.commit();
+			CHECK(log.log_records() < 100);
+		}
+	}
+	auto g = graph_t{};
+	auto log = log_t(g, dir.path());
+	CHECK(g.num_nodes() == 250);
+	CHECK(log.recovered().replayed < 100);
+	CHECK(log.recovered().snapshot_nodes + log.recovered().replayed == 250);
+}
+
+TEST_CASE("Clearing or assigning the graph takes a snapshot", "[WriteAheadLog]") {
+	auto const dir = scratch_directory("reload");
+	auto replacement = graph_t{"x", "y"};
+	replacement.insert_edge("x", "y", 1);
+	{
+		auto g = graph_t{"a", "b"};
+		auto log = log_t(g, dir.path());
+		g.insert_edge("a", "b", 2);
+		g.clear();
+		g.insert_node("z");
+		g = replacement;
+		g.insert_edge("y", "x", 3);
+		replacement.insert_edge("y", "x", 3);
+		log.commit();
+		CHECK(log.log_records() == 0);
+	}
+	CHECK(recover(dir.path()) == replacement);
+}
+
+TEST_CASE("A log older than the snapshot is ignored", "[WriteAheadLog]") {
+	auto const dir = scratch_directory("stale");
+	auto const stale = dir.path().parent_path() / "gdwg_wal_test_stale_log";
+	{
+		auto g = graph_t{"a"};
+		auto log = log_t(g, dir.path());
+		g.insert_node("b");
+		log.commit();
+		std::filesystem::copy_file(dir.path() / "wal",
+		                           stale,
+		                           std::filesystem::copy_options::overwrite_existing);
+		g.erase_node("b");
+		log.checkpoint();
+	}
+	// as if the crash came after the new snapshot but before its log
+	std::filesystem::rename(stale, dir.path() / "wal");
+
+	auto g = graph_t{};
+	auto log = log_t(g, dir.path());
+	CHECK(log.recovered().replayed == 0);
+	CHECK(g.nodes() == std::vector<std::string>{"a"});
+}
+
+TEST_CASE("Recovery refuses what it can't trust", "[WriteAheadLog]") {
+	auto const dir = scratch_directory("refuse");
+	{
+		auto g = graph_t{"a", "b"};
+		auto log = log_t(g, dir.path());
+	}
+
+	SECTION("a graph that already has nodes") {
+		auto g = graph_t{"c"};
+		CHECK_THROWS_MATCHES(log_t(g, dir.path()),
+		                     std::runtime_error,
+		                     Catch::Matchers::Message("Cannot recover " + dir.path().string()
+		                                              + " into a gdwg::graph that isn't empty"));
+	}
+
+	SECTION("a damaged snapshot") {
+		{
+			auto snapshot = std::fstream(dir.path() / "snapshot",
+			                             std::ios::binary | std::ios::in | std::ios::out);
+			snapshot.seekp(-1, std::ios::end);
+			snapshot.put('?');
+		}
+		auto g = graph_t{};
+		CHECK_THROWS_MATCHES(log_t(g, dir.path()),
+		                     std::runtime_error,
+		                     Catch::Matchers::Message("Cannot recover a gdwg::graph from "
+		                                              + dir.path().string()
+		                                              + ": the snapshot's checksum doesn't match"));
+	}
+}